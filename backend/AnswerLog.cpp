@@ -0,0 +1,85 @@
+#include "AnswerLog.h"
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+
+namespace {
+    const unsigned kFlushEvery = 256;
+
+    // Session ids come from clients; keep them from breaking the line format.
+    std::string sanitize(const std::string& field) {
+        std::string clean = field;
+        for (char& c : clean) {
+            if (c == '|' || c == '\n' || c == '\r') c = '_';
+        }
+        return clean;
+    }
+}
+
+bool AnswerLog::open(const std::string& filename) {
+    std::lock_guard<std::mutex> lock(fileMutex);
+    file.open(filename, std::ios::app);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open answer log: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+AnswerLog::~AnswerLog() {
+    flush();
+}
+
+void AnswerLog::append(const std::string& sessionId, int questionId, const std::string& topic, bool correct) {
+    uint64_t now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+
+    // Format outside the lock; only the buffered write is serialized.
+    std::ostringstream line;
+    line << now << '|' << sanitize(sessionId) << '|' << questionId << '|' << topic << '|' << (correct ? 1 : 0) << '\n';
+
+    std::lock_guard<std::mutex> lock(fileMutex);
+    if (!file.is_open()) return;
+    file << line.str();
+    if (++pendingEvents >= kFlushEvery) {
+        file.flush();
+        pendingEvents = 0;
+    }
+}
+
+void AnswerLog::flush() {
+    std::lock_guard<std::mutex> lock(fileMutex);
+    if (file.is_open()) {
+        file.flush();
+    }
+    pendingEvents = 0;
+}
+
+long long AnswerLog::readAll(const std::string& filename, const std::function<void(const AnswerEvent&)>& callback) {
+    std::ifstream in(filename);
+    if (!in.is_open()) {
+        return -1;
+    }
+
+    long long count = 0;
+    std::string line;
+    AnswerEvent event;
+    while (std::getline(in, line)) {
+        // Split on '|' by hand; this runs over very large logs.
+        size_t p1 = line.find('|');
+        size_t p2 = p1 == std::string::npos ? p1 : line.find('|', p1 + 1);
+        size_t p3 = p2 == std::string::npos ? p2 : line.find('|', p2 + 1);
+        size_t p4 = line.rfind('|');
+        if (p3 == std::string::npos || p4 <= p3) continue; // Malformed or truncated line
+
+        event.timestampMs = std::strtoull(line.c_str(), nullptr, 10);
+        event.sessionId.assign(line, p1 + 1, p2 - p1 - 1);
+        event.questionId = std::atoi(line.c_str() + p2 + 1);
+        event.topic.assign(line, p3 + 1, p4 - p3 - 1);
+        event.correct = line[p4 + 1] == '1';
+        callback(event);
+        ++count;
+    }
+    return count;
+}
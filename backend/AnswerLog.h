@@ -0,0 +1,55 @@
+#ifndef ANSWER_LOG_H
+#define ANSWER_LOG_H
+
+#include <string>
+#include <fstream>
+#include <mutex>
+#include <functional>
+#include <cstdint>
+
+/**
+ * @struct AnswerEvent
+ * @brief One graded answer, as persisted in the answer log.
+ */
+struct AnswerEvent {
+    uint64_t timestampMs = 0;
+    std::string sessionId;
+    int questionId = -1;
+    std::string topic;
+    bool correct = false;
+};
+
+/**
+ * @class AnswerLog
+ * @brief Append-only log of every graded answer, used by the offline
+ * fitting and calibration tools.
+ *
+ * One event per line: "timestampMs|sessionId|questionId|topic|correct(0/1)".
+ * Appends go through a buffered stream that is flushed every few hundred
+ * events and on shutdown.
+ */
+class AnswerLog {
+private:
+    std::ofstream file;
+    std::mutex fileMutex;
+    unsigned pendingEvents = 0;
+
+public:
+    /**
+     * @brief Opens (appending to) the log file.
+     * @return false if it could not be opened; append() is then a no-op.
+     */
+    bool open(const std::string& filename);
+    ~AnswerLog();
+
+    void append(const std::string& sessionId, int questionId, const std::string& topic, bool correct);
+    void flush();
+
+    /**
+     * @brief Streams every well-formed event in a log file to callback, in file order.
+     * @return The number of events read, or -1 if the file could not be opened.
+     */
+    static long long readAll(const std::string& filename, const std::function<void(const AnswerEvent&)>& callback);
+};
+
+#endif // ANSWER_LOG_H
@@ -0,0 +1,227 @@
+#ifndef BINARY_IO_H
+#define BINARY_IO_H
+
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @brief Small helpers for the compact binary formats used by checkpoints
+ * and other persisted state. All multi-byte values are little-endian so the
+ * files are portable between the Windows and Linux builds.
+ *
+ * Like Utils.h, everything here is 'inline' so it can be included from
+ * several .cpp files.
+ */
+
+/**
+ * @brief Computes the standard CRC-32 (IEEE 802.3) of a byte range.
+ * @param seed Pass a previous result to checksum data in several pieces.
+ */
+inline uint32_t crc32(const void* data, size_t length, uint32_t seed = 0) {
+    // Function-local static: built once, thread-safe since C++11.
+    static const struct Table {
+        uint32_t entries[256];
+        Table() {
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; ++k) {
+                    c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+                }
+                entries[i] = c;
+            }
+        }
+    } table;
+
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint32_t crc = seed ^ 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; ++i) {
+        crc = table.entries[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+/**
+ * @class ByteWriter
+ * @brief Appends fixed-width integers, varints and strings to a byte buffer.
+ */
+class ByteWriter {
+private:
+    std::string buffer;
+
+public:
+    void putU8(uint8_t v) { buffer.push_back(static_cast<char>(v)); }
+
+    void putU32(uint32_t v) {
+        for (int i = 0; i < 4; ++i) putU8(static_cast<uint8_t>(v >> (8 * i)));
+    }
+
+    void putU64(uint64_t v) {
+        for (int i = 0; i < 8; ++i) putU8(static_cast<uint8_t>(v >> (8 * i)));
+    }
+
+    // LEB128-style variable length integer: 7 bits per byte, high bit = "more".
+    void putVarint(uint64_t v) {
+        while (v >= 0x80) {
+            putU8(static_cast<uint8_t>(v | 0x80));
+            v >>= 7;
+        }
+        putU8(static_cast<uint8_t>(v));
+    }
+
+    // Zigzag-encoded signed varint: small magnitudes of either sign stay short.
+    void putSignedVarint(int64_t v) {
+        putVarint((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63));
+    }
+
+    void putDouble(double v) {
+        uint64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        putU64(bits);
+    }
+
+    void putString(const std::string& s) {
+        putVarint(s.size());
+        buffer.append(s);
+    }
+
+    void putBytes(const std::string& bytes) { buffer.append(bytes); }
+
+    const std::string& data() const { return buffer; }
+    std::string release() { return std::move(buffer); }
+    size_t size() const { return buffer.size(); }
+};
+
+/**
+ * @class ByteReader
+ * @brief Reads back what ByteWriter produced.
+ *
+ * Every read is bounds-checked; a truncated or corrupt buffer throws
+ * std::runtime_error instead of reading past the end.
+ */
+class ByteReader {
+private:
+    const unsigned char* cursor;
+    const unsigned char* end;
+
+    void require(size_t n) const {
+        if (static_cast<size_t>(end - cursor) < n) {
+            throw std::runtime_error("ByteReader: unexpected end of data");
+        }
+    }
+
+public:
+    ByteReader(const void* data, size_t length)
+        : cursor(static_cast<const unsigned char*>(data)),
+          end(static_cast<const unsigned char*>(data) + length) {}
+
+    explicit ByteReader(const std::string& s) : ByteReader(s.data(), s.size()) {}
+
+    uint8_t getU8() {
+        require(1);
+        return *cursor++;
+    }
+
+    uint32_t getU32() {
+        uint32_t v = 0;
+        for (int i = 0; i < 4; ++i) v |= static_cast<uint32_t>(getU8()) << (8 * i);
+        return v;
+    }
+
+    uint64_t getU64() {
+        uint64_t v = 0;
+        for (int i = 0; i < 8; ++i) v |= static_cast<uint64_t>(getU8()) << (8 * i);
+        return v;
+    }
+
+    uint64_t getVarint() {
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t b = getU8();
+            v |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) return v;
+        }
+        throw std::runtime_error("ByteReader: varint too long");
+    }
+
+    int64_t getSignedVarint() {
+        uint64_t zigzag = getVarint();
+        return static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+    }
+
+    double getDouble() {
+        uint64_t bits = getU64();
+        double v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+
+    std::string getString() {
+        uint64_t n = getVarint();
+        require(n);
+        std::string s(reinterpret_cast<const char*>(cursor), n);
+        cursor += n;
+        return s;
+    }
+
+    void skip(size_t n) {
+        require(n);
+        cursor += n;
+    }
+
+    size_t remaining() const { return static_cast<size_t>(end - cursor); }
+    bool atEnd() const { return cursor == end; }
+};
+
+/**
+ * @brief Writes a set of non-negative ids as a run-length compressed bitmap.
+ *
+ * The ids must be sorted and unique. The bitmap is stored as alternating
+ * varint run lengths (zeros, ones, zeros, ...), so both a few scattered ids
+ * and long contiguous ranges take only a handful of bytes.
+ */
+inline void putIdRuns(ByteWriter& out, const std::vector<int>& sortedIds) {
+    std::vector<uint64_t> runs;
+    int next = 0; // First bit position not yet covered by a run
+    size_t i = 0;
+    while (i < sortedIds.size()) {
+        size_t runEnd = i + 1;
+        while (runEnd < sortedIds.size() && sortedIds[runEnd] == sortedIds[runEnd - 1] + 1) {
+            ++runEnd;
+        }
+        runs.push_back(static_cast<uint64_t>(sortedIds[i] - next)); // zeros
+        runs.push_back(runEnd - i);                                 // ones
+        next = sortedIds[runEnd - 1] + 1;
+        i = runEnd;
+    }
+
+    out.putVarint(runs.size() / 2);
+    for (uint64_t run : runs) {
+        out.putVarint(run);
+    }
+}
+
+/**
+ * @brief Reads back what putIdRuns() wrote, as a sorted id list.
+ * @param maxId Ids at or above this bound are rejected as corrupt.
+ */
+inline std::vector<int> getIdRuns(ByteReader& in, uint64_t maxId) {
+    std::vector<int> ids;
+    uint64_t pairs = in.getVarint();
+    uint64_t position = 0;
+    for (uint64_t p = 0; p < pairs; ++p) {
+        position += in.getVarint();
+        uint64_t ones = in.getVarint();
+        if (position > maxId || ones > maxId - position) {
+            throw std::runtime_error("getIdRuns: id out of range");
+        }
+        for (uint64_t k = 0; k < ones; ++k) {
+            ids.push_back(static_cast<int>(position++));
+        }
+    }
+    return ids;
+}
+
+#endif // BINARY_IO_H
@@ -0,0 +1,140 @@
+#include "BucketInventory.h"
+#include "MemoryUsage.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    int levelOf(double difficulty) {
+        long level = std::lround(difficulty);
+        if (level < BucketInventory::kMinLevel) level = BucketInventory::kMinLevel;
+        if (level >= BucketInventory::kMinLevel + BucketInventory::kLevels) {
+            level = BucketInventory::kMinLevel + BucketInventory::kLevels - 1;
+        }
+        return static_cast<int>(level);
+    }
+}
+
+void BucketInventory::configure(const QuestionBank& questionBank) {
+    bank = &questionBank;
+    bucketCount = questionBank.getTopics().size() * kLevels;
+    buckets.reset(new Bucket[bucketCount]);
+    for (size_t b = 0; b < bucketCount; ++b) {
+        buckets[b].topic = static_cast<int>(b / kLevels);
+        buckets[b].level = kMinLevel + static_cast<int>(b % kLevels);
+        for (auto& count : buckets[b].byLevel) {
+            count.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    bucketOfQuestion.assign(questionBank.size(), -1);
+    for (size_t id = 0; id < questionBank.size(); ++id) {
+        Question* q = questionBank.getQuestionById(static_cast<int>(id));
+        int bucket = bucketFor(questionBank.getTopicIndex(q->getTopic()), q->getDifficulty());
+        if (bucket >= 0) {
+            bucketOfQuestion[id] = bucket;
+            buckets[bucket].questions++;
+        }
+    }
+}
+
+int BucketInventory::bucketFor(int topicIdx, double difficulty) const {
+    if (topicIdx < 0 || static_cast<size_t>(topicIdx) * kLevels >= bucketCount) return -1;
+    return topicIdx * kLevels + (levelOf(difficulty) - kMinLevel);
+}
+
+void BucketInventory::recordSelection(int bucket, QuestionBank::FallbackLevel level) {
+    if (bucket < 0 || static_cast<size_t>(bucket) >= bucketCount) return;
+    buckets[bucket].byLevel[level].fetch_add(1, std::memory_order_relaxed);
+}
+
+BucketInventory::Scan BucketInventory::beginScan(size_t lowWater) const {
+    Scan scan;
+    scan.lowWater = lowWater;
+    scan.unseenTotal.assign(bucketCount, 0);
+    scan.unseenMin.assign(bucketCount, UINT64_MAX);
+    scan.sessionsLow.assign(bucketCount, 0);
+    scan.sessionsExhausted.assign(bucketCount, 0);
+    return scan;
+}
+
+void BucketInventory::addSession(Scan& scan, const std::vector<bool>& usedMask) const {
+    std::vector<size_t> used(bucketCount, 0);
+    size_t limit = std::min(usedMask.size(), bucketOfQuestion.size());
+    for (size_t id = 0; id < limit; ++id) {
+        if (usedMask[id] && bucketOfQuestion[id] >= 0) {
+            used[bucketOfQuestion[id]]++;
+        }
+    }
+
+    scan.sessions++;
+    for (size_t b = 0; b < bucketCount; ++b) {
+        uint64_t unseen = buckets[b].questions - used[b];
+        scan.unseenTotal[b] += unseen;
+        scan.unseenMin[b] = std::min(scan.unseenMin[b], unseen);
+        if (unseen <= scan.lowWater) scan.sessionsLow[b]++;
+        if (unseen == 0) scan.sessionsExhausted[b]++;
+    }
+}
+
+nlohmann::json BucketInventory::getReportJson(const Scan& scan, double riskRate, uint64_t minSelections,
+                                              bool allBuckets) const {
+    struct Row {
+        size_t bucket;
+        double risk;
+        nlohmann::json entry;
+    };
+    std::vector<Row> rows;
+
+    for (size_t b = 0; b < bucketCount && b < scan.unseenTotal.size(); ++b) {
+        const Bucket& bucket = buckets[b];
+        uint64_t selections = 0;
+        nlohmann::json byLevel;
+        for (int l = QuestionBank::WithinBand; l < QuestionBank::kFallbackLevelCount; ++l) {
+            uint64_t count = bucket.byLevel[l].load(std::memory_order_relaxed);
+            byLevel[QuestionBank::fallbackLevelName(static_cast<QuestionBank::FallbackLevel>(l))] = count;
+            selections += count;
+        }
+        uint64_t inBand = bucket.byLevel[QuestionBank::WithinBand].load(std::memory_order_relaxed);
+        double fallbackRate = selections > 0 ? 1.0 - static_cast<double>(inBand) / selections : 0.0;
+        double lowShare = scan.sessions > 0 ? static_cast<double>(scan.sessionsLow[b]) / scan.sessions : 0.0;
+
+        bool atRisk = (selections >= minSelections && fallbackRate >= riskRate) || lowShare >= riskRate;
+        if (!atRisk && !allBuckets) continue;
+
+        nlohmann::json entry;
+        entry["topic"] = bank->getTopics()[bucket.topic];
+        entry["difficulty"] = bucket.level;
+        entry["questions"] = bucket.questions;
+        entry["selections"] = selections;
+        entry["selectionsByLevel"] = byLevel;
+        entry["fallbackRate"] = fallbackRate;
+        entry["sessionsScanned"] = scan.sessions;
+        entry["meanUnseen"] = scan.sessions > 0 ? static_cast<double>(scan.unseenTotal[b]) / scan.sessions
+                                                : static_cast<double>(bucket.questions);
+        entry["minUnseen"] = scan.sessions > 0 ? scan.unseenMin[b] : bucket.questions;
+        entry["sessionsLow"] = scan.sessionsLow[b];
+        entry["sessionsExhausted"] = scan.sessionsExhausted[b];
+        entry["atRisk"] = atRisk;
+
+        double risk = std::max(selections >= minSelections ? fallbackRate : 0.0, lowShare);
+        rows.push_back(Row{b, risk, entry});
+    }
+
+    std::stable_sort(rows.begin(), rows.end(), [](const Row& x, const Row& y) { return x.risk > y.risk; });
+
+    nlohmann::json report;
+    report["riskRate"] = riskRate;
+    report["lowWater"] = scan.lowWater;
+    report["minSelections"] = minSelections;
+    report["sessionsScanned"] = scan.sessions;
+    nlohmann::json list = nlohmann::json::array();
+    for (const Row& row : rows) {
+        list.push_back(row.entry);
+    }
+    report["buckets"] = list;
+    return report;
+}
+
+size_t BucketInventory::memoryUsage() const {
+    return bucketCount * sizeof(Bucket) + vectorHeapBytes(bucketOfQuestion);
+}
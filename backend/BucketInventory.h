@@ -0,0 +1,99 @@
+#ifndef BUCKET_INVENTORY_H
+#define BUCKET_INVENTORY_H
+
+#include "QuestionBank.h"
+#include "json.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @class BucketInventory
+ * @brief Watches the question bank for (topic, difficulty) buckets that
+ * learners are running out of.
+ *
+ * A bucket is a topic plus a whole difficulty level (fractional
+ * difficulties are rounded). Every QuestionBank::getQuestion call that
+ * targets a bucket records which fallback level answered it, with one
+ * relaxed atomic add; item-level policies record against the bucket of the
+ * item they served (QuestionBank::recordSelection). A bucket whose selections keep leaving the
+ * difficulty band is already too thin for adaptivity to work in it.
+ *
+ * Unseen inventory is per learner, so it is measured on demand: a report
+ * scans each live session's used-question mask once (O(bank size) per
+ * session) and gives, per bucket, how many of its questions the sessions
+ * have left and how many sessions are close to exhausting it.
+ */
+class BucketInventory {
+public:
+    static const int kMinLevel = 1;
+    static const int kLevels = 3; // Difficulty levels 1, 2, 3
+
+    /**
+     * @struct Scan
+     * @brief Unseen-question totals gathered from sessions for one report.
+     */
+    struct Scan {
+        uint64_t sessions = 0;
+        size_t lowWater = 2;                 // "Low" means at most this many unseen
+        std::vector<uint64_t> unseenTotal;   // Per bucket, summed over sessions
+        std::vector<uint64_t> unseenMin;
+        std::vector<uint64_t> sessionsLow;
+        std::vector<uint64_t> sessionsExhausted;
+    };
+
+private:
+    struct Bucket {
+        int topic = 0;
+        int level = kMinLevel;
+        size_t questions = 0;
+        std::atomic<uint64_t> byLevel[QuestionBank::kFallbackLevelCount];
+    };
+
+    const QuestionBank* bank = nullptr;
+    std::unique_ptr<Bucket[]> buckets;
+    size_t bucketCount = 0;
+    std::vector<int> bucketOfQuestion; // Question id -> bucket
+
+public:
+    BucketInventory() {}
+    BucketInventory(const BucketInventory&) = delete;
+    BucketInventory& operator=(const BucketInventory&) = delete;
+
+    /**
+     * @brief Sorts the bank's questions into buckets and clears the counts.
+     * Call after loading (and after any overlay that moves difficulties).
+     */
+    void configure(const QuestionBank& questionBank);
+
+    /**
+     * @brief The bucket a selection for this topic and difficulty targets, or -1.
+     */
+    int bucketFor(int topicIdx, double difficulty) const;
+
+    /**
+     * @brief Counts one selection that targeted 'bucket'. Lock-free.
+     */
+    void recordSelection(int bucket, QuestionBank::FallbackLevel level);
+
+    size_t memoryUsage() const;
+
+    Scan beginScan(size_t lowWater) const;
+
+    /**
+     * @brief Adds one session's unseen counts to the scan.
+     */
+    void addSession(Scan& scan, const std::vector<bool>& usedMask) const;
+
+    /**
+     * @brief Buckets at risk: those where at least riskRate of selections
+     * fell out of the difficulty band (once minSelections were made), or
+     * where at least riskRate of scanned sessions have lowWater or fewer
+     * questions left. Most at risk first; allBuckets lists every bucket.
+     */
+    nlohmann::json getReportJson(const Scan& scan, double riskRate, uint64_t minSelections, bool allBuckets) const;
+};
+
+#endif // BUCKET_INVENTORY_H
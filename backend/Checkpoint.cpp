@@ -0,0 +1,176 @@
+#include "Checkpoint.h"
+#include "BinaryIO.h"
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <io.h>      // _commit, _fileno
+#else
+#include <unistd.h>  // fsync, fileno
+#endif
+
+namespace {
+    const uint32_t kCheckpointMagic = 0x50435141; // "AQCP" little-endian
+    const uint32_t kCheckpointVersion = 1;
+    const size_t kHeaderSize = 32;
+    const size_t kWriteChunk = 64 * 1024;
+
+    // Forces written data to stable storage before we report success.
+    bool flushToDisk(std::FILE* file) {
+        if (std::fflush(file) != 0) return false;
+#ifdef _WIN32
+        return _commit(_fileno(file)) == 0;
+#else
+        return fsync(fileno(file)) == 0;
+#endif
+    }
+}
+
+CheckpointManager::CheckpointManager(const std::string& base, uint64_t bytesPerSecond)
+    : basePath(base), maxBytesPerSecond(bytesPerSecond), generation(0), stopRequested(false) {
+}
+
+CheckpointManager::~CheckpointManager() {
+    stop();
+}
+
+std::string CheckpointManager::slotPath(uint64_t gen) const {
+    return basePath + "." + std::to_string(gen % 2);
+}
+
+bool CheckpointManager::readSlot(const std::string& path, uint64_t& gen, std::string& payload) const {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (bytes.size() < kHeaderSize) return false;
+
+    try {
+        ByteReader header(bytes.data(), kHeaderSize);
+        uint32_t magic = header.getU32();
+        uint32_t version = header.getU32();
+        uint64_t fileGen = header.getU64();
+        uint64_t length = header.getU64();
+        uint32_t payloadCrc = header.getU32();
+        uint32_t headerCrc = header.getU32();
+
+        if (magic != kCheckpointMagic || version != kCheckpointVersion) return false;
+        if (crc32(bytes.data(), kHeaderSize - 4) != headerCrc) return false;
+        if (bytes.size() - kHeaderSize != length) return false;
+        if (crc32(bytes.data() + kHeaderSize, length) != payloadCrc) return false;
+
+        gen = fileGen;
+        payload = bytes.substr(kHeaderSize);
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+bool CheckpointManager::loadLatest(std::string& payload) {
+    uint64_t bestGen = 0;
+    bool found = false;
+
+    for (int slot = 0; slot < 2; ++slot) {
+        uint64_t gen;
+        std::string data;
+        if (!readSlot(slotPath(slot), gen, data)) {
+            std::cerr << "Checkpoint: " << slotPath(slot) << " missing or invalid, ignoring." << std::endl;
+            continue;
+        }
+        if (!found || gen > bestGen) {
+            bestGen = gen;
+            payload = std::move(data);
+            found = true;
+        }
+    }
+
+    if (found) {
+        generation = bestGen;
+        std::cout << "Checkpoint: restored generation " << bestGen << " (" << payload.size() << " bytes)" << std::endl;
+    }
+    return found;
+}
+
+bool CheckpointManager::writeThrottled(std::FILE* file, const std::string& bytes) const {
+    auto started = std::chrono::steady_clock::now();
+    size_t written = 0;
+
+    while (written < bytes.size()) {
+        size_t chunk = std::min(kWriteChunk, bytes.size() - written);
+        if (std::fwrite(bytes.data() + written, 1, chunk, file) != chunk) return false;
+        written += chunk;
+
+        if (maxBytesPerSecond > 0) {
+            // Sleep until the average rate since 'started' is back under the limit.
+            auto due = started + std::chrono::microseconds(written * 1000000 / maxBytesPerSecond);
+            std::this_thread::sleep_until(due);
+        }
+    }
+    return true;
+}
+
+bool CheckpointManager::write(const std::string& payload) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    uint64_t nextGen = generation + 1;
+
+    ByteWriter header;
+    header.putU32(kCheckpointMagic);
+    header.putU32(kCheckpointVersion);
+    header.putU64(nextGen);
+    header.putU64(payload.size());
+    header.putU32(crc32(payload.data(), payload.size()));
+    header.putU32(crc32(header.data().data(), header.size()));
+
+    // The slot we overwrite always holds the *older* generation.
+    std::string path = slotPath(nextGen);
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        std::cerr << "Checkpoint: could not open " << path << " for writing." << std::endl;
+        return false;
+    }
+
+    bool ok = writeThrottled(file, header.data()) && writeThrottled(file, payload) && flushToDisk(file);
+    ok = (std::fclose(file) == 0) && ok;
+
+    if (!ok) {
+        std::cerr << "Checkpoint: write to " << path << " failed; previous generation kept." << std::endl;
+        return false;
+    }
+    generation = nextGen;
+    return true;
+}
+
+void CheckpointManager::start(std::chrono::seconds interval, SnapshotFn snapshot, CommittedFn committed) {
+    stop();
+    stopRequested = false;
+
+    worker = std::thread([this, interval, snapshot, committed]() {
+        std::unique_lock<std::mutex> lock(workerMutex);
+        while (true) {
+            bool stopping = workerWake.wait_for(lock, interval, [this]() { return stopRequested; });
+
+            // Snapshot and write without holding workerMutex so stop() is never blocked on I/O.
+            lock.unlock();
+            if (write(snapshot()) && committed) {
+                committed();
+            }
+            lock.lock();
+
+            if (stopping) break;
+        }
+    });
+}
+
+void CheckpointManager::stop() {
+    {
+        std::lock_guard<std::mutex> lock(workerMutex);
+        stopRequested = true;
+    }
+    workerWake.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
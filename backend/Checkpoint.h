@@ -0,0 +1,82 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <string>
+#include <cstdint>
+#include <cstdio>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+/**
+ * @class CheckpointManager
+ * @brief Crash-consistent, double-buffered checkpoint files.
+ *
+ * State is written alternately to "<base>.0" and "<base>.1". Each file has a
+ * header with a generation counter, the payload length and CRC-32 checksums
+ * of both the header and the payload. A write only ever overwrites the
+ * *older* slot, so if the process dies mid-write the other file still holds
+ * the last good checkpoint; on startup the valid file with the highest
+ * generation wins.
+ *
+ * The manager only deals with opaque bytes. Callers supply a snapshot
+ * function that copies whatever state they need (taking their own locks only
+ * for the duration of the copy) and serializes it.
+ */
+class CheckpointManager {
+public:
+    using SnapshotFn = std::function<std::string()>;
+    using CommittedFn = std::function<void()>;
+
+private:
+    std::string basePath;
+    uint64_t maxBytesPerSecond; // 0 = unlimited
+    std::atomic<uint64_t> generation; // Generation of the newest valid checkpoint
+    std::mutex writeMutex;            // Serializes write() callers
+
+    std::thread worker;
+    std::mutex workerMutex;
+    std::condition_variable workerWake;
+    bool stopRequested;
+
+    std::string slotPath(uint64_t gen) const;
+    bool readSlot(const std::string& path, uint64_t& gen, std::string& payload) const;
+    bool writeThrottled(std::FILE* file, const std::string& bytes) const;
+
+public:
+    /**
+     * @param base Path prefix for the two checkpoint files.
+     * @param bytesPerSecond Upper bound on write bandwidth (0 = unlimited).
+     */
+    CheckpointManager(const std::string& base, uint64_t bytesPerSecond);
+    ~CheckpointManager();
+
+    /**
+     * @brief Loads the newest valid checkpoint, if any.
+     * @param payload Receives the checkpoint contents.
+     * @return true if a valid checkpoint was found.
+     */
+    bool loadLatest(std::string& payload);
+
+    /**
+     * @brief Synchronously writes payload as the next generation.
+     * @return true once the data has been written and flushed to disk.
+     */
+    bool write(const std::string& payload);
+
+    /**
+     * @brief Starts a background thread that calls snapshot() and writes the
+     * result every interval. A final checkpoint is written on stop().
+     * @param committed Optional; called after each successful write, before
+     * the next snapshot.
+     */
+    void start(std::chrono::seconds interval, SnapshotFn snapshot, CommittedFn committed = nullptr);
+    void stop();
+
+    uint64_t getGeneration() const { return generation; }
+};
+
+#endif // CHECKPOINT_H
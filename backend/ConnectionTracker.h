@@ -0,0 +1,81 @@
+#ifndef CONNECTION_TRACKER_H
+#define CONNECTION_TRACKER_H
+
+#include "crow_all.h"
+#include "json.hpp"
+#include "MemoryUsage.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @struct ConnectionTracker
+ * @brief Crow middleware that accounts for the buffers Crow holds on
+ * behalf of requests being handled.
+ *
+ * Every request in flight pins its connection's fixed read buffer
+ * (kReadBufferBytes in Crow's Connection) plus the parsed URL, headers and
+ * body. The response body joins them once the handler returns. Crow keeps
+ * its connection list private, so idle keep-alive connections (one read
+ * buffer each) are not visible here; the counts cover connections that are
+ * serving a request.
+ */
+struct ConnectionTracker {
+    static constexpr size_t kReadBufferBytes = 4096;
+
+    struct context {
+        size_t requestBytes = 0;
+    };
+
+    std::atomic<int64_t> inFlight{0};
+    std::atomic<int64_t> inFlightBytes{0};
+    std::atomic<uint64_t> peakInFlightBytes{0};
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> largestRequestBytes{0};
+    std::atomic<uint64_t> largestResponseBytes{0};
+
+    static size_t requestHeapBytes(const crow::request& req) {
+        size_t bytes = kReadBufferBytes + stringHeapBytes(req.raw_url) + stringHeapBytes(req.url) +
+                       stringHeapBytes(req.body) + stringHeapBytes(req.remote_ip_address);
+        for (const auto& header : req.headers) {
+            bytes += sizeof(header) + kHashNodeOverhead + stringHeapBytes(header.first) + stringHeapBytes(header.second);
+        }
+        return bytes;
+    }
+
+    static void raiseTo(std::atomic<uint64_t>& peak, uint64_t value) {
+        uint64_t seen = peak.load(std::memory_order_relaxed);
+        while (value > seen && !peak.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    void before_handle(crow::request& req, crow::response& /*res*/, context& ctx) {
+        ctx.requestBytes = requestHeapBytes(req);
+        inFlight.fetch_add(1, std::memory_order_relaxed);
+        int64_t now = inFlightBytes.fetch_add(static_cast<int64_t>(ctx.requestBytes), std::memory_order_relaxed) +
+                      static_cast<int64_t>(ctx.requestBytes);
+        if (now > 0) raiseTo(peakInFlightBytes, static_cast<uint64_t>(now));
+        requests.fetch_add(1, std::memory_order_relaxed);
+        raiseTo(largestRequestBytes, ctx.requestBytes);
+    }
+
+    void after_handle(crow::request& /*req*/, crow::response& res, context& ctx) {
+        raiseTo(largestResponseBytes, res.body.size());
+        inFlightBytes.fetch_sub(static_cast<int64_t>(ctx.requestBytes), std::memory_order_relaxed);
+        inFlight.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    nlohmann::json getStatsJson() const {
+        nlohmann::json stats;
+        stats["requestsInFlight"] = inFlight.load(std::memory_order_relaxed);
+        stats["bytesInFlight"] = inFlightBytes.load(std::memory_order_relaxed);
+        stats["peakBytesInFlight"] = peakInFlightBytes.load(std::memory_order_relaxed);
+        stats["readBufferBytesPerConnection"] = kReadBufferBytes;
+        stats["requests"] = requests.load(std::memory_order_relaxed);
+        stats["largestRequestBytes"] = largestRequestBytes.load(std::memory_order_relaxed);
+        stats["largestResponseBytes"] = largestResponseBytes.load(std::memory_order_relaxed);
+        return stats;
+    }
+};
+
+#endif // CONNECTION_TRACKER_H
@@ -0,0 +1,191 @@
+#include "EloRating.h"
+#include "QuestionBank.h"
+#include "MemoryUsage.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Rebuild the sorted snapshot after this many updates, or a quarter of
+    // the bank if larger, so the O(n log n) re-sort stays amortized O(log n).
+    const uint64_t kMinUpdatesPerRebuild = 1024;
+
+    int64_t toFixed(double value) {
+        return static_cast<int64_t>(std::llround(value * EloRatings::kFixedPointScale));
+    }
+}
+
+double EloRatings::expectedScore(double skill, double difficulty) {
+    return 1.0 / (1.0 + std::exp(difficulty - skill));
+}
+
+double EloRatings::stepSize(uint64_t answers) {
+    return kBaseK / (1.0 + kKDecay * static_cast<double>(answers));
+}
+
+EloRatings::~EloRatings() {
+    stopRebuilder();
+}
+
+void EloRatings::initFromBank(const QuestionBank& bank) {
+    count = bank.size();
+    ratings.reset(new AtomicRating[count]);
+    for (size_t id = 0; id < count; ++id) {
+        double a, b;
+        if (!bank.getCalibratedParams(static_cast<int>(id), a, b)) {
+            b = bank.getQuestionById(static_cast<int>(id))->getDifficulty() - 2.0;
+        }
+        ratings[id].difficulty.store(toFixed(b), std::memory_order_relaxed);
+    }
+    rebuildIndex();
+}
+
+double EloRatings::getDifficulty(int questionId) const {
+    if (questionId < 0 || static_cast<size_t>(questionId) >= count) return 0.0;
+    return ratings[questionId].difficulty.load(std::memory_order_relaxed) / kFixedPointScale;
+}
+
+uint64_t EloRatings::getAnswerCount(int questionId) const {
+    if (questionId < 0 || static_cast<size_t>(questionId) >= count) return 0;
+    return ratings[questionId].answers.load(std::memory_order_relaxed);
+}
+
+double EloRatings::recordAnswer(int questionId, double learnerSkill, bool correct) {
+    if (questionId < 0 || static_cast<size_t>(questionId) >= count) {
+        return 0.5;
+    }
+    AtomicRating& r = ratings[questionId];
+    double expected = expectedScore(learnerSkill, r.difficulty.load(std::memory_order_relaxed) / kFixedPointScale);
+    uint64_t seen = r.answers.fetch_add(1, std::memory_order_relaxed);
+
+    // A correct answer means the item was easier than predicted.
+    double delta = -stepSize(seen) * ((correct ? 1.0 : 0.0) - expected);
+    r.difficulty.fetch_add(toFixed(delta), std::memory_order_relaxed);
+
+    maybeRebuildIndex();
+    return expected;
+}
+
+void EloRatings::maybeRebuildIndex() {
+    uint64_t threshold = std::max<uint64_t>(kMinUpdatesPerRebuild, count / 4);
+    uint64_t updates = updatesSinceRebuild.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (rebuilderRunning.load(std::memory_order_acquire)) {
+        // Exactly one request crosses the threshold; the rebuilder resets the count.
+        if (updates == threshold) {
+            {
+                std::lock_guard<std::mutex> lock(rebuilderMutex);
+                rebuildRequested = true;
+            }
+            rebuilderWake.notify_one();
+        }
+        return;
+    }
+    if (updates < threshold) {
+        return;
+    }
+    // Whoever crosses the threshold rebuilds; everyone else carries on.
+    std::unique_lock<std::mutex> lock(rebuildMutex, std::try_to_lock);
+    if (!lock.owns_lock()) return;
+    updatesSinceRebuild.store(0, std::memory_order_relaxed);
+    lock.unlock();
+    rebuildIndex();
+}
+
+void EloRatings::rebuildIndex() {
+    std::lock_guard<std::mutex> lock(rebuildMutex);
+    std::shared_ptr<SortedIndex> index = std::make_shared<SortedIndex>();
+    index->reserve(count);
+    for (size_t id = 0; id < count; ++id) {
+        index->emplace_back(getDifficulty(static_cast<int>(id)), static_cast<int>(id));
+    }
+    std::sort(index->begin(), index->end());
+    std::atomic_store(&sortedIndex, std::shared_ptr<const SortedIndex>(index));
+}
+
+void EloRatings::startRebuilder() {
+    stopRebuilder();
+    stopRequested = false;
+    rebuildRequested = false;
+    // Count from zero, so the threshold is crossed (and a rebuild requested)
+    // exactly once per rebuild.
+    updatesSinceRebuild.store(0, std::memory_order_relaxed);
+
+    rebuilder = std::thread([this]() {
+        std::unique_lock<std::mutex> lock(rebuilderMutex);
+        while (true) {
+            rebuilderWake.wait(lock, [this]() { return rebuildRequested || stopRequested; });
+            if (stopRequested) break;
+            rebuildRequested = false;
+            lock.unlock();
+            updatesSinceRebuild.store(0, std::memory_order_relaxed);
+            rebuildIndex();
+            lock.lock();
+        }
+    });
+    rebuilderRunning.store(true, std::memory_order_release);
+}
+
+void EloRatings::stopRebuilder() {
+    rebuilderRunning.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(rebuilderMutex);
+        stopRequested = true;
+    }
+    rebuilderWake.notify_all();
+    if (rebuilder.joinable()) {
+        rebuilder.join();
+    }
+}
+
+Question* EloRatings::selectNearest(double targetDifficulty, const QuestionBank& bank, const std::vector<bool>& usedMask) const {
+    std::shared_ptr<const SortedIndex> index = std::atomic_load(&sortedIndex);
+    if (!index || index->empty()) return nullptr;
+
+    // Two cursors moving away from the target; always take the closer one.
+    auto split = std::lower_bound(index->begin(), index->end(), std::make_pair(targetDifficulty, -1));
+    auto up = split;
+    auto down = split;
+    while (up != index->end() || down != index->begin()) {
+        bool takeUp;
+        if (up == index->end()) takeUp = false;
+        else if (down == index->begin()) takeUp = true;
+        else takeUp = (up->first - targetDifficulty) <= (targetDifficulty - (down - 1)->first);
+
+        int id = takeUp ? (up++)->second : (--down)->second;
+        if (bank.isAvailable(id, usedMask)) {
+            return bank.getQuestionById(id);
+        }
+    }
+    return nullptr;
+}
+
+void EloRatings::serialize(ByteWriter& out) const {
+    out.putVarint(count);
+    for (size_t id = 0; id < count; ++id) {
+        out.putSignedVarint(ratings[id].difficulty.load(std::memory_order_relaxed));
+        out.putVarint(ratings[id].answers.load(std::memory_order_relaxed));
+    }
+}
+
+void EloRatings::restore(ByteReader& in) {
+    uint64_t stored = in.getVarint();
+    for (uint64_t id = 0; id < stored; ++id) {
+        int64_t difficulty = in.getSignedVarint();
+        uint64_t answers = in.getVarint();
+
+        // If the bank shrank since the checkpoint, drop the extra entries.
+        if (id < count) {
+            ratings[id].difficulty.store(difficulty, std::memory_order_relaxed);
+            ratings[id].answers.store(answers, std::memory_order_relaxed);
+        }
+    }
+    rebuildIndex();
+}
+
+size_t EloRatings::memoryUsage() const {
+    size_t bytes = count * sizeof(AtomicRating);
+    std::shared_ptr<const SortedIndex> index = std::atomic_load(&sortedIndex);
+    if (index) {
+        bytes += sizeof(SortedIndex) + vectorHeapBytes(*index);
+    }
+    return bytes;
+}
@@ -0,0 +1,126 @@
+#ifndef ELO_RATING_H
+#define ELO_RATING_H
+
+#include "BinaryIO.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Forward declarations
+class Question;
+class QuestionBank;
+
+/**
+ * @class EloRatings
+ * @brief Online Elo-style difficulty rating of every question.
+ *
+ * Uses the educational variant of Elo on a logit scale, so ratings are
+ * directly comparable with IRT difficulty b and learner ability:
+ *   P(correct) = 1 / (1 + exp(-(skill - difficulty)))
+ * After each answer both sides move by K * (outcome - P). K shrinks with the
+ * number of answers seen (Glicko-style uncertainty), so new items and new
+ * learners settle quickly while established ratings stay stable.
+ *
+ * Item ratings are shared by every session and Crow worker thread. Each is a
+ * fixed-point integer updated with a single atomic fetch_add, so a popular
+ * question never becomes a lock.
+ */
+class EloRatings {
+public:
+    static constexpr double kFixedPointScale = 1e6; // Fixed-point units per logit
+    static constexpr double kBaseK = 1.0;
+    static constexpr double kKDecay = 0.05;
+
+    static double expectedScore(double skill, double difficulty);
+
+    /**
+     * @brief Update step size after 'answers' previous answers: kBaseK / (1 + kKDecay * answers).
+     */
+    static double stepSize(uint64_t answers);
+
+private:
+    struct AtomicRating {
+        std::atomic<int64_t> difficulty{0}; // Fixed point, see kFixedPointScale
+        std::atomic<uint64_t> answers{0};
+    };
+
+    typedef std::vector<std::pair<double, int>> SortedIndex; // (difficulty, question id), ascending
+
+    std::unique_ptr<AtomicRating[]> ratings;
+    size_t count = 0;
+
+    // Nearest-rating selection reads an immutable sorted snapshot, swapped in
+    // with std::atomic_store. It is rebuilt after enough updates to matter.
+    std::shared_ptr<const SortedIndex> sortedIndex;
+    std::atomic<uint64_t> updatesSinceRebuild{0};
+    std::mutex rebuildMutex; // Only one rebuild at a time; readers never wait on it
+
+    // --- Background rebuilder (see startRebuilder) ---
+    std::thread rebuilder;
+    std::mutex rebuilderMutex;
+    std::condition_variable rebuilderWake;
+    bool rebuildRequested = false;
+    bool stopRequested = false;
+    std::atomic<bool> rebuilderRunning{false};
+
+    void maybeRebuildIndex();
+
+public:
+    EloRatings() {}
+    ~EloRatings();
+
+    /**
+     * @brief Sizes the table and seeds each question's rating from its
+     * calibrated IRT b if the bank has one, otherwise difficulty - 2
+     * (1 -> -1, 2 -> 0, 3 -> +1). Call once, before serving requests.
+     */
+    void initFromBank(const QuestionBank& bank);
+
+    double getDifficulty(int questionId) const;
+    uint64_t getAnswerCount(int questionId) const;
+    size_t size() const { return count; }
+
+    // Heap bytes held by the rating table and the current sorted snapshot.
+    size_t memoryUsage() const;
+
+    /**
+     * @brief Applies one answer to the question's rating.
+     * @param learnerSkill The learner's rating before this answer.
+     * @return The expected score used for the update, so the learner side
+     *         (UserStats::updateRating) can apply the same surprise.
+     */
+    double recordAnswer(int questionId, double learnerSkill, bool correct);
+
+    /**
+     * @brief Re-sorts the selection snapshot from the live ratings. O(n log n).
+     */
+    void rebuildIndex();
+
+    /**
+     * @brief Moves snapshot rebuilds to a background thread: the request
+     * that crosses the update threshold only wakes it, so no request pays
+     * for the O(n log n) sort. Without it (tools), that request rebuilds inline.
+     */
+    void startRebuilder();
+    void stopRebuilder();
+
+    /**
+     * @brief The unused question whose rating is closest to targetDifficulty
+     * and that passes the bank's exposure control (QuestionBank::isAvailable).
+     * Walks outwards from the target in the sorted snapshot, so the cost is
+     * O(log n + skipped questions).
+     * @return nullptr only if every question has been used.
+     */
+    Question* selectNearest(double targetDifficulty, const QuestionBank& bank, const std::vector<bool>& usedMask) const;
+
+    // Binary (de)serialization used by checkpoints.
+    void serialize(ByteWriter& out) const;
+    void restore(ByteReader& in);
+};
+
+#endif // ELO_RATING_H
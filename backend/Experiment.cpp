@@ -0,0 +1,187 @@
+#include "Experiment.h"
+#include "SelectionPolicy.h"
+#include "UserStats.h"
+#include "Utils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+namespace {
+    // FNV-1a mixes the low bits poorly; finish with a 64-bit avalanche so
+    // "hash % weight" is uniform even for sequential session ids.
+    uint64_t mix64(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ull;
+        h ^= h >> 33;
+        return h;
+    }
+}
+
+bool Experiment::configure(const std::string& experimentName, const std::string& spec, const PolicyRegistry& registry) {
+    std::vector<std::unique_ptr<Arm>> parsed;
+    uint64_t weightSum = 0;
+
+    std::stringstream ss(spec);
+    std::string entry;
+    while (std::getline(ss, entry, ',')) {
+        entry = trim(entry);
+        if (entry.empty()) continue;
+
+        std::unique_ptr<Arm> arm(new Arm());
+        size_t colon = entry.find(':');
+        arm->policyName = trim(entry.substr(0, colon));
+        if (colon != std::string::npos) {
+            long long weight = std::atoll(entry.substr(colon + 1).c_str());
+            if (weight <= 0) {
+                std::cerr << "Experiment: arm '" << entry << "' needs a positive weight." << std::endl;
+                return false;
+            }
+            arm->weight = static_cast<uint64_t>(weight);
+        }
+        arm->policy = registry.find(arm->policyName);
+        if (arm->policy == nullptr) {
+            std::cerr << "Experiment: unknown selection policy '" << arm->policyName << "'." << std::endl;
+            return false;
+        }
+        weightSum += arm->weight;
+        parsed.push_back(std::move(arm));
+    }
+
+    if (parsed.size() < 2) {
+        std::cerr << "Experiment: needs at least two arms, got '" << spec << "'." << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < parsed.size(); ++i) {
+        parsed[i]->tag = mix64(fnv1a64(experimentName + ':' + std::to_string(i) + ':' + parsed[i]->policyName)) | 1;
+    }
+    name = experimentName;
+    arms = std::move(parsed);
+    totalWeight = weightSum;
+    return true;
+}
+
+int Experiment::assign(const std::string& unit) const {
+    if (arms.empty()) return -1;
+    uint64_t bucket = mix64(fnv1a64(name + ':' + unit)) % totalWeight;
+    for (size_t i = 0; i < arms.size(); ++i) {
+        if (bucket < arms[i]->weight) return static_cast<int>(i);
+        bucket -= arms[i]->weight;
+    }
+    return static_cast<int>(arms.size()) - 1;
+}
+
+void Experiment::recordStart(int arm) {
+    arms[arm]->starts.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Experiment::recordSelection(int arm, uint64_t nanos, bool served) {
+    arms[arm]->selectionLatency.record(nanos);
+    if (served) {
+        arms[arm]->served.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Experiment::recordAnswer(int arm, ExperimentCounts& unit, bool correct, int answersToMastery) {
+    Arm& a = *arms[arm];
+    a.answered.fetch_add(1, std::memory_order_relaxed);
+    if (correct) {
+        a.correct.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (unit.arm != a.tag) {
+        unit = ExperimentCounts();
+        unit.arm = a.tag;
+    }
+    // (n+1)^2 - n^2 = 2n+1; (y+c)^2 - y^2 = c(2y+1); (n+1)(y+c) - ny = y + c(n+1).
+    uint64_t n = unit.answered, y = unit.correct, c = correct ? 1 : 0;
+    if (n == 0) {
+        a.sessions.fetch_add(1, std::memory_order_relaxed);
+    }
+    a.sumAnsweredSquared.fetch_add(2 * n + 1, std::memory_order_relaxed);
+    a.sumCorrectSquared.fetch_add(c * (2 * y + 1), std::memory_order_relaxed);
+    a.sumAnsweredCorrect.fetch_add(y + c * (n + 1), std::memory_order_relaxed);
+    unit.answered = n + 1;
+    unit.correct = y + c;
+
+    if (answersToMastery >= 0) {
+        a.masteredTopics.fetch_add(1, std::memory_order_relaxed);
+        a.answersToMastery.fetch_add(static_cast<uint64_t>(answersToMastery), std::memory_order_relaxed);
+    }
+}
+
+namespace {
+    /**
+     * Accuracy over an arm's sessions and its cluster-robust variance:
+     * p = sum(y) / sum(n), Var(p) = k/(k-1) * sum((y_i - p n_i)^2) / sum(n)^2
+     * for k sessions with n_i answers, y_i of them correct. The squared
+     * residuals are expanded as sum(y^2) - 2p sum(ny) + p^2 sum(n^2).
+     */
+    struct ClusteredAccuracy {
+        size_t sessions = 0;
+        double accuracy = 0.0;
+        double variance = -1.0; // Negative until there are two sessions
+    };
+}
+
+nlohmann::json Experiment::getReportJson() const {
+    nlohmann::json report;
+    report["experiment"] = name;
+    report["active"] = isActive();
+    report["arms"] = nlohmann::json::array();
+
+    ClusteredAccuracy control;
+    for (size_t i = 0; i < arms.size(); ++i) {
+        const Arm& a = *arms[i];
+        double answered = static_cast<double>(a.answered.load(std::memory_order_relaxed));
+        double correct = static_cast<double>(a.correct.load(std::memory_order_relaxed));
+
+        // Relaxed loads of live counters: a report taken mid-answer can be
+        // off by that answer, which is why the residual sum is clamped at 0.
+        ClusteredAccuracy clustered;
+        clustered.sessions = a.sessions.load(std::memory_order_relaxed);
+        if (answered > 0) {
+            clustered.accuracy = correct / answered;
+            if (clustered.sessions >= 2) {
+                double p = clustered.accuracy;
+                double sumSquares = static_cast<double>(a.sumCorrectSquared.load(std::memory_order_relaxed)) -
+                                    2.0 * p * static_cast<double>(a.sumAnsweredCorrect.load(std::memory_order_relaxed)) +
+                                    p * p * static_cast<double>(a.sumAnsweredSquared.load(std::memory_order_relaxed));
+                double k = static_cast<double>(clustered.sessions);
+                clustered.variance = k / (k - 1.0) * std::max(0.0, sumSquares) / (answered * answered);
+            }
+        }
+        uint64_t mastered = a.masteredTopics.load(std::memory_order_relaxed);
+        LatencyHistogram::Snapshot latency = a.selectionLatency.snapshot();
+
+        nlohmann::json arm;
+        arm["arm"] = i;
+        arm["policy"] = a.policyName;
+        arm["weight"] = a.weight;
+        arm["starts"] = a.starts.load(std::memory_order_relaxed);
+        arm["served"] = a.served.load(std::memory_order_relaxed);
+        arm["answered"] = a.answered.load(std::memory_order_relaxed);
+        arm["sessions"] = clustered.sessions;
+        arm["accuracy"] = answered > 0 ? correct / answered : 0.0;
+        arm["masteredTopics"] = mastered;
+        arm["meanAnswersToMastery"] = mastered ? static_cast<double>(a.answersToMastery.load(std::memory_order_relaxed)) / mastered : 0.0;
+        arm["selectionP50Micros"] = latency.percentile(0.50) / 1000.0;
+        arm["selectionP99Micros"] = latency.percentile(0.99) / 1000.0;
+
+        if (i == 0) {
+            control = clustered;
+            arm["control"] = true;
+        } else if (clustered.variance >= 0.0 && control.variance >= 0.0) {
+            double diff = clustered.accuracy - control.accuracy;
+            double se = std::sqrt(clustered.variance + control.variance);
+            arm["accuracyDiffVsControl"] = diff;
+            arm["standardErrorVsControl"] = se;
+            arm["zScoreVsControl"] = se > 0 ? diff / se : 0.0;
+        }
+        report["arms"].push_back(arm);
+    }
+    return report;
+}
@@ -0,0 +1,103 @@
+#ifndef EXPERIMENT_H
+#define EXPERIMENT_H
+
+#include "LatencyHistogram.h"
+#include "json.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class SelectionPolicy;
+class PolicyRegistry;
+struct ExperimentCounts;
+
+/**
+ * @class Experiment
+ * @brief A/B (or A/B/n) test of selection policies.
+ *
+ * A session's arm is a pure function of the experiment name and session id
+ * (a 64-bit hash taken modulo the total arm weight), so any server process
+ * assigns the same session to the same arm and no assignment table is
+ * kept. Changing the experiment name reshuffles everyone.
+ *
+ * Each arm keeps lock-free counters: questions served, answers, correct
+ * answers, topics brought to BKT mastery (and the answers that took), and
+ * a selection latency histogram. The first arm is the control.
+ *
+ * The session is the unit of randomization, and one learner's answers are
+ * correlated, so the report's z-scores use a session-clustered standard
+ * error. Each session carries its own (answers, correct) counts
+ * (ExperimentCounts in UserStats); from their per-answer changes the arm
+ * keeps atomic sums of n^2, y^2 and n*y plus a session count, which is all
+ * the clustered variance needs.
+ */
+class Experiment {
+private:
+    struct Arm {
+        std::string policyName;
+        SelectionPolicy* policy = nullptr;
+        uint64_t weight = 1;
+        uint64_t tag = 0; // Identifies the arm in a session's ExperimentCounts; never 0
+
+        std::atomic<uint64_t> starts{0};
+        std::atomic<uint64_t> served{0};
+        std::atomic<uint64_t> answered{0};
+        std::atomic<uint64_t> correct{0};
+        std::atomic<uint64_t> masteredTopics{0};
+        std::atomic<uint64_t> answersToMastery{0}; // Summed over masteredTopics
+        LatencyHistogram selectionLatency;
+
+        // Over sessions i with n_i answers, y_i correct: count, sum n_i^2, sum y_i^2, sum n_i*y_i.
+        std::atomic<uint64_t> sessions{0};
+        std::atomic<uint64_t> sumAnsweredSquared{0};
+        std::atomic<uint64_t> sumCorrectSquared{0};
+        std::atomic<uint64_t> sumAnsweredCorrect{0};
+    };
+
+    std::string name;
+    std::vector<std::unique_ptr<Arm>> arms;
+    uint64_t totalWeight = 0;
+
+public:
+    /**
+     * @brief Sets up the experiment from a spec like "weakest:50,bandit:50"
+     * (policy:weight, weight defaults to 1). Every policy must be registered.
+     * @return false (and prints why) if the spec is invalid; the experiment stays inactive.
+     */
+    bool configure(const std::string& experimentName, const std::string& spec, const PolicyRegistry& registry);
+
+    bool isActive() const { return !arms.empty(); }
+    const std::string& getName() const { return name; }
+
+    /**
+     * @param unit The session's stable, per-learner id (never empty).
+     * @return The session's arm index, or -1 if no experiment is running.
+     */
+    int assign(const std::string& unit) const;
+
+    SelectionPolicy* getPolicy(int arm) const { return arms[arm]->policy; }
+
+    void recordStart(int arm);
+    void recordSelection(int arm, uint64_t nanos, bool served);
+
+    /**
+     * @brief Counts one answer. Lock-free.
+     * @param unit The session's counts; updated here. Counts left over from
+     *        another arm or experiment are restarted.
+     * @param answersToMastery If the answer lifted its topic's BKT mastery
+     *        across the threshold, the learner's attempts on that topic so far; otherwise -1.
+     */
+    void recordAnswer(int arm, ExperimentCounts& unit, bool correct, int answersToMastery);
+
+    /**
+     * @brief Per-arm metrics, plus each treatment arm's accuracy difference
+     * from the control and its z-score with session-clustered standard
+     * errors (reported once both arms have at least two sessions).
+     */
+    nlohmann::json getReportJson() const;
+};
+
+#endif // EXPERIMENT_H
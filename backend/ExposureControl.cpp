@@ -0,0 +1,180 @@
+#include "ExposureControl.h"
+#include "ThompsonSampling.h"
+#include "MemoryUsage.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const uint16_t kAlwaysAccept = 65535;
+}
+
+ExposureControl::~ExposureControl() {
+    stopAggregator();
+}
+
+void ExposureControl::configure(size_t questionCount, double maxExposureRate, uint64_t warmupQuizzes,
+                                double windowQuizzes) {
+    itemCount = questionCount;
+    ceiling = maxExposureRate <= 0.0 ? 1.0 : std::min(1.0, maxExposureRate);
+    minQuizzes = warmupQuizzes;
+    halfLifeQuizzes = windowQuizzes > 0.0 ? windowQuizzes : 20.0;
+
+    for (Shard& shard : shards) {
+        shard.proposed.reset(new std::atomic<uint32_t>[itemCount]);
+        shard.administered.reset(new std::atomic<uint32_t>[itemCount]);
+        for (size_t i = 0; i < itemCount; ++i) {
+            shard.proposed[i].store(0, std::memory_order_relaxed);
+            shard.administered[i].store(0, std::memory_order_relaxed);
+        }
+    }
+    acceptance.reset(new std::atomic<uint16_t>[itemCount]);
+    for (size_t i = 0; i < itemCount; ++i) {
+        acceptance[i].store(kAlwaysAccept, std::memory_order_relaxed);
+    }
+
+    std::lock_guard<std::mutex> lock(totalsMutex);
+    totalProposed.assign(itemCount, 0);
+    totalAdministered.assign(itemCount, 0);
+    recentProposed.assign(itemCount, 0.0);
+    recentAdministered.assign(itemCount, 0.0);
+    totalQuizzes = 0;
+    recentQuizzes = 0.0;
+}
+
+ExposureControl::Shard& ExposureControl::shardForThisThread() {
+    // Threads take shards round-robin the first time they get here.
+    static std::atomic<size_t> nextShard{0};
+    thread_local size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % kShards;
+    return shards[shard];
+}
+
+bool ExposureControl::admit(int questionId) {
+    if (!isEnabled() || questionId < 0 || static_cast<size_t>(questionId) >= itemCount) return true;
+    shardForThisThread().proposed[questionId].fetch_add(1, std::memory_order_relaxed);
+
+    uint16_t k = acceptance[questionId].load(std::memory_order_relaxed);
+    if (k == kAlwaysAccept) return true;
+    return static_cast<uint16_t>(FastRng::forThisThread().next() >> 48) < k;
+}
+
+void ExposureControl::recordAdministered(int questionId) {
+    if (!isEnabled() || questionId < 0 || static_cast<size_t>(questionId) >= itemCount) return;
+    shardForThisThread().administered[questionId].fetch_add(1, std::memory_order_relaxed);
+}
+
+void ExposureControl::refresh() {
+    if (!isEnabled()) return;
+
+    std::vector<uint64_t> proposed(itemCount, 0), administered(itemCount, 0);
+    for (const Shard& shard : shards) {
+        for (size_t i = 0; i < itemCount; ++i) {
+            proposed[i] += shard.proposed[i].load(std::memory_order_relaxed);
+            administered[i] += shard.administered[i].load(std::memory_order_relaxed);
+        }
+    }
+    uint64_t quizCount = quizzes.load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(totalsMutex);
+    // Fold in what happened since the last refresh, ageing older evidence
+    // by the number of quizzes that passed (not by wall-clock time).
+    double decay = std::pow(0.5, static_cast<double>(quizCount - totalQuizzes) / halfLifeQuizzes);
+    recentQuizzes = recentQuizzes * decay + static_cast<double>(quizCount - totalQuizzes);
+    double gain = std::min(1.0, static_cast<double>(quizCount - totalQuizzes) / halfLifeQuizzes);
+    for (size_t i = 0; i < itemCount; ++i) {
+        recentProposed[i] = recentProposed[i] * decay + static_cast<double>(proposed[i] - totalProposed[i]);
+        recentAdministered[i] = recentAdministered[i] * decay + static_cast<double>(administered[i] - totalAdministered[i]);
+
+        uint16_t k = kAlwaysAccept;
+        if (quizCount >= minQuizzes && recentQuizzes > 0.0) {
+            // Start from the Sympson-Hetter estimate, then correct it by how
+            // far the measured exposure rate is from the ceiling.
+            double selectionRate = recentProposed[i] / recentQuizzes;
+            double exposureRate = recentAdministered[i] / recentQuizzes;
+            double current = acceptance[i].load(std::memory_order_relaxed) / static_cast<double>(kAlwaysAccept);
+            double target = selectionRate > ceiling ? ceiling / selectionRate : 1.0;
+            if (exposureRate > 0.0 && current < 1.0) {
+                target = std::min(target, current * std::pow(ceiling / exposureRate, gain));
+            }
+            if (target < 1.0) {
+                k = static_cast<uint16_t>(std::max(1.0 / kAlwaysAccept, target) * kAlwaysAccept);
+            }
+        }
+        acceptance[i].store(k, std::memory_order_relaxed);
+    }
+    totalProposed.swap(proposed);
+    totalAdministered.swap(administered);
+    totalQuizzes = quizCount;
+    refreshes++;
+}
+
+void ExposureControl::startAggregator(std::chrono::milliseconds interval) {
+    stopAggregator();
+    stopRequested = false;
+
+    aggregator = std::thread([this, interval]() {
+        std::unique_lock<std::mutex> lock(aggregatorMutex);
+        while (!aggregatorWake.wait_for(lock, interval, [this]() { return stopRequested; })) {
+            lock.unlock();
+            refresh();
+            lock.lock();
+        }
+    });
+}
+
+void ExposureControl::stopAggregator() {
+    {
+        std::lock_guard<std::mutex> lock(aggregatorMutex);
+        stopRequested = true;
+    }
+    aggregatorWake.notify_all();
+    if (aggregator.joinable()) {
+        aggregator.join();
+    }
+}
+
+nlohmann::json ExposureControl::getStatsJson(size_t top) {
+    nlohmann::json stats;
+    stats["enabled"] = isEnabled();
+    stats["ceiling"] = ceiling;
+    if (!isEnabled()) return stats;
+
+    std::lock_guard<std::mutex> lock(totalsMutex);
+    stats["quizzes"] = totalQuizzes;
+    stats["refreshes"] = refreshes;
+
+    std::vector<size_t> order(itemCount);
+    size_t throttled = 0, overCeiling = 0;
+    for (size_t i = 0; i < itemCount; ++i) {
+        order[i] = i;
+        if (acceptance[i].load(std::memory_order_relaxed) != kAlwaysAccept) throttled++;
+        if (recentQuizzes > 0.0 && recentAdministered[i] / recentQuizzes > ceiling) overCeiling++;
+    }
+    stats["throttledItems"] = throttled;
+    stats["itemsOverCeiling"] = overCeiling;
+
+    top = std::min(top, itemCount);
+    std::partial_sort(order.begin(), order.begin() + top, order.end(), [this](size_t x, size_t y) {
+        return recentAdministered[x] > recentAdministered[y];
+    });
+    nlohmann::json items = nlohmann::json::array();
+    for (size_t r = 0; r < top; ++r) {
+        size_t i = order[r];
+        nlohmann::json item;
+        item["id"] = i;
+        item["administered"] = totalAdministered[i];
+        item["proposed"] = totalProposed[i];
+        item["exposureRate"] = recentQuizzes > 0.0 ? recentAdministered[i] / recentQuizzes : 0.0;
+        item["lifetimeExposureRate"] = totalQuizzes > 0 ? static_cast<double>(totalAdministered[i]) / totalQuizzes : 0.0;
+        item["acceptance"] = acceptance[i].load(std::memory_order_relaxed) / 65535.0;
+        items.push_back(item);
+    }
+    stats["mostExposed"] = items;
+    return stats;
+}
+
+size_t ExposureControl::memoryUsage() {
+    size_t bytes = kShards * itemCount * 2 * sizeof(std::atomic<uint32_t>) + itemCount * sizeof(std::atomic<uint16_t>);
+    std::lock_guard<std::mutex> lock(totalsMutex);
+    return bytes + vectorHeapBytes(totalProposed) + vectorHeapBytes(totalAdministered) +
+           vectorHeapBytes(recentProposed) + vectorHeapBytes(recentAdministered);
+}
@@ -0,0 +1,122 @@
+#ifndef EXPOSURE_CONTROL_H
+#define EXPOSURE_CONTROL_H
+
+#include "json.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class ExposureControl
+ * @brief Sympson-Hetter item exposure control with online calibration.
+ *
+ * Every selector proposes its best remaining item; the item is accepted
+ * with probability K_i and otherwise skipped in favor of the next best.
+ * To keep each item's exposure rate P(administered) = K_i * P(selected)
+ * under the ceiling, K_i = min(1, ceiling / P(selected)). P(selected) is
+ * measured live, as the item's proposals per quiz started, so no
+ * simulation is needed before going live. Counts are exponentially
+ * decayed (half-life in quizzes), because lowering K_i makes an item come
+ * up as a candidate more often; cumulative counts would lag far behind.
+ *
+ * Proposal and administration counts are sharded: each Crow worker thread
+ * increments its own cache-line-aligned shard (relaxed atomics, no shared
+ * line bouncing). A background thread sums the shards every refresh
+ * interval and republishes K_i as one relaxed 16-bit atomic per item.
+ * The request path therefore never takes a lock.
+ */
+class ExposureControl {
+public:
+    static const size_t kShards = 16;
+
+private:
+    struct alignas(64) Shard {
+        std::unique_ptr<std::atomic<uint32_t>[]> proposed;
+        std::unique_ptr<std::atomic<uint32_t>[]> administered;
+    };
+
+    size_t itemCount = 0;
+    double ceiling = 1.0;             // Max exposure rate; 1 disables control
+    uint64_t minQuizzes = 20;         // Rates are not trusted (K stays 1) before this many quizzes
+    double halfLifeQuizzes = 20.0;    // Decay of the rate estimates
+    Shard shards[kShards];
+    std::atomic<uint64_t> quizzes{0};
+
+    // K_i in 1/65535 units, written only by the aggregator.
+    std::unique_ptr<std::atomic<uint16_t>[]> acceptance;
+
+    // Aggregator state (guarded by totalsMutex; never touched by requests):
+    // totals as of the last refresh, and their exponentially decayed versions.
+    std::mutex totalsMutex;
+    std::vector<uint64_t> totalProposed;
+    std::vector<uint64_t> totalAdministered;
+    std::vector<double> recentProposed;
+    std::vector<double> recentAdministered;
+    uint64_t totalQuizzes = 0;
+    double recentQuizzes = 0.0;
+    uint64_t refreshes = 0;
+
+    // --- Background aggregator ---
+    std::thread aggregator;
+    std::mutex aggregatorMutex;
+    std::condition_variable aggregatorWake;
+    bool stopRequested = false;
+
+    Shard& shardForThisThread();
+
+public:
+    ExposureControl() {}
+    ~ExposureControl();
+
+    ExposureControl(const ExposureControl&) = delete;
+    ExposureControl& operator=(const ExposureControl&) = delete;
+
+    /**
+     * @brief Sizes the counters for the bank and sets the ceiling (e.g. 0.25:
+     * no item in more than a quarter of quizzes). Call once before serving.
+     */
+    void configure(size_t questionCount, double maxExposureRate, uint64_t warmupQuizzes, double windowQuizzes = 20.0);
+
+    bool isEnabled() const { return itemCount > 0 && ceiling < 1.0; }
+
+    void recordQuizStart() { quizzes.fetch_add(1, std::memory_order_relaxed); }
+
+    /**
+     * @brief Sympson-Hetter filter: counts the proposal and accepts it with
+     * probability K_i. Lock-free.
+     */
+    bool admit(int questionId);
+
+    /**
+     * @brief Counts an item actually served. Lock-free.
+     */
+    void recordAdministered(int questionId);
+
+    /**
+     * @brief Sums the shards and recomputes every K_i. Called by the
+     * aggregator thread; safe to call directly (e.g. from tools).
+     */
+    void refresh();
+
+    /**
+     * @brief Heap bytes held by the shards, acceptance table and aggregator state.
+     */
+    size_t memoryUsage();
+
+    void startAggregator(std::chrono::milliseconds interval);
+    void stopAggregator();
+
+    /**
+     * @brief Ceiling, quizzes, the most exposed items (recent and lifetime
+     * rates as of the last refresh) and how many are throttled or over the ceiling.
+     */
+    nlohmann::json getStatsJson(size_t top = 10);
+};
+
+#endif // EXPOSURE_CONTROL_H
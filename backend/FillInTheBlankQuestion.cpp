@@ -2,7 +2,7 @@
 #include "Utils.h" // For trim() and toLower()
 #include <iostream>
 
-FillInTheBlankQuestion::FillInTheBlankQuestion(const std::string& text, const std::string& topic, int difficulty, const std::string& answer)
+FillInTheBlankQuestion::FillInTheBlankQuestion(const std::string& text, const std::string& topic, double difficulty, const std::string& answer)
     : Question(text, topic, difficulty), correctAnswer(answer) {
     // Body is empty
 }
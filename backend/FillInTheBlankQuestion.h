@@ -12,7 +12,7 @@ private:
     std::string correctAnswer; // The exact word or phrase
 
 public:
-    FillInTheBlankQuestion(const std::string& text, const std::string& top, int diff, const std::string& answer);
+    FillInTheBlankQuestion(const std::string& text, const std::string& top, double diff, const std::string& answer);
 
     // Overridden pure virtual functions
     void display() const override;
@@ -22,6 +22,9 @@ public:
     std::string getQuestionType() const override {
         return "FIB";
     }
+
+    size_t objectBytes() const override { return sizeof(*this); }
+    size_t answerHeapBytes() const override { return stringHeapBytes(correctAnswer); }
 };
 
 #endif // FILL_IN_THE_BLANK_QUESTION_H
\ No newline at end of file
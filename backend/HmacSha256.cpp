@@ -0,0 +1,133 @@
+#include "HmacSha256.h"
+#include <cstring>
+
+namespace {
+    const uint32_t kRoundConstants[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+
+    inline uint32_t rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+}
+
+Sha256::Sha256() : blockLength(0), totalLength(0) {
+    const uint32_t initial[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    std::memcpy(state, initial, sizeof(state));
+}
+
+void Sha256::compress(const unsigned char* chunk) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; ++i) {
+        w[i] = (uint32_t(chunk[4 * i]) << 24) | (uint32_t(chunk[4 * i + 1]) << 16) |
+               (uint32_t(chunk[4 * i + 2]) << 8) | uint32_t(chunk[4 * i + 3]);
+    }
+    for (int i = 16; i < 64; ++i) {
+        uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+
+    for (int i = 0; i < 64; ++i) {
+        uint32_t s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+        uint32_t ch = (e & f) ^ (~e & g);
+        uint32_t t1 = h + s1 + ch + kRoundConstants[i] + w[i];
+        uint32_t s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+        uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t t2 = s0 + maj;
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+void Sha256::update(const void* data, size_t length) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    totalLength += length;
+
+    while (length > 0) {
+        size_t take = 64 - blockLength;
+        if (take > length) take = length;
+        std::memcpy(block + blockLength, bytes, take);
+        blockLength += take;
+        bytes += take;
+        length -= take;
+
+        if (blockLength == 64) {
+            compress(block);
+            blockLength = 0;
+        }
+    }
+}
+
+std::string Sha256::finish() {
+    uint64_t bitLength = totalLength * 8;
+
+    // Padding: a single 1 bit, zeros, then the 64-bit big-endian message length.
+    unsigned char pad = 0x80;
+    update(&pad, 1);
+    unsigned char zero = 0;
+    while (blockLength != 56) {
+        update(&zero, 1);
+    }
+    unsigned char lengthBytes[8];
+    for (int i = 0; i < 8; ++i) {
+        lengthBytes[i] = static_cast<unsigned char>(bitLength >> (56 - 8 * i));
+    }
+    update(lengthBytes, 8);
+
+    std::string digest(32, '\0');
+    for (int i = 0; i < 8; ++i) {
+        digest[4 * i] = static_cast<char>(state[i] >> 24);
+        digest[4 * i + 1] = static_cast<char>(state[i] >> 16);
+        digest[4 * i + 2] = static_cast<char>(state[i] >> 8);
+        digest[4 * i + 3] = static_cast<char>(state[i]);
+    }
+    return digest;
+}
+
+std::string hmacSha256(const std::string& key, const std::string& message) {
+    std::string blockKey = key;
+    if (blockKey.size() > 64) {
+        Sha256 keyHash;
+        keyHash.update(blockKey);
+        blockKey = keyHash.finish();
+    }
+    blockKey.resize(64, '\0');
+
+    std::string innerPad(64, '\0'), outerPad(64, '\0');
+    for (int i = 0; i < 64; ++i) {
+        innerPad[i] = static_cast<char>(blockKey[i] ^ 0x36);
+        outerPad[i] = static_cast<char>(blockKey[i] ^ 0x5c);
+    }
+
+    Sha256 inner;
+    inner.update(innerPad);
+    inner.update(message);
+
+    Sha256 outer;
+    outer.update(outerPad);
+    outer.update(inner.finish());
+    return outer.finish();
+}
+
+bool constantTimeEquals(const std::string& a, const std::string& b) {
+    if (a.size() != b.size()) return false;
+    unsigned char diff = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        diff |= static_cast<unsigned char>(a[i] ^ b[i]);
+    }
+    return diff == 0;
+}
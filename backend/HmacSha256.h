@@ -0,0 +1,52 @@
+#ifndef HMAC_SHA256_H
+#define HMAC_SHA256_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Minimal SHA-256 / HMAC-SHA256 (FIPS 180-4, RFC 2104).
+ *
+ * Self-contained so the server keeps building with just g++ and the bundled
+ * headers - no OpenSSL dependency just to sign session tokens.
+ */
+
+/**
+ * @class Sha256
+ * @brief Incremental SHA-256 hasher.
+ */
+class Sha256 {
+private:
+    uint32_t state[8];
+    unsigned char block[64];
+    size_t blockLength;
+    uint64_t totalLength;
+
+    void compress(const unsigned char* chunk);
+
+public:
+    Sha256();
+    void update(const void* data, size_t length);
+    void update(const std::string& s) { update(s.data(), s.size()); }
+
+    /**
+     * @brief Finishes the hash. The object must not be updated afterwards.
+     * @return The 32-byte raw digest.
+     */
+    std::string finish();
+};
+
+/**
+ * @brief Computes HMAC-SHA256(key, message).
+ * @return The 32-byte raw MAC.
+ */
+std::string hmacSha256(const std::string& key, const std::string& message);
+
+/**
+ * @brief Compares two strings in time independent of where they differ,
+ * so MAC verification does not leak how many leading bytes matched.
+ */
+bool constantTimeEquals(const std::string& a, const std::string& b);
+
+#endif // HMAC_SHA256_H
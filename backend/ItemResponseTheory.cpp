@@ -0,0 +1,172 @@
+#include "ItemResponseTheory.h"
+#include "QuestionBank.h"
+#include "MemoryUsage.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <utility>
+
+int IRTModel::nearestGridPoint(double theta) {
+    int g = static_cast<int>(std::lround((theta - kThetaMin) / kThetaStep));
+    return std::max(0, std::min(kGridPoints - 1, g));
+}
+
+void IRTModel::initFromBank(const QuestionBank& bank) {
+    items.assign(bank.size(), ItemParams());
+    for (size_t id = 0; id < bank.size(); ++id) {
+        ItemParams& p = items[id];
+        if (!bank.getCalibratedParams(static_cast<int>(id), p.a, p.b)) {
+            p.b = bank.getQuestionById(static_cast<int>(id))->getDifficulty() - 2.0;
+        }
+    }
+    rebuildTables();
+}
+
+void IRTModel::setParams(int questionId, const ItemParams& params) {
+    if (questionId >= 0 && static_cast<size_t>(questionId) < items.size()) {
+        items[questionId] = params;
+    }
+}
+
+void IRTModel::rebuildTables() {
+    ranked.assign(kGridPoints, std::vector<int>());
+    size_t keep = std::min(kRankedPerPoint, items.size());
+
+    std::vector<std::pair<double, int>> scored(items.size());
+    for (int g = 0; g < kGridPoints; ++g) {
+        double theta = gridTheta(g);
+        for (size_t id = 0; id < items.size(); ++id) {
+            scored[id] = std::make_pair(information(items[id], theta), static_cast<int>(id));
+        }
+        // Only the top 'keep' need to be ordered; O(n log keep).
+        std::partial_sort(scored.begin(), scored.begin() + keep, scored.end(),
+                          [](const std::pair<double, int>& x, const std::pair<double, int>& y) {
+                              return x.first > y.first;
+                          });
+        ranked[g].reserve(keep);
+        for (size_t i = 0; i < keep; ++i) {
+            ranked[g].push_back(scored[i].second);
+        }
+    }
+}
+
+double IRTModel::probability(const ItemParams& p, double theta) {
+    return 1.0 / (1.0 + std::exp(-p.a * (theta - p.b)));
+}
+
+double IRTModel::information(const ItemParams& p, double theta) {
+    double prob = probability(p, theta);
+    return p.a * p.a * prob * (1.0 - prob);
+}
+
+Question* IRTModel::selectMaxInformation(double theta, const QuestionBank& bank, const std::vector<bool>& usedMask,
+                                         bool* fromShortList) const {
+    if (fromShortList) *fromShortList = true;
+    auto isUsed = [&usedMask](int id) {
+        return static_cast<size_t>(id) < usedMask.size() && usedMask[id];
+    };
+
+    int g = nearestGridPoint(theta);
+    for (int id : ranked[g]) {
+        if (bank.isAvailable(id, usedMask)) {
+            return bank.getQuestionById(id);
+        }
+    }
+
+    // Every short-listed item was used or rejected: fall back to a full scan
+    // of the rest, most informative first, through exposure control too.
+    // The short list is skipped so no item is proposed twice.
+    if (fromShortList) *fromShortList = false;
+    std::vector<int> shortList(ranked[g]);
+    std::sort(shortList.begin(), shortList.end());
+    double gridValue = gridTheta(g);
+    std::vector<std::pair<double, int>> candidates;
+    int bestId = -1;
+    double bestInfo = -1.0;
+    for (size_t id = 0; id < items.size(); ++id) {
+        if (isUsed(static_cast<int>(id))) continue;
+        double info = information(items[id], gridValue);
+        if (info > bestInfo) {
+            bestInfo = info;
+            bestId = static_cast<int>(id);
+        }
+        if (!std::binary_search(shortList.begin(), shortList.end(), static_cast<int>(id))) {
+            candidates.emplace_back(info, static_cast<int>(id));
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), std::greater<std::pair<double, int>>());
+    for (auto& candidate : candidates) {
+        if (bank.isAvailable(candidate.second, usedMask)) {
+            return bank.getQuestionById(candidate.second);
+        }
+    }
+    // Exposure control rejected everything left; serve the best unused item anyway.
+    return bestId >= 0 ? bank.getQuestionById(bestId) : nullptr;
+}
+
+// --- AbilityEstimate ---
+
+AbilityEstimate::AbilityEstimate() {
+    resetToNormal(0.0, 1.0, 0);
+}
+
+void AbilityEstimate::update(const ItemParams& item, bool correct) {
+    for (int g = 0; g < IRTModel::kGridPoints; ++g) {
+        double p = IRTModel::probability(item, IRTModel::gridTheta(g));
+        // Clamp so a near-certain item can never drive a grid point to -inf.
+        p = std::min(1.0 - 1e-12, std::max(1e-12, p));
+        logPosterior[g] += correct ? std::log(p) : std::log(1.0 - p);
+    }
+    responses++;
+    recompute();
+}
+
+void AbilityEstimate::resetToNormal(double mean, double sd, int responseCount) {
+    logPosterior.assign(IRTModel::kGridPoints, 0.0);
+    if (sd <= 0.0) sd = IRTModel::kThetaStep;
+    for (int g = 0; g < IRTModel::kGridPoints; ++g) {
+        double z = (IRTModel::gridTheta(g) - mean) / sd;
+        logPosterior[g] = -0.5 * z * z;
+    }
+    responses = responseCount;
+    recompute();
+}
+
+void AbilityEstimate::widen(double minSd) {
+    if (standardError >= minSd || standardError <= 0.0) return;
+    // For a normal posterior, scaling the log density by f scales the variance by 1/f.
+    double factor = (standardError / minSd) * (standardError / minSd);
+    for (double& logDensity : logPosterior) {
+        logDensity *= factor;
+    }
+    recompute();
+}
+
+void AbilityEstimate::recompute() {
+    // Normalize in log space (subtract the max) to avoid underflow.
+    double maxLog = *std::max_element(logPosterior.begin(), logPosterior.end());
+    double total = 0.0, mean = 0.0, secondMoment = 0.0;
+    for (int g = 0; g < IRTModel::kGridPoints; ++g) {
+        logPosterior[g] -= maxLog;
+        double w = std::exp(logPosterior[g]);
+        double t = IRTModel::gridTheta(g);
+        total += w;
+        mean += w * t;
+        secondMoment += w * t * t;
+    }
+    mean /= total;
+    theta = mean;
+    standardError = std::sqrt(std::max(0.0, secondMoment / total - mean * mean));
+}
+
+size_t IRTModel::memoryUsage() const {
+    size_t bytes = vectorHeapBytes(items) + vectorHeapBytes(ranked);
+    for (const std::vector<int>& point : ranked) {
+        bytes += vectorHeapBytes(point);
+    }
+    return bytes;
+}
+
+size_t AbilityEstimate::memoryUsage() const {
+    return vectorHeapBytes(logPosterior);
+}
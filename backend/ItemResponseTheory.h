@@ -0,0 +1,130 @@
+#ifndef ITEM_RESPONSE_THEORY_H
+#define ITEM_RESPONSE_THEORY_H
+
+#include <vector>
+#include <cstddef>
+
+// Forward declarations
+class Question;
+class QuestionBank;
+
+/**
+ * @struct ItemParams
+ * @brief Two-parameter logistic (2PL) IRT parameters of one question.
+ * P(correct | theta) = 1 / (1 + exp(-a * (theta - b)))
+ */
+struct ItemParams {
+    double a = 1.0; // Discrimination
+    double b = 0.0; // Difficulty, on the same scale as learner ability theta
+};
+
+/**
+ * @class IRTModel
+ * @brief Item parameters for the whole bank plus precomputed Fisher
+ * information rankings over a fixed theta grid.
+ *
+ * For each grid point the model keeps the ids of the most informative items,
+ * best first. Selection walks that short list and returns the first item the
+ * learner has not seen, so it costs O(seen items) in the worst case rather
+ * than a scan of the bank.
+ */
+class IRTModel {
+public:
+    static const int kGridPoints = 81;      // theta = -4.0, -3.9, ..., +4.0
+    static constexpr double kThetaMin = -4.0;
+    static constexpr double kThetaStep = 0.1;
+    static constexpr size_t kRankedPerPoint = 256;
+
+    static double gridTheta(int g) { return kThetaMin + g * kThetaStep; }
+    static int nearestGridPoint(double theta);
+
+private:
+    std::vector<ItemParams> items; // Indexed by question id
+    std::vector<std::vector<int>> ranked; // [grid point] -> item ids by information, descending
+
+public:
+    /**
+     * @brief Takes each question's calibrated parameters if the bank has them
+     * (see QuestionBank::applyOverlay), otherwise defaults derived from its
+     * difficulty (b = difficulty - 2, so 1 -> -1, 3 -> +1; a = 1), and builds
+     * the information tables. Call after the bank and any overlay are loaded.
+     */
+    void initFromBank(const QuestionBank& bank);
+
+    /**
+     * @brief Overrides one item's parameters. Call rebuildTables() afterwards.
+     */
+    void setParams(int questionId, const ItemParams& params);
+    const ItemParams& getParams(int questionId) const { return items[questionId]; }
+    size_t size() const { return items.size(); }
+
+    // Heap bytes held by the item parameters and information rankings.
+    size_t memoryUsage() const;
+
+    /**
+     * @brief Recomputes the per-grid-point information rankings.
+     */
+    void rebuildTables();
+
+    static double probability(const ItemParams& p, double theta);
+    static double information(const ItemParams& p, double theta);
+
+    /**
+     * @brief Returns the unused question with maximum Fisher information at
+     * the grid point nearest theta. Every candidate, including those of the
+     * full-scan fallback, goes through the bank's exposure control once
+     * (see QuestionBank::isAvailable).
+     * @param usedMask usedMask[id] is true if the question was already served
+     *                 (ids past the end count as unused).
+     * @param fromShortList Optional; set to false if the item came from the
+     *                 full-scan fallback.
+     * @return nullptr only if every question has been used.
+     */
+    Question* selectMaxInformation(double theta, const QuestionBank& bank, const std::vector<bool>& usedMask,
+                                   bool* fromShortList = nullptr) const;
+};
+
+/**
+ * @class AbilityEstimate
+ * @brief A learner's ability (theta) posterior on the IRTModel grid.
+ *
+ * Starts from a standard normal prior. Each answer multiplies in the 2PL
+ * likelihood (O(grid points)); the estimate is the posterior mean (EAP) and
+ * the standard error is the posterior standard deviation.
+ */
+class AbilityEstimate {
+private:
+    std::vector<double> logPosterior;
+    double theta;
+    double standardError;
+    int responses;
+
+    void recompute();
+
+public:
+    AbilityEstimate();
+
+    void update(const ItemParams& item, bool correct);
+
+    /**
+     * @brief Replaces the posterior with a normal(mean, sd) approximation.
+     * Used when restoring from compact storage, which keeps only mean and SE.
+     */
+    void resetToNormal(double mean, double sd, int responseCount);
+
+    /**
+     * @brief Flattens the posterior until its standard deviation is at least
+     * minSd, keeping its mean and shape (the log density is tempered).
+     * A no-op if it is already that wide.
+     */
+    void widen(double minSd);
+
+    double getTheta() const { return theta; }
+    double getStandardError() const { return standardError; }
+    int getResponses() const { return responses; }
+
+    // Heap bytes held by the posterior grid.
+    size_t memoryUsage() const;
+};
+
+#endif // ITEM_RESPONSE_THEORY_H
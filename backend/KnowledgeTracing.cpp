@@ -0,0 +1,75 @@
+#include "KnowledgeTracing.h"
+#include "Utils.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <cstdlib>
+
+bool BKTModel::loadFromFile(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    topicParams.clear();
+    std::string line;
+    while (std::getline(file, line)) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#') continue;
+
+        std::stringstream ss(line);
+        std::string topic, field;
+        double values[4];
+        bool ok = static_cast<bool>(std::getline(ss, topic, '|'));
+        for (int i = 0; ok && i < 4; ++i) {
+            ok = static_cast<bool>(std::getline(ss, field, '|'));
+            if (ok) values[i] = std::atof(field.c_str());
+        }
+        if (!ok) {
+            std::cerr << "BKT: skipping malformed line: " << line << std::endl;
+            continue;
+        }
+
+        BKTParams params;
+        params.pInit = values[0];
+        params.pLearn = values[1];
+        params.pSlip = values[2];
+        params.pGuess = values[3];
+        topicParams[trim(topic)] = params;
+    }
+
+    std::cout << "Loaded BKT parameters for " << topicParams.size() << " topics from " << filename << std::endl;
+    return true;
+}
+
+bool BKTModel::saveToFile(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+    file << "# topic|pInit|pLearn|pSlip|pGuess\n";
+    for (auto const& pair : topicParams) {
+        const BKTParams& p = pair.second;
+        file << pair.first << "|" << p.pInit << "|" << p.pLearn << "|" << p.pSlip << "|" << p.pGuess << "\n";
+    }
+    return static_cast<bool>(file);
+}
+
+void BKTModel::setParams(const std::string& topic, const BKTParams& params) {
+    topicParams[topic] = params;
+}
+
+const BKTParams& BKTModel::paramsFor(const std::string& topic) const {
+    auto it = topicParams.find(topic);
+    return it != topicParams.end() ? it->second : defaults;
+}
+
+double BKTModel::update(double pKnown, bool correct, const BKTParams& params) {
+    // Posterior P(known | answer)
+    double known = correct ? pKnown * (1.0 - params.pSlip) : pKnown * params.pSlip;
+    double unknown = correct ? (1.0 - pKnown) * params.pGuess : (1.0 - pKnown) * (1.0 - params.pGuess);
+    double posterior = (known + unknown > 0.0) ? known / (known + unknown) : pKnown;
+
+    // Chance of learning from this attempt
+    return posterior + (1.0 - posterior) * params.pLearn;
+}
@@ -0,0 +1,59 @@
+#ifndef KNOWLEDGE_TRACING_H
+#define KNOWLEDGE_TRACING_H
+
+#include <string>
+#include <map>
+
+/**
+ * @struct BKTParams
+ * @brief The four Bayesian Knowledge Tracing parameters for one topic.
+ */
+struct BKTParams {
+    double pInit = 0.2;   // P(L0): learner already knows the topic before any practice
+    double pLearn = 0.15; // P(T): chance of learning the topic on each attempt
+    double pSlip = 0.1;   // P(S): knows it but answers wrong
+    double pGuess = 0.2;  // P(G): doesn't know it but answers right
+};
+
+/**
+ * @class BKTModel
+ * @brief Per-topic BKT parameters plus the O(1) mastery update.
+ *
+ * Parameters come from a text file with one "topic|pInit|pLearn|pSlip|pGuess"
+ * line per topic ('#' starts a comment). Topics not listed use the defaults.
+ * tools/bkt_fit.cpp produces such a file from the answer log.
+ */
+class BKTModel {
+public:
+    // Mastery probability at which a topic counts as learned.
+    static constexpr double kMasteryThreshold = 0.95;
+
+private:
+    BKTParams defaults;
+    std::map<std::string, BKTParams> topicParams;
+
+public:
+    /**
+     * @brief Loads per-topic parameters, replacing any already loaded.
+     * @return false if the file could not be opened.
+     */
+    bool loadFromFile(const std::string& filename);
+
+    /**
+     * @brief Writes the parameters in the format loadFromFile() reads.
+     */
+    bool saveToFile(const std::string& filename) const;
+
+    void setParams(const std::string& topic, const BKTParams& params);
+    const BKTParams& paramsFor(const std::string& topic) const;
+
+    /**
+     * @brief One BKT step: Bayesian update on the observed answer, then the
+     * learning transition. Constant time.
+     * @param pKnown Current probability that the topic is mastered.
+     * @return The new mastery probability.
+     */
+    static double update(double pKnown, bool correct, const BKTParams& params);
+};
+
+#endif // KNOWLEDGE_TRACING_H
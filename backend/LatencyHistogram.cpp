@@ -0,0 +1,100 @@
+#include "LatencyHistogram.h"
+#include <cmath>
+
+namespace {
+    int highestBit(uint64_t v) {
+        int bit = 0;
+        while (v >>= 1) ++bit;
+        return bit;
+    }
+}
+
+int LatencyHistogram::bucketIndex(uint64_t value) {
+    if (value < static_cast<uint64_t>(kSubBuckets)) {
+        return static_cast<int>(value);
+    }
+    int exponent = highestBit(value); // >= kSubBucketBits
+    int sub = static_cast<int>((value >> (exponent - kSubBucketBits)) & (kSubBuckets - 1));
+    return (exponent - kSubBucketBits + 1) * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::bucketLowerBound(int index) {
+    if (index < kSubBuckets) {
+        return static_cast<uint64_t>(index);
+    }
+    int exponent = index / kSubBuckets + kSubBucketBits - 1;
+    uint64_t sub = static_cast<uint64_t>(index % kSubBuckets);
+    return (static_cast<uint64_t>(kSubBuckets) + sub) << (exponent - kSubBucketBits);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int index) {
+    if (index + 1 >= kBucketCount) return UINT64_MAX;
+    return bucketLowerBound(index + 1);
+}
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+void LatencyHistogram::record(uint64_t nanos) {
+    buckets[bucketIndex(nanos)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(nanos, std::memory_order_relaxed);
+
+    uint64_t seen = max.load(std::memory_order_relaxed);
+    while (nanos > seen && !max.compare_exchange_weak(seen, nanos, std::memory_order_relaxed)) {
+        // 'seen' was refreshed by compare_exchange_weak; retry while still larger.
+    }
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot s;
+    for (int i = 0; i < kBucketCount; ++i) {
+        s.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+    }
+    s.count = count.load(std::memory_order_relaxed);
+    s.sum = sum.load(std::memory_order_relaxed);
+    s.max = max.load(std::memory_order_relaxed);
+    return s;
+}
+
+void LatencyHistogram::reset() {
+    for (int i = 0; i < kBucketCount; ++i) {
+        buckets[i].store(0, std::memory_order_relaxed);
+    }
+    count.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::Snapshot::merge(const Snapshot& other) {
+    for (int i = 0; i < kBucketCount; ++i) {
+        buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    sum += other.sum;
+    if (other.max > max) max = other.max;
+}
+
+uint64_t LatencyHistogram::Snapshot::percentile(double q) const {
+    // Count from the buckets, not 'count': the two can differ by in-flight records.
+    uint64_t total = 0;
+    for (uint64_t b : buckets) total += b;
+    if (total == 0) return 0;
+
+    // Nearest-rank definition: the smallest value with at least q of the samples at or below it.
+    uint64_t rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(total)));
+    if (rank < 1) rank = 1;
+    if (rank > total) rank = total;
+    uint64_t seen = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            uint64_t low = bucketLowerBound(i);
+            uint64_t high = bucketUpperBound(i);
+            uint64_t mid = low + (high - low) / 2;
+            return mid < max ? mid : max;
+        }
+    }
+    return max;
+}
@@ -0,0 +1,327 @@
+#include "Logger.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <thread>
+#include <vector>
+
+namespace {
+    const size_t kRingSize = 1024;        // Records per thread (power of two)
+    const char kCutMarker[] = "...";      // Ends a line that was cut at Logger::kLineBytes
+    const size_t kCutMarkerBytes = sizeof(kCutMarker) - 1;
+    const auto kDrainInterval = std::chrono::milliseconds(10);
+
+    struct Record {
+        uint64_t timestamp;               // Steady-clock nanoseconds, for ordering a batch
+        uint16_t length;
+        uint8_t level;
+        char text[Logger::kLineBytes];
+    };
+
+    /**
+     * Single-producer / single-consumer ring: the owning thread advances
+     * head, the drain thread advances tail. Each index sits on its own
+     * cache line so the two sides do not false-share.
+     */
+    struct ThreadRing {
+        alignas(64) std::atomic<uint64_t> head{0};
+        alignas(64) std::atomic<uint64_t> tail{0};
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<uint64_t> suppressed{0};
+        Record records[kRingSize];
+
+        // Token bucket for LOG_REQUEST; touched by the owning thread only.
+        double tokens = 0.0;
+        std::chrono::steady_clock::time_point lastRefill = std::chrono::steady_clock::now();
+    };
+
+    std::atomic<int> minimumLevel{Logger::Info};
+    std::atomic<bool> running{false};
+    double requestRate = 0.0;             // Per-thread lines/second; 0 = unlimited
+
+    // Rings are registered once per thread and kept until exit, so a Crow
+    // worker that goes away never leaves the drain thread a dangling pointer.
+    std::mutex ringsMutex;
+    std::vector<std::shared_ptr<ThreadRing>> rings;
+
+    std::thread drainer;
+    std::mutex drainMutex;
+    std::condition_variable drainWake;
+    bool stopRequested = false;
+    std::ofstream logFile;
+
+    // Serializes synchronous writes (before start / after stop) with the drainer.
+    std::mutex outputMutex;
+
+    uint64_t nowNanos() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // A streambuf over a fixed array: characters past the end are dropped,
+    // and nothing is ever allocated. One byte beyond kLineBytes lets
+    // write() see that the line was cut.
+    class LineBuffer : public std::streambuf {
+        char text[Logger::kLineBytes + 1];
+
+    public:
+        LineBuffer() { reset(); }
+        void reset() { setp(text, text + sizeof(text)); }
+        const char* data() const { return pbase(); }
+        size_t size() const { return static_cast<size_t>(pptr() - pbase()); }
+
+    protected:
+        int_type overflow(int_type) override { return traits_type::eof(); }
+    };
+
+    struct ThreadLine {
+        LineBuffer buffer;
+        std::ostream stream{&buffer};
+    };
+
+    ThreadLine& lineForThisThread() {
+        thread_local ThreadLine line;
+        return line;
+    }
+
+    ThreadRing& ringForThisThread() {
+        thread_local std::shared_ptr<ThreadRing> ring;
+        if (!ring) {
+            ring = std::make_shared<ThreadRing>();
+            ring->tokens = requestRate;
+            std::lock_guard<std::mutex> lock(ringsMutex);
+            rings.push_back(ring);
+        }
+        return *ring;
+    }
+
+    void emit(int level, const char* text, size_t length) {
+        if (logFile.is_open()) {
+            logFile.write(text, static_cast<std::streamsize>(length)).put('\n');
+        } else if (level >= Logger::Warn) {
+            std::cerr.write(text, static_cast<std::streamsize>(length)).put('\n');
+        } else {
+            std::cout.write(text, static_cast<std::streamsize>(length)).put('\n');
+        }
+    }
+
+    void flushOutput() {
+        if (logFile.is_open()) {
+            logFile.flush();
+        } else {
+            std::cout.flush();
+            std::cerr.flush();
+        }
+    }
+
+    /**
+     * Moves every buffered record out of the rings, writes them in timestamp
+     * order and flushes once. With reportCounts, also notes any lines dropped
+     * or sampled out since the last note.
+     */
+    void drainOnce(std::vector<Record>& batch, bool reportCounts) {
+        static uint64_t reportedDrops = 0, reportedSuppressed = 0;
+
+        batch.clear();
+        uint64_t drops = 0, suppressed = 0;
+        {
+            std::lock_guard<std::mutex> lock(ringsMutex);
+            for (auto& ring : rings) {
+                uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+                uint64_t head = ring->head.load(std::memory_order_acquire);
+                for (; tail != head; ++tail) {
+                    batch.push_back(ring->records[tail & (kRingSize - 1)]);
+                }
+                ring->tail.store(tail, std::memory_order_release);
+                drops += ring->dropped.load(std::memory_order_relaxed);
+                suppressed += ring->suppressed.load(std::memory_order_relaxed);
+            }
+        }
+
+        std::stable_sort(batch.begin(), batch.end(), [](const Record& a, const Record& b) {
+            return a.timestamp < b.timestamp;
+        });
+
+        std::lock_guard<std::mutex> lock(outputMutex);
+        for (const Record& record : batch) {
+            emit(record.level, record.text, record.length);
+        }
+        bool noted = false;
+        if (reportCounts && drops > reportedDrops) {
+            std::string note = "Logger: dropped " + std::to_string(drops - reportedDrops) + " lines (ring full)";
+            emit(Logger::Warn, note.data(), note.size());
+            reportedDrops = drops;
+            noted = true;
+        }
+        if (reportCounts && suppressed > reportedSuppressed) {
+            std::string note = "Logger: sampled out " + std::to_string(suppressed - reportedSuppressed) + " request lines";
+            emit(Logger::Info, note.data(), note.size());
+            reportedSuppressed = suppressed;
+            noted = true;
+        }
+        if (!batch.empty() || noted) {
+            flushOutput();
+        }
+    }
+}
+
+void Logger::start(Level minLevel, double requestLinesPerSecond, const std::string& file) {
+    stop();
+    minimumLevel.store(minLevel, std::memory_order_relaxed);
+    requestRate = requestLinesPerSecond > 0.0 ? requestLinesPerSecond : 0.0;
+    if (!file.empty()) {
+        logFile.open(file, std::ios::app);
+        if (!logFile) {
+            std::cerr << "Could not open log file " << file << "; logging to the console." << std::endl;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(drainMutex);
+        stopRequested = false;
+    }
+    running.store(true, std::memory_order_release);
+
+    drainer = std::thread([]() {
+        std::vector<Record> batch;
+        batch.reserve(kRingSize);
+        auto lastReport = std::chrono::steady_clock::now();
+
+        std::unique_lock<std::mutex> lock(drainMutex);
+        while (!drainWake.wait_for(lock, kDrainInterval, []() { return stopRequested; })) {
+            lock.unlock();
+            // Drop/sample notes at most once a second, so they do not become noise themselves.
+            bool report = std::chrono::steady_clock::now() - lastReport >= std::chrono::seconds(1);
+            if (report) {
+                lastReport = std::chrono::steady_clock::now();
+            }
+            drainOnce(batch, report);
+            lock.lock();
+        }
+        lock.unlock();
+        drainOnce(batch, true);
+    });
+}
+
+void Logger::stop() {
+    // New lines go out synchronously from here on; the final drain writes what is buffered.
+    running.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(drainMutex);
+        stopRequested = true;
+    }
+    drainWake.notify_all();
+    if (drainer.joinable()) {
+        drainer.join();
+    }
+    if (logFile.is_open()) {
+        logFile.close();
+    }
+}
+
+bool Logger::enabled(Level level) {
+    return level >= minimumLevel.load(std::memory_order_relaxed) && level < Off;
+}
+
+bool Logger::sampleRequest() {
+    if (!running.load(std::memory_order_acquire) || requestRate <= 0.0) return true;
+
+    ThreadRing& ring = ringForThisThread();
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - ring.lastRefill).count();
+    ring.lastRefill = now;
+    // Burst of one second's worth of lines.
+    ring.tokens = std::min(requestRate, ring.tokens + elapsed * requestRate);
+    if (ring.tokens < 1.0) {
+        ring.suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    ring.tokens -= 1.0;
+    return true;
+}
+
+void Logger::write(Level level, const std::string& message) {
+    write(level, message.data(), message.size());
+}
+
+void Logger::write(Level level, const char* text, size_t length) {
+    bool cut = length > kLineBytes;
+    if (cut) {
+        length = kLineBytes - kCutMarkerBytes;
+    }
+
+    if (!running.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(outputMutex);
+        std::ostream& out = (level >= Warn) ? std::cerr : std::cout;
+        out.write(text, static_cast<std::streamsize>(length));
+        if (cut) out << kCutMarker;
+        out << std::endl;
+        return;
+    }
+
+    ThreadRing& ring = ringForThisThread();
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) >= kRingSize) {
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    Record& record = ring.records[head & (kRingSize - 1)];
+    record.timestamp = nowNanos();
+    record.level = static_cast<uint8_t>(level);
+    std::memcpy(record.text, text, length);
+    if (cut) {
+        std::memcpy(record.text + length, kCutMarker, kCutMarkerBytes);
+        length += kCutMarkerBytes;
+    }
+    record.length = static_cast<uint16_t>(length);
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+Logger::Level Logger::parseLevel(const std::string& name) {
+    if (name == "debug") return Debug;
+    if (name == "warn") return Warn;
+    if (name == "error") return Error;
+    if (name == "off") return Off;
+    return Info;
+}
+
+uint64_t Logger::droppedCount() {
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    uint64_t total = 0;
+    for (auto& ring : rings) {
+        total += ring->dropped.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t Logger::suppressedCount() {
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    uint64_t total = 0;
+    for (auto& ring : rings) {
+        total += ring->suppressed.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+size_t Logger::memoryUsage() {
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    return rings.size() * sizeof(ThreadRing);
+}
+
+std::ostream& Logger::lineStream() {
+    ThreadLine& line = lineForThisThread();
+    line.buffer.reset();
+    line.stream.clear();
+    return line.stream;
+}
+
+void Logger::writeLine(Level level) {
+    ThreadLine& line = lineForThisThread();
+    write(level, line.buffer.data(), line.buffer.size());
+}
@@ -0,0 +1,106 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/**
+ * @class Logger
+ * @brief Asynchronous logger for the request path.
+ *
+ * Each thread writes fixed-size records into its own single-producer ring
+ * buffer (two atomic indices, no lock, no syscall); a background thread
+ * drains every ring, orders the batch by timestamp and writes it with a
+ * single flush. A full ring drops the line and counts it rather than
+ * blocking the request. Warnings and errors go to stderr, the rest to
+ * stdout (or to the log file if one was given).
+ *
+ * Per-request chatter ("SERVER LOG" lines) goes through LOG_REQUEST, which
+ * is rate-limited per thread by a token bucket; suppressed lines are
+ * counted and reported once per second.
+ *
+ * Until start() is called (e.g. in the tools), lines are written
+ * synchronously, exactly like the std::cout they replace.
+ */
+class Logger {
+public:
+    enum Level { Debug = 0, Info, Warn, Error, Off };
+
+    /**
+     * @brief Starts the drain thread.
+     * @param minLevel Lines below this level are discarded at the call site.
+     * @param requestLinesPerSecond Per-thread budget for LOG_REQUEST lines; 0 = unlimited.
+     * @param logFile Empty for stdout/stderr.
+     */
+    static void start(Level minLevel, double requestLinesPerSecond, const std::string& logFile = "");
+
+    /**
+     * @brief Drains everything still buffered and stops the thread. Later
+     * lines are written synchronously again.
+     */
+    static void stop();
+
+    static bool enabled(Level level);
+
+    /**
+     * @brief Takes one token from this thread's request-log bucket.
+     * @return false if the line should be suppressed.
+     */
+    static bool sampleRequest();
+
+    static void write(Level level, const std::string& message);
+    static void write(Level level, const char* text, size_t length);
+
+    /**
+     * @brief "debug", "info", "warn", "error" or "off"; anything else is Info.
+     */
+    static Level parseLevel(const std::string& name);
+
+    // Lines dropped (ring full) and sampled out, across all threads.
+    static uint64_t droppedCount();
+    static uint64_t suppressedCount();
+
+    // Bytes held by the per-thread rings.
+    static size_t memoryUsage();
+
+    /**
+     * @brief This thread's line stream, emptied. It formats into a fixed
+     * per-thread buffer, so building a line never allocates; writeLine()
+     * hands that buffer to write().
+     */
+    static std::ostream& lineStream();
+    static void writeLine(Level level);
+
+    // Longest line kept, in bytes, both in the line buffer and in a ring
+    // record. Longer lines are cut and end in "...".
+    static constexpr size_t kLineBytes = 512;
+};
+
+// The message expression is only evaluated if the line will be kept.
+#define QUIZ_LOG(level, expr) \
+    do { \
+        if (Logger::enabled(level)) { \
+            std::ostream& logLine_ = Logger::lineStream(); \
+            logLine_ << expr; \
+            Logger::writeLine(level); \
+        } \
+    } while (0)
+
+#define LOG_DEBUG(expr) QUIZ_LOG(Logger::Debug, expr)
+#define LOG_INFO(expr) QUIZ_LOG(Logger::Info, expr)
+#define LOG_WARN(expr) QUIZ_LOG(Logger::Warn, expr)
+#define LOG_ERROR(expr) QUIZ_LOG(Logger::Error, expr)
+
+// Info-level line emitted on every request; sampled under load.
+#define LOG_REQUEST(expr) \
+    do { \
+        if (Logger::enabled(Logger::Info) && Logger::sampleRequest()) { \
+            std::ostream& logLine_ = Logger::lineStream(); \
+            logLine_ << expr; \
+            Logger::writeLine(Logger::Info); \
+        } \
+    } while (0)
+
+#endif // LOGGER_H
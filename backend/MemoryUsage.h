@@ -0,0 +1,88 @@
+#ifndef MEMORY_USAGE_H
+#define MEMORY_USAGE_H
+
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Helpers for the explicit memory accounting behind /memory_stats.
+ *
+ * Each returns the heap bytes a container owns beyond its own sizeof:
+ * capacity, not size, since reserved space is just as resident. Node-based
+ * containers are charged a per-node header (three pointers and a color
+ * word for std::map/std::set, one pointer plus a cached hash for
+ * unordered containers) on top of the value, which matches libstdc++ and
+ * MSVC to within a pointer or two. Allocator rounding is not modelled.
+ *
+ * Like Utils.h, everything here is 'inline' so it can be included from
+ * several .cpp files.
+ */
+
+// Heap bytes behind a string (0 while it fits the small-string buffer).
+inline size_t stringHeapBytes(const std::string& s) {
+    static const size_t inlineCapacity = std::string().capacity();
+    return s.capacity() > inlineCapacity ? s.capacity() + 1 : 0;
+}
+
+template <typename T>
+inline size_t vectorHeapBytes(const std::vector<T>& v) {
+    return v.capacity() * sizeof(T);
+}
+
+inline size_t vectorHeapBytes(const std::vector<bool>& v) {
+    return (v.capacity() + 63) / 64 * 8;
+}
+
+inline size_t stringVectorHeapBytes(const std::vector<std::string>& v) {
+    size_t bytes = vectorHeapBytes(v);
+    for (const std::string& s : v) {
+        bytes += stringHeapBytes(s);
+    }
+    return bytes;
+}
+
+const size_t kTreeNodeOverhead = 4 * sizeof(void*);
+const size_t kHashNodeOverhead = 2 * sizeof(void*);
+
+template <typename K, typename V>
+inline size_t mapHeapBytes(const std::map<K, V>& m) {
+    return m.size() * (sizeof(typename std::map<K, V>::value_type) + kTreeNodeOverhead);
+}
+
+// As mapHeapBytes, plus the heap behind each std::string key.
+template <typename V>
+inline size_t stringMapHeapBytes(const std::map<std::string, V>& m) {
+    size_t bytes = mapHeapBytes(m);
+    for (const auto& entry : m) {
+        bytes += stringHeapBytes(entry.first);
+    }
+    return bytes;
+}
+
+inline size_t stringSetHeapBytes(const std::set<std::string>& s) {
+    size_t bytes = s.size() * (sizeof(std::string) + kTreeNodeOverhead);
+    for (const std::string& value : s) {
+        bytes += stringHeapBytes(value);
+    }
+    return bytes;
+}
+
+template <typename K, typename V>
+inline size_t unorderedMapHeapBytes(const std::unordered_map<K, V>& m) {
+    return m.size() * (sizeof(typename std::unordered_map<K, V>::value_type) + kHashNodeOverhead) +
+           m.bucket_count() * sizeof(void*);
+}
+
+template <typename T>
+inline size_t dequeHeapBytes(const std::deque<T>& d) {
+    // libstdc++ allocates 512-byte blocks; count the blocks in use.
+    const size_t perBlock = sizeof(T) < 512 ? 512 / sizeof(T) : 1;
+    return (d.size() / perBlock + 1) * perBlock * sizeof(T);
+}
+
+#endif // MEMORY_USAGE_H
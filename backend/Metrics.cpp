@@ -0,0 +1,176 @@
+#include "Metrics.h"
+#include "QuestionBank.h"
+#include <cstdio>
+
+static_assert(QuestionBank::kFallbackLevelCount <= Metrics::kFallbackSlots,
+              "Metrics needs a slot for every getQuestion fallback level");
+
+namespace {
+    // Histogram bucket bounds exported as "le" labels, in seconds. Each
+    // internal bucket is counted under the first bound at or above its upper
+    // edge, so an exported bucket can be up to 12.5% pessimistic.
+    const double kExportBounds[] = {
+        0.00001, 0.000025, 0.00005, 0.0001, 0.00025, 0.0005,
+        0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5
+    };
+
+    const char* const kCounterNames[Metrics::kCounterCount] = {
+        "quiz_quizzes_started_total",
+        "quiz_questions_served_total",
+        "quiz_no_question_available_total",
+        nullptr, nullptr, nullptr // Answers share one labelled metric
+    };
+
+    const char* const kCounterHelp[Metrics::kCounterCount] = {
+        "Quizzes started with /start_quiz.",
+        "Questions served by /get_question.",
+        "Calls to /get_question that found no question.",
+        nullptr, nullptr, nullptr
+    };
+
+    std::string formatNumber(double value) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.9g", value);
+        return buf;
+    }
+
+    void appendHeader(std::string& out, const std::string& name, const std::string& help, const char* type) {
+        out += "# HELP " + name + " " + help + "\n";
+        out += "# TYPE " + name + " " + type + "\n";
+    }
+}
+
+Metrics::Shard::Shard() {
+    for (auto& counter : counters) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+    for (auto& fallback : fallbacks) {
+        fallback.store(0, std::memory_order_relaxed);
+    }
+}
+
+Metrics::Shard& Metrics::shardForThisThread() {
+    // One cached shard per thread; re-registers if a different Metrics
+    // object records from this thread (only happens in tools).
+    thread_local const Metrics* owner = nullptr;
+    thread_local Shard* shard = nullptr;
+    if (owner != this) {
+        auto fresh = std::make_shared<Shard>();
+        std::lock_guard<std::mutex> lock(shardsMutex);
+        shards.push_back(fresh);
+        owner = this;
+        shard = fresh.get();
+    }
+    return *shard;
+}
+
+void Metrics::increment(Counter counter) {
+    // Single writer per shard: a plain load and store, no locked instruction.
+    std::atomic<uint64_t>& c = shardForThisThread().counters[counter];
+    c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void Metrics::recordFallback(int level) {
+    if (level < 0 || level >= kFallbackSlots) return;
+    std::atomic<uint64_t>& c = shardForThisThread().fallbacks[level];
+    c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void Metrics::recordRequest(Route route, uint64_t nanos) {
+    shardForThisThread().routes[route].record(nanos);
+}
+
+uint64_t Metrics::total(Counter counter) const {
+    std::lock_guard<std::mutex> lock(shardsMutex);
+    uint64_t sum = 0;
+    for (const auto& shard : shards) {
+        sum += shard->counters[counter].load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+const char* Metrics::routePath(Route route) {
+    switch (route) {
+        case StartQuiz: return "/start_quiz";
+        case GetQuestion: return "/get_question";
+        case SubmitAnswer: return "/submit_answer";
+        case GetStats: return "/get_stats";
+        default: return "unknown";
+    }
+}
+
+void Metrics::appendGauge(std::string& out, const std::string& name, const std::string& help, double value) {
+    appendHeader(out, name, help, "gauge");
+    out += name + " " + formatNumber(value) + "\n";
+}
+
+std::string Metrics::renderText() const {
+    // Aggregate under the registration lock; the shards keep counting meanwhile.
+    LatencyHistogram::Snapshot routes[kRouteCount];
+    uint64_t counters[kCounterCount] = {};
+    uint64_t fallbacks[kFallbackSlots] = {};
+    {
+        std::lock_guard<std::mutex> lock(shardsMutex);
+        for (const auto& shard : shards) {
+            for (int r = 0; r < kRouteCount; ++r) {
+                routes[r].merge(shard->routes[r].snapshot());
+            }
+            for (int c = 0; c < kCounterCount; ++c) {
+                counters[c] += shard->counters[c].load(std::memory_order_relaxed);
+            }
+            for (int f = 0; f < kFallbackSlots; ++f) {
+                fallbacks[f] += shard->fallbacks[f].load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::string out;
+    appendHeader(out, "quiz_request_duration_seconds", "Time spent handling a request, by route.", "histogram");
+    for (int r = 0; r < kRouteCount; ++r) {
+        const LatencyHistogram::Snapshot& s = routes[r];
+        std::string label = std::string("route=\"") + routePath(static_cast<Route>(r)) + "\"";
+
+        uint64_t cumulative = 0;
+        int bucket = 0;
+        for (double bound : kExportBounds) {
+            uint64_t boundNanos = static_cast<uint64_t>(bound * 1e9);
+            while (bucket < LatencyHistogram::kBucketCount && LatencyHistogram::bucketUpperBound(bucket) <= boundNanos) {
+                cumulative += s.buckets[bucket++];
+            }
+            out += "quiz_request_duration_seconds_bucket{" + label + ",le=\"" + formatNumber(bound) + "\"} " +
+                   std::to_string(cumulative) + "\n";
+        }
+        // Summed from the buckets so +Inf always matches the finite buckets.
+        while (bucket < LatencyHistogram::kBucketCount) {
+            cumulative += s.buckets[bucket++];
+        }
+        out += "quiz_request_duration_seconds_bucket{" + label + ",le=\"+Inf\"} " + std::to_string(cumulative) + "\n";
+        out += "quiz_request_duration_seconds_sum{" + label + "} " + formatNumber(s.sum / 1e9) + "\n";
+        out += "quiz_request_duration_seconds_count{" + label + "} " + std::to_string(cumulative) + "\n";
+    }
+
+    appendHeader(out, "quiz_selection_fallback_total",
+                 "Questions served by selection (getQuestion or an item-level policy), by how far it fell back.", "counter");
+    for (int f = 0; f < QuestionBank::kFallbackLevelCount; ++f) {
+        out += std::string("quiz_selection_fallback_total{level=\"") +
+               QuestionBank::fallbackLevelName(static_cast<QuestionBank::FallbackLevel>(f)) + "\"} " +
+               std::to_string(fallbacks[f]) + "\n";
+    }
+
+    appendHeader(out, "quiz_answers_total", "Answers submitted, by grading outcome.", "counter");
+    out += "quiz_answers_total{outcome=\"correct\"} " + std::to_string(counters[AnswersCorrect]) + "\n";
+    out += "quiz_answers_total{outcome=\"incorrect\"} " + std::to_string(counters[AnswersIncorrect]) + "\n";
+    out += "quiz_answers_total{outcome=\"rejected\"} " + std::to_string(counters[AnswersRejected]) + "\n";
+
+    for (int c = 0; c < kCounterCount; ++c) {
+        if (kCounterNames[c] == nullptr) continue;
+        appendHeader(out, kCounterNames[c], kCounterHelp[c], "counter");
+        out += std::string(kCounterNames[c]) + " " + std::to_string(counters[c]) + "\n";
+    }
+    return out;
+}
+
+size_t Metrics::memoryUsage() const {
+    std::lock_guard<std::mutex> lock(shardsMutex);
+    return shards.size() * sizeof(Shard) + shards.capacity() * sizeof(std::shared_ptr<Shard>);
+}
@@ -0,0 +1,111 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "LatencyHistogram.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @class Metrics
+ * @brief Server counters and per-route latency histograms, exported in the
+ * Prometheus text exposition format by GET /metrics.
+ *
+ * Every thread that records gets its own cache-line-aligned shard (one
+ * LatencyHistogram per route plus the counters), registered the first time
+ * the thread records. Only the owning thread writes a shard, so counters
+ * are bumped with a relaxed load and store, and no cache line is shared
+ * between Crow workers. Shards are summed only when /metrics is scraped.
+ */
+class Metrics {
+public:
+    enum Route { StartQuiz = 0, GetQuestion, SubmitAnswer, GetStats, kRouteCount };
+
+    enum Counter {
+        QuizzesStarted = 0,
+        QuestionsServed,
+        NoQuestionAvailable,  // /get_question found nothing to serve
+        AnswersCorrect,
+        AnswersIncorrect,
+        AnswersRejected,      // No question asked yet, or no answer in the body
+        kCounterCount
+    };
+
+    // Room for QuestionBank::FallbackLevel values.
+    static const int kFallbackSlots = 8;
+
+private:
+    struct alignas(64) Shard {
+        LatencyHistogram routes[kRouteCount];
+        std::atomic<uint64_t> counters[kCounterCount];
+        std::atomic<uint64_t> fallbacks[kFallbackSlots];
+
+        Shard();
+    };
+
+    // Shards outlive their threads, so a scrape never reads freed memory.
+    mutable std::mutex shardsMutex;
+    std::vector<std::shared_ptr<Shard>> shards;
+
+    Shard& shardForThisThread();
+
+public:
+    Metrics() {}
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    void increment(Counter counter);
+
+    /**
+     * @brief Counts one QuestionBank::getQuestion result by how far it fell back.
+     */
+    void recordFallback(int level);
+
+    void recordRequest(Route route, uint64_t nanos);
+
+    /**
+     * @brief Sum of one counter over all shards (for tools and tests of the export).
+     */
+    uint64_t total(Counter counter) const;
+
+    /**
+     * @brief All metrics, aggregated across shards, in the text exposition format.
+     */
+    std::string renderText() const;
+
+    // Bytes held by the per-thread shards.
+    size_t memoryUsage() const;
+
+    /**
+     * @brief Appends one gauge (HELP, TYPE and sample) in the exposition
+     * format, for values owned by other subsystems.
+     */
+    static void appendGauge(std::string& out, const std::string& name, const std::string& help, double value);
+
+    static const char* routePath(Route route);
+
+    /**
+     * @class ScopedTimer
+     * @brief Records the time from construction to destruction against a route.
+     */
+    class ScopedTimer {
+        Metrics& metrics;
+        Route route;
+        std::chrono::steady_clock::time_point start;
+
+    public:
+        ScopedTimer(Metrics& m, Route r) : metrics(m), route(r), start(std::chrono::steady_clock::now()) {}
+        ~ScopedTimer() {
+            metrics.recordRequest(route, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count()));
+        }
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+    };
+};
+
+#endif // METRICS_H
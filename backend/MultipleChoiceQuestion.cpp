@@ -3,7 +3,7 @@
 #include <iostream>
 
 // Constructor - Uses initializer list to pass data to base Question class
-MultipleChoiceQuestion::MultipleChoiceQuestion(const std::string& text, const std::string& topic, int difficulty,
+MultipleChoiceQuestion::MultipleChoiceQuestion(const std::string& text, const std::string& topic, double difficulty,
                                                const std::vector<std::string>& options, const std::string& answer)
     : Question(text, topic, difficulty) {
     
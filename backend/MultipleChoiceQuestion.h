@@ -25,7 +25,7 @@ public:
      * @param opts A vector of strings containing the answer options.
      * @param correctAns The string representing the correct option (e.g., "A").
      */
-    MultipleChoiceQuestion(const std::string& text, const std::string& top, int diff,
+    MultipleChoiceQuestion(const std::string& text, const std::string& top, double diff,
                            const std::vector<std::string>& opts, const std::string& correctAns);
 
     /**
@@ -64,6 +64,9 @@ public:
     std::string getQuestionType() const override {
         return "MC";
     }
+
+    size_t objectBytes() const override { return sizeof(*this); }
+    size_t answerHeapBytes() const override { return stringVectorHeapBytes(options) + stringHeapBytes(correctAnswer); }
 };
 
 #endif // MULTIPLE_CHOICE_QUESTION_H
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include <iostream>
+#include "MemoryUsage.h"
 
 /**
  * @class Question
@@ -17,7 +18,8 @@ class Question {
 protected:
     std::string questionText;
     std::string topic;
-    int difficulty; // e.g., 1 (easy), 2 (medium), 3 (hard)
+    double difficulty; // e.g., 1 (easy), 2 (medium), 3 (hard); fractions allowed (2.5)
+    int id = -1;    // Position in the QuestionBank, assigned at load time
 
 public:
     /**
@@ -26,7 +28,7 @@ public:
      * @param top The topic (e.g., "Pointers", "OOP", "Data Structures").
      * @param diff The difficulty level.
      */
-    Question(const std::string& text, const std::string& top, int diff)
+    Question(const std::string& text, const std::string& top, double diff)
         : questionText(text), topic(top), difficulty(diff) {}
 
     /**
@@ -62,9 +64,14 @@ public:
     // --- Getters ---
 
     std::string getTopic() const { return topic; }
-    int getDifficulty() const { return difficulty; }
+    double getDifficulty() const { return difficulty; }
+    void setDifficulty(double diff) { difficulty = diff; } // Used by calibration overlays
     std::string getQuestionText() const { return questionText; }
-    
+
+    // Stable numeric id used when persisting state (checkpoints, logs).
+    int getId() const { return id; }
+    void setId(int newId) { id = newId; }
+
     // Virtual getter for options, needed by the server.
     // Returns an empty vector by default, overridden by MultipleChoiceQuestion.
     virtual std::vector<std::string> getOptions() const {
@@ -73,6 +80,17 @@ public:
 
     // Virtual getter for question type, needed by the server.
     virtual std::string getQuestionType() const = 0;
+
+    // --- Memory accounting (see MemoryUsage.h) ---
+
+    // sizeof the concrete question type.
+    virtual size_t objectBytes() const = 0;
+
+    // Heap behind the question text and topic name.
+    size_t textHeapBytes() const { return stringHeapBytes(questionText) + stringHeapBytes(topic); }
+
+    // Heap behind the options and the stored answer.
+    virtual size_t answerHeapBytes() const { return 0; }
 };
 
 #endif // QUESTION_H
\ No newline at end of file
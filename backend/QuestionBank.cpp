@@ -1,4 +1,8 @@
 #include "QuestionBank.h"
+#include "SpacedRepetition.h"
+#include "ExposureControl.h"
+#include "Metrics.h"
+#include "BucketInventory.h"
 #include "MultipleChoiceQuestion.h"
 #include "TrueFalseQuestion.h"
 #include "FillInTheBlankQuestion.h" 
@@ -11,6 +15,15 @@
 #include <algorithm> 
 #include <set>       // <-- NEWLY ADDED
 #include <iterator>  // <-- NEWLY ADDED for std::advance
+#include <cmath>
+#include <limits>
+
+namespace {
+    bool isUsedIn(const Question* q, const std::vector<bool>& usedMask) {
+        size_t id = static_cast<size_t>(q->getId());
+        return id < usedMask.size() && usedMask[id];
+    }
+}
 
 // Constructor
 QuestionBank::QuestionBank() {
@@ -25,51 +38,184 @@ QuestionBank::~QuestionBank() {
     allQuestions.clear();
 }
 
-Question* QuestionBank::getQuestion(const std::string& topic, int difficulty, const std::vector<Question*>& usedQuestions) {
-    
-    std::vector<Question*> candidates;
-    for (Question* q : allQuestions) {
-        bool criteriaMatch = (q->getTopic() == topic && q->getDifficulty() == difficulty);
-        bool isUsed = (std::find(usedQuestions.begin(), usedQuestions.end(), q) != usedQuestions.end());
+Question* QuestionBank::getDueReview(ReviewScheduler& reviews) const {
+    return getQuestionById(reviews.popDue(ReviewScheduler::nowMinutes()));
+}
 
-        if (criteriaMatch && !isUsed) {
-            candidates.push_back(q);
+Question* QuestionBank::getQuestion(const std::string& topic, double difficulty, const std::vector<bool>& usedMask,
+                                    ReviewScheduler* reviews) {
+    // Due reviews go ahead of new material.
+    if (reviews != nullptr) {
+        if (Question* due = getDueReview(*reviews)) {
+            return recordFallback(due, DueReview);
         }
     }
 
-    // Fallback 1: Same topic, any difficulty
-    if (candidates.empty()) {
-        for (Question* q : allQuestions) {
-            bool topicMatch = (q->getTopic() == topic);
-            bool isUsed = (std::find(usedQuestions.begin(), usedQuestions.end(), q) != usedQuestions.end());
-            
-            if (topicMatch && !isUsed) {
-                candidates.push_back(q);
-            }
+    int topicIdx = getTopicIndex(topic);
+    int bucket = (inventory != nullptr) ? inventory->bucketFor(topicIdx, difficulty) : -1;
+    if (topicIdx >= 0) {
+        const DifficultyIndex& index = difficultyIndex[topicIdx];
+        if (Question* q = findNearestUnused(index, difficulty, difficultyBand, usedMask)) {
+            return recordFallback(q, WithinBand, bucket);
+        }
+
+        // Fallback 1: Same topic, any difficulty (the closest one left). The
+        // band was searched above; proposing its items again would count
+        // them twice and give rejected ones a second exposure draw.
+        if (Question* q = findNearestUnused(index, difficulty, std::numeric_limits<double>::infinity(), usedMask,
+                                            difficultyBand)) {
+            return recordFallback(q, NearestInTopic, bucket);
         }
     }
-    
-    // Fallback 2: Any topic, any difficulty
-    if (candidates.empty()) {
-        for (Question* q : allQuestions) {
-            bool isUsed = (std::find(usedQuestions.begin(), usedQuestions.end(), q) != usedQuestions.end());
-            if (!isUsed) {
-                candidates.push_back(q);
-            }
+
+    // Fallback 2: Any topic, any difficulty. Unused questions are proposed
+    // in random order, each once; if exposure control rejects them all,
+    // the last one is served anyway rather than repeating a used question.
+    std::vector<Question*> candidates;
+    for (Question* q : allQuestions) {
+        if (!isUsedIn(q, usedMask)) {
+            candidates.push_back(q);
         }
     }
+    while (!candidates.empty()) {
+        size_t pick = static_cast<size_t>(rand()) % candidates.size();
+        Question* q = candidates[pick];
+        if (candidates.size() == 1 || exposure == nullptr || exposure->admit(q->getId())) {
+            return recordFallback(q, AnyTopic, bucket);
+        }
+        candidates[pick] = candidates.back();
+        candidates.pop_back();
+    }
 
     // Final Fallback: All questions used, just pick a random one
-    if (candidates.empty()) {
-        if (allQuestions.empty()) {
-             std::cerr << "Error: No questions loaded into question bank at all." << std::endl;
-             return nullptr;
+    if (allQuestions.empty()) {
+         std::cerr << "Error: No questions loaded into question bank at all." << std::endl;
+         return nullptr;
+    }
+    return recordFallback(allQuestions[rand() % allQuestions.size()], RandomRepeat, bucket);
+}
+
+Question* QuestionBank::recordFallback(Question* q, FallbackLevel level, int bucket) {
+    if (metrics != nullptr) {
+        metrics->recordFallback(level);
+    }
+    if (inventory != nullptr && bucket >= 0) {
+        inventory->recordSelection(bucket, level);
+    }
+    return q;
+}
+
+Question* QuestionBank::recordSelection(Question* q, FallbackLevel level) {
+    if (q == nullptr) {
+        return nullptr;
+    }
+    int bucket = (inventory != nullptr) ? inventory->bucketFor(getTopicIndex(q->getTopic()), q->getDifficulty()) : -1;
+    return recordFallback(q, level, bucket);
+}
+
+QuestionBank::MemoryBreakdown QuestionBank::memoryUsage() const {
+    MemoryBreakdown usage;
+    usage.objects = vectorHeapBytes(allQuestions);
+    for (const Question* q : allQuestions) {
+        usage.objects += q->objectBytes();
+        usage.text += q->textHeapBytes();
+        usage.answers += q->answerHeapBytes();
+    }
+
+    usage.indexes = stringSetHeapBytes(allTopics) + stringVectorHeapBytes(topicList) +
+                    mapHeapBytes(calibratedParams) + vectorHeapBytes(difficultyIndex);
+    for (const DifficultyIndex& index : difficultyIndex) {
+        usage.indexes += vectorHeapBytes(index.difficulties) + vectorHeapBytes(index.questions);
+    }
+    return usage;
+}
+
+const char* QuestionBank::fallbackLevelName(FallbackLevel level) {
+    switch (level) {
+        case DueReview: return "due_review";
+        case WithinBand: return "within_band";
+        case NearestInTopic: return "nearest_in_topic";
+        case AnyTopic: return "any_topic";
+        case RandomRepeat: return "random_repeat";
+        default: return "unknown";
+    }
+}
+
+Question* QuestionBank::findNearestUnused(const DifficultyIndex& index, double target, double maxDistance,
+                                          const std::vector<bool>& usedMask, double minDistance) const {
+    const std::vector<double>& d = index.difficulties;
+    // [lo, hi) is the part already searched; it starts empty at the target
+    // and grows one run of equal difficulties at a time, nearest side first.
+    size_t hi = std::lower_bound(d.begin(), d.end(), target) - d.begin();
+    size_t lo = hi;
+    while (lo > 0 || hi < d.size()) {
+        bool takeUp;
+        if (lo == 0) takeUp = true;
+        else if (hi == d.size()) takeUp = false;
+        else takeUp = (d[hi] - target) <= (target - d[lo - 1]);
+
+        double value = takeUp ? d[hi] : d[lo - 1];
+        if (std::fabs(value - target) > maxDistance) {
+            break; // The other side is even further away
+        }
+
+        size_t runBegin, runEnd;
+        if (takeUp) {
+            runBegin = hi;
+            runEnd = std::upper_bound(d.begin() + hi, d.end(), value) - d.begin();
+            hi = runEnd;
+        } else {
+            runEnd = lo;
+            runBegin = std::lower_bound(d.begin(), d.begin() + lo, value) - d.begin();
+            lo = runBegin;
+        }
+
+        if (std::fabs(value - target) <= minDistance) {
+            continue; // Already searched by the caller
+        }
+
+        // Every question in the run is an equally good match; start at a
+        // random one so sessions do not all see them in the same order.
+        size_t runLength = runEnd - runBegin;
+        size_t start = static_cast<size_t>(rand()) % runLength;
+        for (size_t k = 0; k < runLength; ++k) {
+            Question* q = index.questions[runBegin + (start + k) % runLength];
+            if (isAvailable(q->getId(), usedMask)) {
+                return q;
+            }
         }
-        candidates.push_back(allQuestions[rand() % allQuestions.size()]);
     }
+    return nullptr;
+}
 
-    int randomIndex = rand() % candidates.size();
-    return candidates[randomIndex];
+bool QuestionBank::isAvailable(int id, const std::vector<bool>& usedMask) const {
+    if (static_cast<size_t>(id) < usedMask.size() && usedMask[id]) {
+        return false;
+    }
+    return exposure == nullptr || exposure->admit(id);
+}
+
+void QuestionBank::buildDifficultyIndex() {
+    std::vector<std::vector<Question*>> byTopic(topicList.size());
+    for (Question* q : allQuestions) {
+        int topicIdx = getTopicIndex(q->getTopic());
+        if (topicIdx >= 0) byTopic[topicIdx].push_back(q);
+    }
+
+    difficultyIndex.assign(topicList.size(), DifficultyIndex());
+    for (size_t t = 0; t < byTopic.size(); ++t) {
+        std::vector<Question*>& questions = byTopic[t];
+        std::sort(questions.begin(), questions.end(), [](const Question* x, const Question* y) {
+            if (x->getDifficulty() != y->getDifficulty()) return x->getDifficulty() < y->getDifficulty();
+            return x->getId() < y->getId();
+        });
+        DifficultyIndex& index = difficultyIndex[t];
+        index.questions = questions;
+        index.difficulties.reserve(questions.size());
+        for (Question* q : questions) {
+            index.difficulties.push_back(q->getDifficulty());
+        }
+    }
 }
 
 // --- NEW FUNCTION IMPLEMENTATION ---
@@ -86,6 +232,36 @@ std::string QuestionBank::getRandomTopic() const {
 }
 // --- END OF NEW FUNCTION ---
 
+Question* QuestionBank::getQuestionById(int id) const {
+    if (id < 0 || id >= static_cast<int>(allQuestions.size())) {
+        return nullptr;
+    }
+    return allQuestions[id];
+}
+
+size_t QuestionBank::size() const {
+    return allQuestions.size();
+}
+
+const std::vector<std::string>& QuestionBank::getTopics() const {
+    return topicList;
+}
+
+int QuestionBank::getTopicIndex(const std::string& topic) const {
+    auto it = std::lower_bound(topicList.begin(), topicList.end(), topic);
+    if (it == topicList.end() || *it != topic) {
+        return -1;
+    }
+    return static_cast<int>(it - topicList.begin());
+}
+
+void QuestionBank::addQuestion(Question* q) {
+    // Ids are just the load order, so they stay stable as long as
+    // questions.txt is only appended to.
+    q->setId(static_cast<int>(allQuestions.size()));
+    allQuestions.push_back(q);
+}
+
 
 void QuestionBank::loadFromFile(const std::string& filename) {
     std::ifstream file(filename);
@@ -95,7 +271,7 @@ void QuestionBank::loadFromFile(const std::string& filename) {
     }
 
     std::string line, type, topic, text;
-    int difficulty;
+    double difficulty;
 
     while (std::getline(file, line)) {
         type = trim(line);
@@ -126,11 +302,76 @@ void QuestionBank::loadFromFile(const std::string& filename) {
         }
     }
 
+    topicList.assign(allTopics.begin(), allTopics.end()); // std::set is already sorted
+    buildDifficultyIndex();
+
+    textFingerprint = 1469598103934665603ULL;
+    for (const Question* q : allQuestions) {
+        textFingerprint = (textFingerprint ^ fnv1a64(q->getQuestionText())) * 1099511628211ULL;
+    }
+    topicFingerprint = 1469598103934665603ULL;
+    for (const std::string& topic : topicList) {
+        topicFingerprint = (topicFingerprint ^ fnv1a64(topic)) * 1099511628211ULL;
+    }
+
     std::cout << "Loaded " << allQuestions.size() << " questions from " << filename << std::endl;
     file.close();
 }
 
-void QuestionBank::parseMCQuestion(std::ifstream& file, const std::string& topic, int difficulty, const std::string& text) {
+int QuestionBank::applyOverlay(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return -1;
+    }
+
+    int applied = 0, stale = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#') continue;
+
+        std::stringstream ss(line);
+        std::string idStr, hashStr, diffStr, aStr, bStr;
+        if (!std::getline(ss, idStr, '|') || !std::getline(ss, hashStr, '|') || !std::getline(ss, diffStr, '|') ||
+            !std::getline(ss, aStr, '|') || !std::getline(ss, bStr, '|')) {
+            std::cerr << "Overlay: skipping malformed line: " << line << std::endl;
+            continue;
+        }
+
+        Question* q = getQuestionById(std::atoi(idStr.c_str()));
+        if (q == nullptr || std::strtoull(hashStr.c_str(), nullptr, 16) != fnv1a64(q->getQuestionText())) {
+            stale++;
+            continue;
+        }
+
+        q->setDifficulty(std::atof(diffStr.c_str()));
+        calibratedParams[q->getId()] = std::make_pair(std::atof(aStr.c_str()), std::atof(bStr.c_str()));
+        applied++;
+    }
+
+    if (applied > 0) {
+        buildDifficultyIndex();
+    }
+
+    std::cout << "Applied calibration overlay " << filename << " to " << applied << " questions";
+    if (stale > 0) {
+        std::cout << " (" << stale << " stale entries skipped)";
+    }
+    std::cout << std::endl;
+    return applied;
+}
+
+bool QuestionBank::getCalibratedParams(int id, double& a, double& b) const {
+    auto it = calibratedParams.find(id);
+    if (it == calibratedParams.end()) {
+        return false;
+    }
+    a = it->second.first;
+    b = it->second.second;
+    return true;
+}
+
+void QuestionBank::parseMCQuestion(std::ifstream& file, const std::string& topic, double difficulty, const std::string& text) {
     std::vector<std::string> options;
     std::string line;
     std::string answer;
@@ -143,10 +384,10 @@ void QuestionBank::parseMCQuestion(std::ifstream& file, const std::string& topic
     if (std::getline(file, answer)) {
         answer = trim(answer);
     }
-    allQuestions.push_back(new MultipleChoiceQuestion(text, topic, difficulty, options, answer));
+    addQuestion(new MultipleChoiceQuestion(text, topic, difficulty, options, answer));
 }
 
-void QuestionBank::parseTFQuestion(std::ifstream& file, const std::string& topic, int difficulty, const std::string& text) {
+void QuestionBank::parseTFQuestion(std::ifstream& file, const std::string& topic, double difficulty, const std::string& text) {
     std::string answerStr;
     bool answer = false;
 
@@ -156,13 +397,13 @@ void QuestionBank::parseTFQuestion(std::ifstream& file, const std::string& topic
             answer = true;
         }
     }
-    allQuestions.push_back(new TrueFalseQuestion(text, topic, difficulty, answer));
+    addQuestion(new TrueFalseQuestion(text, topic, difficulty, answer));
 }
 
-void QuestionBank::parseFIBQuestion(std::ifstream& file, const std::string& topic, int difficulty, const std::string& text) {
+void QuestionBank::parseFIBQuestion(std::ifstream& file, const std::string& topic, double difficulty, const std::string& text) {
     std::string answer;
     if (std::getline(file, answer)) {
         answer = trim(answer);
     }
-    allQuestions.push_back(new FillInTheBlankQuestion(text, topic, difficulty, answer));
+    addQuestion(new FillInTheBlankQuestion(text, topic, difficulty, answer));
 }
\ No newline at end of file
@@ -13,22 +13,154 @@
 #include <cstdlib>
 #include <ctime>
 #include <set> // <-- NEWLY ADDED
+#include <map>
+#include <cstdint>
+
+class ReviewScheduler;
+class ExposureControl;
+class Metrics;
+class BucketInventory;
 
 class QuestionBank {
 private:
     std::vector<Question*> allQuestions;
     std::set<std::string> allTopics; // <-- NEW: To store unique topic names
+    std::vector<std::string> topicList; // Same topics, sorted, for index lookups
+    uint64_t textFingerprint = 0;  // Hash of every question text in id order; set by loadFromFile
+    uint64_t topicFingerprint = 0; // Hash of topicList; set by loadFromFile
+
+    // Calibrated IRT parameters from an overlay file: question id -> (a, b)
+    std::map<int, std::pair<double, double>> calibratedParams;
+
+    // Per-topic difficulty index, by topic index: the topic's questions
+    // sorted by (difficulty, id), with the difficulties in their own array
+    // so the binary search touches nothing else.
+    struct DifficultyIndex {
+        std::vector<double> difficulties;
+        std::vector<Question*> questions;
+    };
+    std::vector<DifficultyIndex> difficultyIndex;
+    double difficultyBand = 0.5; // Max distance from the target difficulty before falling back
+    ExposureControl* exposure = nullptr; // Optional Sympson-Hetter filter on selections
+    Metrics* metrics = nullptr;          // Optional fallback-level counters
+    BucketInventory* inventory = nullptr; // Optional per-(topic, difficulty) fallback counts
+
+    // Rebuilt after loading and after an overlay changes difficulties.
+    void buildDifficultyIndex();
+
+    /**
+     * @brief The available question nearest to 'difficulty' and at most
+     * maxDistance from it, or nullptr. O(log n) per distinct difficulty
+     * visited; ties at the same difficulty are broken at random.
+     * @param minDistance Runs at most this far away are skipped without
+     *        being proposed (a wider pass after a band search); -1 = none.
+     */
+    Question* findNearestUnused(const DifficultyIndex& index, double difficulty, double maxDistance,
+                                const std::vector<bool>& usedMask, double minDistance = -1.0) const;
 
     // Private helper functions for parsing
-    void parseMCQuestion(std::ifstream& file, const std::string& topic, int difficulty, const std::string& text);
-    void parseTFQuestion(std::ifstream& file, const std::string& topic, int difficulty, const std::string& text);
-    void parseFIBQuestion(std::ifstream& file, const std::string& topic, int difficulty, const std::string& text); 
+    void parseMCQuestion(std::ifstream& file, const std::string& topic, double difficulty, const std::string& text);
+    void parseTFQuestion(std::ifstream& file, const std::string& topic, double difficulty, const std::string& text);
+    void parseFIBQuestion(std::ifstream& file, const std::string& topic, double difficulty, const std::string& text); 
+
+    // Takes ownership of q and assigns its id.
+    void addQuestion(Question* q);
+
+public:
+    /**
+     * @brief How getQuestion found the question it returned, best first.
+     */
+    enum FallbackLevel {
+        DueReview = 0,     // A spaced-repetition review was due
+        WithinBand,        // Unused, in the topic, within the difficulty band
+        NearestInTopic,    // Fallback 1: unused, in the topic, any difficulty
+        AnyTopic,          // Fallback 2: unused, any topic
+        RandomRepeat,      // Final fallback: every question used, random repeat
+        kFallbackLevelCount
+    };
+
+    static const char* fallbackLevelName(FallbackLevel level);
+
+private:
+    // Counts the result (globally, and against the targeted bucket if any) and returns q.
+    Question* recordFallback(Question* q, FallbackLevel level, int bucket = -1);
 
 public:
     QuestionBank();
     ~QuestionBank();
     void loadFromFile(const std::string& filename);
-    Question* getQuestion(const std::string& topic, int difficulty, const std::vector<Question*>& usedQuestions);
+
+    /**
+     * @brief Applies a calibration overlay written by tools/calibrate.cpp.
+     *
+     * Each "id|textHash|difficulty|a|b" line replaces that question's
+     * hand-set difficulty and records its calibrated IRT parameters. Lines
+     * whose text hash no longer matches the question (the bank was edited
+     * since calibration) are skipped.
+     * @return The number of questions updated, or -1 if the file could not be opened.
+     */
+    int applyOverlay(const std::string& filename);
+
+    /**
+     * @brief Calibrated IRT parameters for a question, if an overlay provided them.
+     * @return false if the question has no calibrated parameters.
+     */
+    bool getCalibratedParams(int id, double& a, double& b) const;
+    /**
+     * @brief Picks the unused question of the topic whose difficulty is
+     * nearest the requested one (within the difficulty band), relaxing the
+     * constraints step by step if none is left.
+     * @param usedMask usedMask[id] is true for questions already served.
+     * @param reviews If given and one of its spaced-repetition reviews is due,
+     *                that question is returned first, whatever its topic.
+     */
+    Question* getQuestion(const std::string& topic, double difficulty, const std::vector<bool>& usedMask,
+                          ReviewScheduler* reviews = nullptr);
+
+    /**
+     * @brief How far (in difficulty units) a question may be from the
+     * requested difficulty and still count as a match. Default 0.5, so an
+     * all-integer bank asked for an integer level behaves as exact matching.
+     */
+    void setDifficultyBand(double band) { difficultyBand = band; }
+
+    /**
+     * @brief Routes every selector's proposals through exposure control
+     * (nullptr turns it off). The object must outlive the bank's use.
+     */
+    void setExposureControl(ExposureControl* control) { exposure = control; }
+
+    /**
+     * @brief Counts every getQuestion result by fallback level (nullptr
+     * turns it off). The object must outlive the bank's use.
+     */
+    void setMetrics(Metrics* counters) { metrics = counters; }
+
+    /**
+     * @brief Counts every topic-targeted getQuestion result against its
+     * (topic, difficulty) bucket (nullptr turns it off).
+     */
+    void setBucketInventory(BucketInventory* buckets) { inventory = buckets; }
+
+    /**
+     * @brief Whether a selector may serve this question now: it is unused
+     * this session and, with exposure control on, passes the Sympson-Hetter
+     * draw. Call it only for the selector's current best candidate, since
+     * each call counts as a proposal.
+     */
+    bool isAvailable(int id, const std::vector<bool>& usedMask) const;
+
+    /**
+     * @brief The next due spaced-repetition review, or nullptr if none is due.
+     */
+    Question* getDueReview(ReviewScheduler& reviews) const;
+
+    /**
+     * @brief Counts a selection made without getQuestion, as getQuestion
+     * counts its own: item-level policies (IRT, Elo) pick items themselves.
+     * The bucket is the one holding q. Returns q; nullptr is not counted.
+     */
+    Question* recordSelection(Question* q, FallbackLevel level);
     
     // --- NEW FUNCTION ---
     /**
@@ -36,6 +168,54 @@ public:
      * @return A string with a random topic name.
      */
     std::string getRandomTopic() const;
+
+    /**
+     * @brief Looks up a question by the id assigned at load time.
+     * @return The question, or nullptr if the id is out of range.
+     */
+    Question* getQuestionById(int id) const;
+
+    /**
+     * @brief Number of loaded questions (ids are 0 .. size()-1).
+     */
+    size_t size() const;
+
+    /**
+     * @brief All topic names in sorted order. A topic's position in this
+     * list is its compact index (used by session tokens).
+     */
+    const std::vector<std::string>& getTopics() const;
+
+    /**
+     * @brief FNV-1a hash of all question texts in id order. Together with
+     * size() it identifies the bank layout that persisted ids refer to.
+     */
+    uint64_t getFingerprint() const { return textFingerprint; }
+
+    /**
+     * @brief FNV-1a hash of getTopics(). Persisted topic indexes are only
+     * valid while it is unchanged.
+     */
+    uint64_t getTopicFingerprint() const { return topicFingerprint; }
+
+    /**
+     * @brief Bytes held by the bank, by part (see MemoryUsage.h).
+     */
+    struct MemoryBreakdown {
+        size_t objects = 0;  // Question objects and the question list
+        size_t text = 0;     // Question text and topic strings
+        size_t answers = 0;  // Options and stored answers
+        size_t indexes = 0;  // Topic list/set, difficulty index, calibrated parameters
+
+        size_t total() const { return objects + text + answers + indexes; }
+    };
+
+    MemoryBreakdown memoryUsage() const;
+
+    /**
+     * @brief Index of a topic in getTopics(), or -1 if unknown. O(log topics).
+     */
+    int getTopicIndex(const std::string& topic) const;
 };
 
 #endif // QUESTIONBANK_H
\ No newline at end of file
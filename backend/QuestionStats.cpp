@@ -0,0 +1,54 @@
+#include "QuestionStats.h"
+
+void QuestionStats::resize(size_t questionCount) {
+    counters.reset(new AtomicCounts[questionCount]);
+    count = questionCount;
+}
+
+void QuestionStats::recordServed(int questionId) {
+    if (questionId < 0 || static_cast<size_t>(questionId) >= count) return;
+    counters[questionId].served.fetch_add(1, std::memory_order_relaxed);
+}
+
+void QuestionStats::recordAnswer(int questionId, bool correct) {
+    if (questionId < 0 || static_cast<size_t>(questionId) >= count) return;
+    counters[questionId].answered.fetch_add(1, std::memory_order_relaxed);
+    if (correct) {
+        counters[questionId].correct.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::vector<QuestionStats::Counts> QuestionStats::snapshot() const {
+    std::vector<Counts> result(count);
+    for (size_t i = 0; i < count; ++i) {
+        result[i].served = counters[i].served.load(std::memory_order_relaxed);
+        result[i].answered = counters[i].answered.load(std::memory_order_relaxed);
+        result[i].correct = counters[i].correct.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+void QuestionStats::serialize(ByteWriter& out) const {
+    out.putVarint(count);
+    for (const Counts& c : snapshot()) {
+        out.putVarint(c.served);
+        out.putVarint(c.answered);
+        out.putVarint(c.correct);
+    }
+}
+
+void QuestionStats::restore(ByteReader& in) {
+    uint64_t stored = in.getVarint();
+    for (uint64_t i = 0; i < stored; ++i) {
+        uint64_t served = in.getVarint();
+        uint64_t answered = in.getVarint();
+        uint64_t correct = in.getVarint();
+
+        // If the bank shrank since the checkpoint, drop the extra entries.
+        if (i < count) {
+            counters[i].served.store(served, std::memory_order_relaxed);
+            counters[i].answered.store(answered, std::memory_order_relaxed);
+            counters[i].correct.store(correct, std::memory_order_relaxed);
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef QUESTION_STATS_H
+#define QUESTION_STATS_H
+
+#include "BinaryIO.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @class QuestionStats
+ * @brief Global per-question counters (times served, answered, answered correctly).
+ *
+ * Shared by every session and every Crow worker thread, so the counters are
+ * plain atomics with relaxed ordering - no lock is ever taken on the request path.
+ */
+class QuestionStats {
+public:
+    // A plain (non-atomic) copy of one question's counters.
+    struct Counts {
+        uint64_t served = 0;
+        uint64_t answered = 0;
+        uint64_t correct = 0;
+    };
+
+private:
+    struct AtomicCounts {
+        std::atomic<uint64_t> served{0};
+        std::atomic<uint64_t> answered{0};
+        std::atomic<uint64_t> correct{0};
+    };
+
+    std::unique_ptr<AtomicCounts[]> counters;
+    size_t count = 0;
+
+public:
+    /**
+     * @brief Sizes the table for a bank of questionCount questions.
+     * Must be called once, after the bank is loaded and before serving requests.
+     */
+    void resize(size_t questionCount);
+
+    void recordServed(int questionId);
+    void recordAnswer(int questionId, bool correct);
+
+    size_t size() const { return count; }
+    size_t memoryUsage() const { return count * sizeof(AtomicCounts); }
+
+    /**
+     * @brief Copies all counters out. Each counter is read atomically; the set
+     * as a whole is not a single point-in-time view, which is fine for stats.
+     */
+    std::vector<Counts> snapshot() const;
+
+    // Binary (de)serialization used by checkpoints.
+    void serialize(ByteWriter& out) const;
+    void restore(ByteReader& in);
+};
+
+#endif // QUESTION_STATS_H
@@ -0,0 +1,188 @@
+#include "SelectionPolicy.h"
+#include "QuestionBank.h"
+#include "UserStats.h"
+#include "KnowledgeTracing.h"
+#include "ItemResponseTheory.h"
+#include "EloRating.h"
+#include "Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// --- SelectionPolicy ---
+
+Question* SelectionPolicy::select(UserStats& user, uint64_t* elapsedNanos) {
+    auto start = std::chrono::steady_clock::now();
+    Question* q = choose(user);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    uint64_t nanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    latency.record(nanos);
+    if (elapsedNanos != nullptr) {
+        *elapsedNanos = nanos;
+    }
+    if (q == nullptr) {
+        misses.fetch_add(1, std::memory_order_relaxed);
+    }
+    return q;
+}
+
+nlohmann::json SelectionPolicy::getStatsJson() const {
+    LatencyHistogram::Snapshot s = latency.snapshot();
+    nlohmann::json stats;
+    stats["policy"] = name;
+    stats["calls"] = s.count;
+    stats["misses"] = misses.load(std::memory_order_relaxed);
+    stats["meanMicros"] = s.mean() / 1000.0;
+    stats["p50Micros"] = s.percentile(0.50) / 1000.0;
+    stats["p99Micros"] = s.percentile(0.99) / 1000.0;
+    stats["maxMicros"] = s.max / 1000.0;
+    return stats;
+}
+
+// --- Topic policies ---
+
+Question* TopicPolicy::choose(UserStats& user) {
+    return chooseForTopic(user, chooseTopic(user));
+}
+
+Question* TopicPolicy::chooseForTopic(UserStats& user, const std::string& topic) {
+    return bank.getQuestion(topic, user.getNextDifficulty(), user.getUsedMask(), &user.getReviews());
+}
+
+namespace {
+    const char* weakestPolicyName(TopicScore score) {
+        switch (score) {
+            case TopicScore::Decayed: return "weakest-decayed";
+            case TopicScore::Recent: return "weakest-recent";
+            default: return "weakest";
+        }
+    }
+}
+
+WeakestTopicPolicy::WeakestTopicPolicy(QuestionBank& questionBank, TopicScore topicScore)
+    : TopicPolicy(weakestPolicyName(topicScore), questionBank), score(topicScore) {}
+
+std::string WeakestTopicPolicy::chooseTopic(UserStats& user) {
+    // Check if we have enough data (e.g., 3+ attempts in one topic) to be adaptive.
+    // If not, we stay in "Random Mode".
+    if (user.hasSufficientData(3)) {
+        std::string topic = user.getWeakestTopic(score);
+        LOG_REQUEST("SERVER LOG: [ADAPTIVE MODE] Targeting weakest topic: " << topic);
+        return topic;
+    }
+    std::string topic = bank.getRandomTopic();
+    LOG_REQUEST("SERVER LOG: [RANDOM MODE] Picking random topic: " << topic);
+    return topic;
+}
+
+std::string RandomTopicPolicy::chooseTopic(UserStats&) {
+    return bank.getRandomTopic();
+}
+
+std::string BKTPolicy::chooseTopic(UserStats& user) {
+    // BKT mastery starts at each topic's prior, so it can steer from the first question.
+    std::string topic = user.getLowestMasteryTopic(bank.getTopics(), model);
+    LOG_REQUEST("SERVER LOG: [BKT MODE] Targeting lowest-mastery topic: " << topic);
+    return topic;
+}
+
+std::string BanditPolicy::chooseTopic(UserStats& user) {
+    // Thompson sampling: no warm-up threshold, unexplored topics
+    // simply have wide posteriors and win some of the draws.
+    const std::vector<std::string>& topics = bank.getTopics();
+    int index = user.sampleBanditTopic(topics.size());
+    std::string topic = index >= 0 ? topics[index] : bank.getRandomTopic();
+    LOG_REQUEST("SERVER LOG: [BANDIT MODE] Sampled topic: " << topic);
+    return topic;
+}
+
+// --- Item policies ---
+
+Question* IRTPolicy::choose(UserStats& user) {
+    if (Question* due = bank.getDueReview(user.getReviews())) {
+        return bank.recordSelection(due, QuestionBank::DueReview);
+    }
+    // Computerized adaptive testing: ignore topics and serve the unseen
+    // item with the most Fisher information at the current ability estimate.
+    // Items past the ranked short list count as the any-topic fallback.
+    bool fromShortList = true;
+    Question* q = model.selectMaxInformation(user.getAbility().getTheta(), bank, user.getUsedMask(), &fromShortList);
+    LOG_REQUEST("SERVER LOG: [IRT MODE] Ability estimate " << user.getAbility().getTheta());
+    if (q != nullptr) {
+        return bank.recordSelection(q, fromShortList ? QuestionBank::WithinBand : QuestionBank::AnyTopic);
+    }
+    return fallback.select(user); // Counted by QuestionBank::getQuestion
+}
+
+EloPolicy::EloPolicy(QuestionBank& questionBank, const EloRatings& eloRatings, double target)
+    : SelectionPolicy("elo"), bank(questionBank), ratings(eloRatings),
+      targetSuccess(std::min(0.99, std::max(0.01, target))), fallback(questionBank) {}
+
+Question* EloPolicy::choose(UserStats& user) {
+    if (Question* due = bank.getDueReview(user.getReviews())) {
+        return bank.recordSelection(due, QuestionBank::DueReview);
+    }
+    // Aim for an item the learner answers correctly with the target
+    // probability: P = 1/(1+exp(d-skill))  =>  d = skill - logit(P).
+    double target = user.getRating() - std::log(targetSuccess / (1.0 - targetSuccess));
+    Question* q = ratings.selectNearest(target, bank, user.getUsedMask());
+    LOG_REQUEST("SERVER LOG: [ELO MODE] Rating " << user.getRating() << ", target item rating " << target);
+    if (q != nullptr) {
+        return bank.recordSelection(q, QuestionBank::WithinBand); // Nearest to the target rating
+    }
+    return fallback.select(user); // Counted by QuestionBank::getQuestion
+}
+
+// --- PolicyRegistry ---
+
+void PolicyRegistry::add(SelectionPolicy* policy) {
+    policies.emplace_back(policy);
+}
+
+SelectionPolicy* PolicyRegistry::find(const std::string& name) const {
+    for (const auto& policy : policies) {
+        if (policy->getName() == name) return policy.get();
+    }
+    return nullptr;
+}
+
+SelectionPolicy* PolicyRegistry::resolve(const std::string& sessionPolicy) const {
+    if (!sessionPolicy.empty()) {
+        if (SelectionPolicy* policy = find(sessionPolicy)) return policy;
+    }
+    return getDefault();
+}
+
+SelectionPolicy* PolicyRegistry::getDefault() const {
+    if (policies.empty()) return nullptr;
+    return policies[defaultIndex.load(std::memory_order_relaxed)].get();
+}
+
+bool PolicyRegistry::setDefault(const std::string& name) {
+    for (size_t i = 0; i < policies.size(); ++i) {
+        if (policies[i]->getName() == name) {
+            defaultIndex.store(i, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<std::string> PolicyRegistry::getNames() const {
+    std::vector<std::string> names;
+    for (const auto& policy : policies) {
+        names.push_back(policy->getName());
+    }
+    return names;
+}
+
+nlohmann::json PolicyRegistry::getStatsJson() const {
+    nlohmann::json stats;
+    SelectionPolicy* current = getDefault();
+    stats["default"] = current ? current->getName() : "";
+    stats["policies"] = nlohmann::json::array();
+    for (const auto& policy : policies) {
+        stats["policies"].push_back(policy->getStatsJson());
+    }
+    return stats;
+}
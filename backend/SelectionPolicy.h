@@ -0,0 +1,193 @@
+#ifndef SELECTION_POLICY_H
+#define SELECTION_POLICY_H
+
+#include "LatencyHistogram.h"
+#include "TopicTrend.h"
+#include "json.hpp"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class Question;
+class QuestionBank;
+class UserStats;
+class BKTModel;
+class IRTModel;
+class EloRatings;
+
+/**
+ * @class SelectionPolicy
+ * @brief Chooses the next question for a learner.
+ *
+ * Concrete policies implement choose(). Callers use select(), which times
+ * every call into the policy's own latency histogram so policies can be
+ * compared under real load. A policy is shared by every session and thread:
+ * choose() may only read shared models and modify the UserStats it is given
+ * (which the caller has locked).
+ */
+class SelectionPolicy {
+private:
+    std::string name;
+    LatencyHistogram latency;
+    std::atomic<uint64_t> misses{0}; // Calls that returned nullptr
+
+protected:
+    virtual Question* choose(UserStats& user) = 0;
+
+public:
+    explicit SelectionPolicy(const std::string& policyName) : name(policyName) {}
+    virtual ~SelectionPolicy() {}
+
+    const std::string& getName() const { return name; }
+
+    /**
+     * @brief Picks the next question and records how long that took.
+     * @param elapsedNanos If given, also receives the measured duration.
+     * @return nullptr if the bank has nothing to serve.
+     */
+    Question* select(UserStats& user, uint64_t* elapsedNanos = nullptr);
+
+    /**
+     * @brief Call count, latency percentiles (microseconds) and misses.
+     */
+    nlohmann::json getStatsJson() const;
+};
+
+/**
+ * @class TopicPolicy
+ * @brief Base for policies that pick a topic and let the bank pick a
+ * question of that topic at the learner's current difficulty level.
+ */
+class TopicPolicy : public SelectionPolicy {
+protected:
+    QuestionBank& bank;
+
+    virtual std::string chooseTopic(UserStats& user) = 0;
+    Question* choose(UserStats& user) override;
+
+public:
+    TopicPolicy(const std::string& policyName, QuestionBank& questionBank)
+        : SelectionPolicy(policyName), bank(questionBank) {}
+
+    // Lets item-level policies fall back to topic selection.
+    Question* chooseForTopic(UserStats& user, const std::string& topic);
+};
+
+/**
+ * @brief "weakest": random topics until one topic has 3 attempts, then the
+ * topic with the lowest raw score. The original behavior.
+ * "weakest-decayed" and "weakest-recent" rank topics by decayed or last-N
+ * accuracy instead, so an early bad run stops dominating once it is fixed.
+ */
+class WeakestTopicPolicy : public TopicPolicy {
+private:
+    TopicScore score;
+protected:
+    std::string chooseTopic(UserStats& user) override;
+public:
+    explicit WeakestTopicPolicy(QuestionBank& questionBank, TopicScore topicScore = TopicScore::Lifetime);
+};
+
+/**
+ * @brief "random": a uniformly random topic every time.
+ */
+class RandomTopicPolicy : public TopicPolicy {
+protected:
+    std::string chooseTopic(UserStats& user) override;
+public:
+    explicit RandomTopicPolicy(QuestionBank& questionBank) : TopicPolicy("random", questionBank) {}
+};
+
+/**
+ * @brief "bkt": the topic with the lowest Bayesian Knowledge Tracing mastery.
+ */
+class BKTPolicy : public TopicPolicy {
+private:
+    const BKTModel& model;
+protected:
+    std::string chooseTopic(UserStats& user) override;
+public:
+    BKTPolicy(QuestionBank& questionBank, const BKTModel& bktModel)
+        : TopicPolicy("bkt", questionBank), model(bktModel) {}
+};
+
+/**
+ * @brief "bandit": Thompson sampling over per-topic Beta posteriors.
+ */
+class BanditPolicy : public TopicPolicy {
+protected:
+    std::string chooseTopic(UserStats& user) override;
+public:
+    explicit BanditPolicy(QuestionBank& questionBank) : TopicPolicy("bandit", questionBank) {}
+};
+
+/**
+ * @brief "irt": the unseen item with maximum Fisher information at the
+ * learner's ability. Falls back to the weakest-topic policy once every item
+ * has been used.
+ */
+class IRTPolicy : public SelectionPolicy {
+private:
+    QuestionBank& bank;
+    const IRTModel& model;
+    WeakestTopicPolicy fallback;
+protected:
+    Question* choose(UserStats& user) override;
+public:
+    IRTPolicy(QuestionBank& questionBank, const IRTModel& irtModel)
+        : SelectionPolicy("irt"), bank(questionBank), model(irtModel), fallback(questionBank) {}
+};
+
+/**
+ * @brief "elo": the unseen item whose Elo rating gives the learner the
+ * target success probability. Same fallback as IRTPolicy.
+ */
+class EloPolicy : public SelectionPolicy {
+private:
+    QuestionBank& bank;
+    const EloRatings& ratings;
+    double targetSuccess;
+    WeakestTopicPolicy fallback;
+protected:
+    Question* choose(UserStats& user) override;
+public:
+    EloPolicy(QuestionBank& questionBank, const EloRatings& eloRatings, double target);
+};
+
+/**
+ * @class PolicyRegistry
+ * @brief Owns the available policies and the deployment-wide default.
+ *
+ * Policies are registered once at startup and never removed, so lookups
+ * need no lock. The default can be switched at runtime; sessions that
+ * picked a policy explicitly keep it.
+ */
+class PolicyRegistry {
+private:
+    std::vector<std::unique_ptr<SelectionPolicy>> policies;
+    std::atomic<size_t> defaultIndex{0};
+
+public:
+    // Registers a policy (taking ownership). Call before serving requests.
+    void add(SelectionPolicy* policy);
+
+    /**
+     * @return The policy with this name, or nullptr if there is none.
+     */
+    SelectionPolicy* find(const std::string& name) const;
+
+    /**
+     * @brief The session's policy if it names a registered one, otherwise the default.
+     */
+    SelectionPolicy* resolve(const std::string& sessionPolicy) const;
+
+    SelectionPolicy* getDefault() const;
+    bool setDefault(const std::string& name);
+
+    std::vector<std::string> getNames() const;
+    nlohmann::json getStatsJson() const;
+};
+
+#endif // SELECTION_POLICY_H
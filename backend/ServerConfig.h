@@ -0,0 +1,135 @@
+#ifndef SERVER_CONFIG_H
+#define SERVER_CONFIG_H
+
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+/**
+ * @struct ServerConfig
+ * @brief Deployment settings for the quiz server.
+ *
+ * Every field has a default that matches the original hard-coded behavior,
+ * so running the server with no arguments works exactly as before.
+ * Override any of them on the command line as --name=value.
+ */
+struct ServerConfig {
+    std::string questionFile = "questions.txt";
+    std::string overlayFile = "questions.overlay"; // Calibration overlay; skipped if missing
+    int port = 18080;
+
+    // --- Checkpointing ---
+    std::string checkpointPath = "quiz_state.ckpt"; // Files are <path>.0 and <path>.1
+    int checkpointIntervalSeconds = 30;             // 0 disables checkpointing
+    uint64_t checkpointBytesPerSecond = 4 * 1024 * 1024;
+
+    // --- Sessions ---
+    std::string sessionMode = "server"; // "server" (in-memory UserStats) or "stateless" (signed tokens)
+    std::string tokenSecret;            // Defaults to the QUIZ_TOKEN_SECRET environment variable
+    size_t tokenBudgetBytes = 2048;     // Max encoded token length
+    int tokenMaxAgeSeconds = 86400;     // Tokens older than this are refused; 0 = no limit
+    std::string adminSecret;            // X-Admin-Secret for operator routes; empty disables them. Defaults to $QUIZ_ADMIN_SECRET
+
+    // --- Session store (server mode) ---
+    std::string coldSessionDir = "sessions_cold"; // Hibernated sessions live here
+    int sessionIdleSeconds = 900;                 // Idle time before a session is hibernated
+    int sessionSweepSeconds = 60;                 // How often to look for idle sessions; 0 disables
+
+    // --- Adaptive selection ---
+    std::string selectionMode = "weakest";      // Default SelectionPolicy: weakest, weakest-decayed, weakest-recent, random, bkt, bandit, irt or elo
+    double difficultyStep = 1.0;                // Difficulty change per answer; below 1 adapts in fine steps
+    double difficultyBand = 0.5;                // Max distance from the target difficulty for a question to match
+    double eloTargetSuccess = 0.75;             // Success probability "elo" selection aims for
+    std::string bktParamsFile = "bkt_params.txt";
+    bool spacedRepetition = false;              // Schedule answered questions for SM-2 review
+    int recentWindow = 10;                      // Answers per topic behind "recent" accuracy (max 64)
+    double decayHalfLife = 8.0;                 // Answers after which one counts half in "decayed" accuracy
+
+    // --- Item exposure control (see ExposureControl) ---
+    double exposureCeiling = 1.0;               // Max share of quizzes an item may appear in; 1 = off
+    int exposureWarmupQuizzes = 20;             // Quizzes before exposure rates are trusted
+    int exposureRefreshMillis = 1000;           // How often the sharded counters are aggregated
+    double exposureWindowQuizzes = 20.0;        // Half-life (in quizzes) of the measured exposure rates
+
+    // --- CAT stopping rule (see StoppingRule) ---
+    std::string stopRule = "none";              // none, se, mastery or either
+    double stopStandardError = 0.3;             // Ability SE at which "se" ends the quiz
+    int stopMinQuestions = 5;                   // Never stop on a criterion before this many answers
+    int stopMaxQuestions = 0;                   // End every quiz after this many answers; 0 = no limit
+
+    // --- A/B experiment (see Experiment) ---
+    std::string experimentName = "experiment"; // Part of the assignment hash; rename to reshuffle
+    std::string experimentArms;                // e.g. "weakest:50,bandit:50"; empty = no experiment
+    std::string answerLogFile = "answers.log";  // Empty string disables the answer log
+
+    // --- Logging (see Logger) ---
+    std::string logLevel = "info";              // debug, info, warn, error or off
+    double logRequestRate = 50.0;               // Per-thread "SERVER LOG" lines per second; 0 = unlimited
+    std::string logFile;                        // Empty = stdout/stderr
+    std::string traceFile = "quiz_trace.json";  // Written by /trace_dump (builds with -DQUIZ_TRACING=1)
+
+    /**
+     * @brief Parses --name=value arguments. Unknown names are reported and ignored.
+     */
+    void parseArgs(int argc, char* argv[]) {
+        if (const char* envSecret = std::getenv("QUIZ_TOKEN_SECRET")) {
+            tokenSecret = envSecret;
+        }
+        if (const char* envAdminSecret = std::getenv("QUIZ_ADMIN_SECRET")) {
+            adminSecret = envAdminSecret;
+        }
+
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            size_t eq = arg.find('=');
+            if (arg.rfind("--", 0) != 0 || eq == std::string::npos) {
+                std::cerr << "Ignoring malformed argument: " << arg << std::endl;
+                continue;
+            }
+            std::string name = arg.substr(2, eq - 2);
+            std::string value = arg.substr(eq + 1);
+
+            if (name == "questions") questionFile = value;
+            else if (name == "overlay") overlayFile = value;
+            else if (name == "port") port = std::atoi(value.c_str());
+            else if (name == "checkpoint") checkpointPath = value;
+            else if (name == "checkpoint-interval") checkpointIntervalSeconds = std::atoi(value.c_str());
+            else if (name == "checkpoint-bandwidth") checkpointBytesPerSecond = std::strtoull(value.c_str(), nullptr, 10);
+            else if (name == "session-mode") sessionMode = value;
+            else if (name == "token-secret") tokenSecret = value;
+            else if (name == "token-budget") tokenBudgetBytes = std::strtoull(value.c_str(), nullptr, 10);
+            else if (name == "admin-secret") adminSecret = value;
+            else if (name == "token-max-age") tokenMaxAgeSeconds = std::atoi(value.c_str());
+            else if (name == "cold-dir") coldSessionDir = value;
+            else if (name == "session-idle") sessionIdleSeconds = std::atoi(value.c_str());
+            else if (name == "session-sweep") sessionSweepSeconds = std::atoi(value.c_str());
+            else if (name == "selection") selectionMode = value;
+            else if (name == "difficulty-step") difficultyStep = std::atof(value.c_str());
+            else if (name == "difficulty-band") difficultyBand = std::atof(value.c_str());
+            else if (name == "elo-target") eloTargetSuccess = std::atof(value.c_str());
+            else if (name == "bkt-params") bktParamsFile = value;
+            else if (name == "spaced-repetition") spacedRepetition = (value == "1" || value == "true" || value == "on");
+            else if (name == "recent-window") recentWindow = std::atoi(value.c_str());
+            else if (name == "decay-half-life") decayHalfLife = std::atof(value.c_str());
+            else if (name == "exposure-ceiling") exposureCeiling = std::atof(value.c_str());
+            else if (name == "exposure-warmup") exposureWarmupQuizzes = std::atoi(value.c_str());
+            else if (name == "exposure-refresh") exposureRefreshMillis = std::atoi(value.c_str());
+            else if (name == "exposure-window") exposureWindowQuizzes = std::atof(value.c_str());
+            else if (name == "stop-rule") stopRule = value;
+            else if (name == "stop-se") stopStandardError = std::atof(value.c_str());
+            else if (name == "min-questions") stopMinQuestions = std::atoi(value.c_str());
+            else if (name == "max-questions") stopMaxQuestions = std::atoi(value.c_str());
+            else if (name == "experiment") experimentName = value;
+            else if (name == "experiment-arms") experimentArms = value;
+            else if (name == "answer-log") answerLogFile = value;
+            else if (name == "log-level") logLevel = value;
+            else if (name == "log-request-rate") logRequestRate = std::atof(value.c_str());
+            else if (name == "log-file") logFile = value;
+            else if (name == "trace-file") traceFile = value;
+            else std::cerr << "Ignoring unknown option: --" << name << std::endl;
+        }
+    }
+};
+
+#endif // SERVER_CONFIG_H
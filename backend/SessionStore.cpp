@@ -0,0 +1,411 @@
+#include "SessionStore.h"
+#include "MemoryUsage.h"
+#include "QuestionBank.h"
+#include "BinaryIO.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <cstdio>
+
+namespace fs = std::filesystem;
+
+namespace {
+    const uint32_t kColdMagic = 0x53515141; // "AQQS" little-endian
+    // 2 added the saved-at stamp, 3 the bank identity. Older files cannot be
+    // matched to a bank, so they are treated as corrupt.
+    const uint8_t kColdVersion = 3;
+
+    // FNV-1a; only used to turn arbitrary client-supplied ids into safe file names.
+    uint64_t hashId(const std::string& id) {
+        uint64_t h = 1469598103934665603ULL;
+        for (unsigned char c : id) {
+            h ^= c;
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+}
+
+SessionStore::SessionStore(const QuestionBank& questionBank, const std::string& directory, std::chrono::seconds idleSeconds)
+    : bank(questionBank), coldDir(directory), idleThreshold(idleSeconds) {
+    std::error_code ec;
+    fs::create_directories(coldDir, ec);
+    if (ec) {
+        std::cerr << "SessionStore: could not create " << coldDir << ": " << ec.message() << std::endl;
+    }
+}
+
+SessionStore::~SessionStore() {
+    stopSweeper();
+}
+
+std::string SessionStore::coldPath(const std::string& id) const {
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(hashId(id)));
+    // 256 sub-folders keep directory sizes sane with millions of sessions.
+    return coldDir + "/" + std::string(name, 2) + "/" + name + ".sess";
+}
+
+uint64_t SessionStore::nextStamp() {
+    uint64_t now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    uint64_t last = lastStamp.load(std::memory_order_relaxed);
+    uint64_t stamp;
+    do {
+        stamp = std::max(now, last + 1);
+    } while (!lastStamp.compare_exchange_weak(last, stamp, std::memory_order_relaxed));
+    return stamp;
+}
+
+// File layout: [magic][crc32 of body][body],
+// body = [version][id][username][saved-at stamp][bank size][bank fingerprint][topic fingerprint][compact stats]
+// The compact stats refer to topics and questions by position, so a record
+// written against a different bank is rejected rather than misattributed.
+std::string SessionStore::encodeCold(const std::string& id, const UserStats& stats, uint64_t savedAt) const {
+    ByteWriter body;
+    body.putU8(kColdVersion);
+    body.putString(id);
+    body.putString(stats.getUsername());
+    body.putVarint(savedAt);
+    body.putVarint(bank.size());
+    body.putU64(bank.getFingerprint());
+    body.putU64(bank.getTopicFingerprint());
+    stats.serializeCompact(body, bank, true);
+
+    ByteWriter file;
+    file.putU32(kColdMagic);
+    file.putU32(crc32(body.data().data(), body.size()));
+    file.putBytes(body.data());
+    return file.release();
+}
+
+bool SessionStore::decodeCold(const std::string& id, const std::string& bytes, UserStats& stats,
+                              uint64_t& savedAt) const {
+    try {
+        ByteReader in(bytes);
+        if (in.getU32() != kColdMagic) return false;
+        uint32_t crc = in.getU32();
+        const char* body = bytes.data() + 8;
+        if (crc32(body, bytes.size() - 8) != crc) return false;
+
+        if (in.getU8() != kColdVersion) return false;
+        if (in.getString() != id) return false; // Hash collision with another id
+        UserStats restored(in.getString());
+        savedAt = in.getVarint();
+        if (in.getVarint() != bank.size() || in.getU64() != bank.getFingerprint() ||
+            in.getU64() != bank.getTopicFingerprint()) {
+            return false; // Written against another question bank
+        }
+        restored.restoreCompact(in, bank);
+        stats = restored;
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+bool SessionStore::readColdFile(const std::string& id, std::string& bytes) const {
+    std::ifstream file(coldPath(id), std::ios::binary);
+    if (!file.is_open()) return false;
+    bytes.assign((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return true;
+}
+
+bool SessionStore::writeColdFile(const std::string& id, const std::string& bytes) {
+    std::string path = coldPath(id);
+    std::string tmpPath = path + ".tmp";
+    std::error_code ec;
+    fs::create_directories(fs::path(path).parent_path(), ec);
+
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!file.write(bytes.data(), bytes.size())) {
+            return false;
+        }
+    }
+    // Rename so a reader never sees a half-written file.
+    std::lock_guard<std::mutex> lock(coldFileMutex);
+    fs::rename(tmpPath, path, ec);
+    return !ec;
+}
+
+void SessionStore::recordRehydration(std::chrono::steady_clock::duration took) {
+    uint64_t nanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(took).count());
+    rehydrateNanosTotal.fetch_add(nanos, std::memory_order_relaxed);
+    uint64_t seen = rehydrateNanosMax.load(std::memory_order_relaxed);
+    while (nanos > seen && !rehydrateNanosMax.compare_exchange_weak(seen, nanos, std::memory_order_relaxed)) {
+    }
+}
+
+std::shared_ptr<Session> SessionStore::acquire(const std::string& id) {
+    auto now = std::chrono::steady_clock::now();
+    std::shared_ptr<Session> session;
+    std::string pendingBytes;
+    bool fromPending = false;
+
+    {
+        std::lock_guard<std::mutex> lock(storeMutex);
+        auto it = hot.find(id);
+        if (it != hot.end()) {
+            it->second.lastAccess = now;
+            hotHits.fetch_add(1, std::memory_order_relaxed);
+            return it->second.session;
+        }
+
+        auto pendingIt = pendingCold.find(id);
+        if (pendingIt != pendingCold.end()) {
+            pendingBytes = pendingIt->second;
+            fromPending = true;
+        }
+
+        // Publish a placeholder with its mutex held; concurrent requests for
+        // this id will block on the session until it is filled in below.
+        session = std::make_shared<Session>(id);
+        session->mutex.lock();
+        hot[id] = Entry{session, now};
+    }
+
+    std::string bytes;
+    bool found = fromPending;
+    if (fromPending) {
+        bytes = std::move(pendingBytes);
+    } else {
+        found = readColdFile(id, bytes);
+    }
+
+    uint64_t savedAt = 0;
+    if (found && decodeCold(id, bytes, session->stats, savedAt)) {
+        coldHits.fetch_add(1, std::memory_order_relaxed);
+        recordRehydration(std::chrono::steady_clock::now() - now);
+        // The hot copy is now authoritative, but the file stays until a
+        // checkpoint holds the session: until then it is the only durable copy.
+        std::lock_guard<std::mutex> lock(storeMutex);
+        supersededCold[id] = savedAt;
+    } else {
+        if (found) {
+            std::cerr << "SessionStore: cold record for '" << id << "' is corrupt or from another question bank;"
+                      << " starting a new session." << std::endl;
+        }
+        misses.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    session->mutex.unlock();
+    return session;
+}
+
+size_t SessionStore::hibernateIdle() {
+    auto cutoff = std::chrono::steady_clock::now() - idleThreshold;
+    std::vector<std::pair<std::string, std::string>> toWrite;
+
+    {
+        std::lock_guard<std::mutex> lock(storeMutex);
+        for (auto it = hot.begin(); it != hot.end();) {
+            Entry& entry = it->second;
+            // use_count() == 1 means only the map holds it: no request is using it.
+            if (entry.lastAccess < cutoff && entry.session.use_count() == 1) {
+                // Encoding is in-memory and cheap; only the file write happens unlocked.
+                std::string bytes = encodeCold(it->first, entry.session->stats, nextStamp());
+                pendingCold[it->first] = bytes;
+                supersededCold.erase(it->first); // About to be overwritten with the current state
+                toWrite.emplace_back(it->first, std::move(bytes));
+                it = hot.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    for (auto& item : toWrite) {
+        bool written = writeColdFile(item.first, item.second);
+        if (!written) {
+            std::cerr << "SessionStore: failed to hibernate '" << item.first << "'; keeping it in memory." << std::endl;
+        }
+
+        bool rehydratedMeanwhile;
+        {
+            std::lock_guard<std::mutex> lock(storeMutex);
+            pendingCold.erase(item.first);
+            rehydratedMeanwhile = hot.find(item.first) != hot.end();
+            if (!written && !rehydratedMeanwhile) {
+                auto session = std::make_shared<Session>(item.first);
+                uint64_t savedAt;
+                decodeCold(item.first, item.second, session->stats, savedAt);
+                hot[item.first] = Entry{session, std::chrono::steady_clock::now()};
+            }
+        }
+        // If a request picked the session up from pendingCold while we were
+        // writing, acquire() has marked the new file superseded; it goes at
+        // the next checkpoint.
+    }
+
+    hibernated.fetch_add(toWrite.size(), std::memory_order_relaxed);
+    return toWrite.size();
+}
+
+std::vector<UserStats> SessionStore::snapshotHot(uint64_t& savedAt) {
+    std::vector<std::shared_ptr<Session>> sessions;
+    {
+        // One stamp covers the whole snapshot: sessions hibernated before it
+        // are not in it (or were rehydrated, so the copy here is newer), and
+        // the ones in it cannot hibernate until they have been copied.
+        std::lock_guard<std::mutex> lock(storeMutex);
+        savedAt = nextStamp();
+        snapshotSuperseded.assign(supersededCold.begin(), supersededCold.end());
+        sessions.reserve(hot.size());
+        for (auto& pair : hot) {
+            sessions.push_back(pair.second.session);
+        }
+    }
+
+    std::vector<UserStats> copies;
+    copies.reserve(sessions.size());
+    for (auto& session : sessions) {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        copies.push_back(session->stats);
+    }
+    return copies;
+}
+
+void SessionStore::forEachHot(const std::function<void(const UserStats&)>& visit) {
+    std::vector<std::shared_ptr<Session>> sessions;
+    {
+        std::lock_guard<std::mutex> lock(storeMutex);
+        sessions.reserve(hot.size());
+        for (auto& pair : hot) {
+            sessions.push_back(pair.second.session);
+        }
+    }
+
+    for (auto& session : sessions) {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        visit(session->stats);
+    }
+}
+
+SessionStore::MemoryBreakdown SessionStore::memoryUsage() {
+    MemoryBreakdown usage;
+    std::vector<std::shared_ptr<Session>> sessions;
+    {
+        std::lock_guard<std::mutex> lock(storeMutex);
+        usage.store = unorderedMapHeapBytes(hot) + unorderedMapHeapBytes(pendingCold) +
+                      unorderedMapHeapBytes(supersededCold);
+        sessions.reserve(hot.size());
+        for (auto& pair : hot) {
+            usage.store += stringHeapBytes(pair.first);
+            sessions.push_back(pair.second.session);
+        }
+        for (auto& pair : pendingCold) {
+            usage.store += stringHeapBytes(pair.first) + stringHeapBytes(pair.second);
+        }
+        for (auto& pair : supersededCold) {
+            usage.store += stringHeapBytes(pair.first);
+        }
+    }
+
+    usage.hotSessions = sessions.size();
+    // The Session wrapper (mutex) and the shared_ptr control block are store overhead.
+    usage.store += sessions.size() * (sizeof(Session) - sizeof(UserStats) + 2 * sizeof(void*));
+    for (auto& session : sessions) {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        usage.sessions += session->stats.memoryUsage();
+    }
+    return usage;
+}
+
+void SessionStore::checkpointCommitted() {
+    std::lock_guard<std::mutex> fileLock(coldFileMutex);
+    std::vector<std::string> paths;
+    {
+        std::lock_guard<std::mutex> lock(storeMutex);
+        for (auto& item : snapshotSuperseded) {
+            // Skip sessions hibernated (or re-hibernated) since the snapshot:
+            // their file is newer than the checkpoint.
+            auto it = supersededCold.find(item.first);
+            if (it != supersededCold.end() && it->second == item.second) {
+                supersededCold.erase(it);
+                paths.push_back(coldPath(item.first));
+            }
+        }
+        snapshotSuperseded.clear();
+    }
+    // coldFileMutex keeps hibernation from renaming a new file into place meanwhile.
+    for (auto& path : paths) {
+        std::error_code ec;
+        fs::remove(path, ec);
+    }
+}
+
+bool SessionStore::restore(const std::string& id, const UserStats& stats, uint64_t savedAt) {
+    std::string bytes;
+    UserStats cold(id);
+    uint64_t coldSavedAt = 0;
+    bool hasCold = readColdFile(id, bytes) && decodeCold(id, bytes, cold, coldSavedAt);
+    if (hasCold && coldSavedAt > savedAt) {
+        return false; // Hibernated after the checkpoint; acquire() will load it
+    }
+    if (hasCold) {
+        // Older than the (already committed) checkpoint, so safe to drop.
+        std::error_code ec;
+        fs::remove(coldPath(id), ec);
+    }
+
+    auto session = std::make_shared<Session>(id);
+    session->stats = stats;
+    std::lock_guard<std::mutex> lock(storeMutex);
+    hot[id] = Entry{session, std::chrono::steady_clock::now()};
+    return true;
+}
+
+size_t SessionStore::hotCount() {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    return hot.size();
+}
+
+nlohmann::json SessionStore::getStatsJson() {
+    uint64_t hits = hotHits.load(std::memory_order_relaxed);
+    uint64_t rehydrated = coldHits.load(std::memory_order_relaxed);
+    uint64_t created = misses.load(std::memory_order_relaxed);
+    uint64_t lookups = hits + rehydrated + created;
+
+    nlohmann::json stats;
+    stats["hotSessions"] = hotCount();
+    stats["hotHits"] = hits;
+    stats["coldHits"] = rehydrated;
+    stats["misses"] = created;
+    stats["hibernated"] = hibernated.load(std::memory_order_relaxed);
+    stats["hotHitRate"] = lookups ? static_cast<double>(hits) / lookups : 0.0;
+    stats["coldHitRate"] = lookups ? static_cast<double>(rehydrated) / lookups : 0.0;
+    stats["rehydrateAvgMicros"] = rehydrated ? rehydrateNanosTotal.load(std::memory_order_relaxed) / 1000.0 / rehydrated : 0.0;
+    stats["rehydrateMaxMicros"] = rehydrateNanosMax.load(std::memory_order_relaxed) / 1000.0;
+    return stats;
+}
+
+void SessionStore::startSweeper(std::chrono::seconds interval) {
+    stopSweeper();
+    stopRequested = false;
+
+    sweeper = std::thread([this, interval]() {
+        std::unique_lock<std::mutex> lock(sweeperMutex);
+        while (!sweeperWake.wait_for(lock, interval, [this]() { return stopRequested; })) {
+            lock.unlock();
+            size_t count = hibernateIdle();
+            if (count > 0) {
+                std::cout << "SessionStore: hibernated " << count << " idle session(s)." << std::endl;
+            }
+            lock.lock();
+        }
+    });
+}
+
+void SessionStore::stopSweeper() {
+    {
+        std::lock_guard<std::mutex> lock(sweeperMutex);
+        stopRequested = true;
+    }
+    sweeperWake.notify_all();
+    if (sweeper.joinable()) {
+        sweeper.join();
+    }
+}
@@ -0,0 +1,175 @@
+#ifndef SESSION_STORE_H
+#define SESSION_STORE_H
+
+#include "UserStats.h"
+#include "json.hpp"
+#include <string>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <unordered_map>
+#include <utility>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <functional>
+
+// Forward declaration
+class QuestionBank;
+
+/**
+ * @struct Session
+ * @brief One learner's server-side state. Handlers must hold 'mutex'
+ * while reading or changing 'stats'.
+ */
+struct Session {
+    std::mutex mutex;
+    UserStats stats;
+
+    explicit Session(const std::string& id) : stats(id) {}
+};
+
+/**
+ * @class SessionStore
+ * @brief Two-tier session storage: a hot in-memory map plus a cold tier on disk.
+ *
+ * Sessions idle for longer than a threshold are serialized compactly
+ * (UserStats::serializeCompact - varint counters and a run-length compressed
+ * used-question bitmap) to one small file each, and dropped from RAM. The
+ * next request for that session rehydrates it transparently.
+ *
+ * Durability: every cold file and every checkpoint carries a "saved at"
+ * stamp. A rehydrated session's cold file is kept until a checkpoint that
+ * contains the session has been committed, and a checkpoint restore defers
+ * to a cold file saved after it, so a crash never loses a session that
+ * moved between the tiers since the last checkpoint.
+ *
+ * Locking: storeMutex only guards the map and is never held across disk I/O.
+ * A session being rehydrated is inserted first with its own mutex locked, so
+ * concurrent requests for it simply wait on that session, not on the store.
+ */
+class SessionStore {
+private:
+    struct Entry {
+        std::shared_ptr<Session> session;
+        std::chrono::steady_clock::time_point lastAccess;
+    };
+
+    const QuestionBank& bank;
+    std::string coldDir;
+    std::chrono::seconds idleThreshold;
+
+    std::mutex storeMutex;
+    std::unordered_map<std::string, Entry> hot;
+    // Hibernated sessions whose file is still being written; checked before disk.
+    std::unordered_map<std::string, std::string> pendingCold;
+    // Hot sessions whose cold file (saved at the given stamp) is superseded but
+    // must stay on disk until a checkpoint containing the session is committed.
+    std::unordered_map<std::string, uint64_t> supersededCold;
+    // supersededCold entries captured by the last snapshotHot().
+    std::vector<std::pair<std::string, uint64_t>> snapshotSuperseded;
+    // Held while a cold file is renamed into place or removed, so a
+    // checkpoint's cleanup cannot delete a file hibernation just wrote.
+    std::mutex coldFileMutex;
+    std::atomic<uint64_t> lastStamp{0};
+
+    // --- Metrics ---
+    std::atomic<uint64_t> hotHits{0};
+    std::atomic<uint64_t> coldHits{0};       // Rehydrated from the cold tier
+    std::atomic<uint64_t> misses{0};         // Brand new sessions
+    std::atomic<uint64_t> hibernated{0};
+    std::atomic<uint64_t> rehydrateNanosTotal{0};
+    std::atomic<uint64_t> rehydrateNanosMax{0};
+
+    // --- Background sweeper ---
+    std::thread sweeper;
+    std::mutex sweeperMutex;
+    std::condition_variable sweeperWake;
+    bool stopRequested = false;
+
+    std::string coldPath(const std::string& id) const;
+    std::string encodeCold(const std::string& id, const UserStats& stats, uint64_t savedAt) const;
+    bool decodeCold(const std::string& id, const std::string& bytes, UserStats& stats, uint64_t& savedAt) const;
+    bool readColdFile(const std::string& id, std::string& bytes) const;
+    bool writeColdFile(const std::string& id, const std::string& bytes);
+    void recordRehydration(std::chrono::steady_clock::duration took);
+
+public:
+    /**
+     * @param questionBank Used to resolve question ids and topic indexes.
+     * @param directory Root folder for the cold tier (created if missing).
+     * @param idleSeconds Sessions untouched this long are hibernated.
+     */
+    SessionStore(const QuestionBank& questionBank, const std::string& directory, std::chrono::seconds idleSeconds);
+    ~SessionStore();
+
+    /**
+     * @brief Returns the session for id, rehydrating it from disk or creating
+     * it if needed. Lock the session's mutex before touching its stats.
+     */
+    std::shared_ptr<Session> acquire(const std::string& id);
+
+    /**
+     * @brief Moves every session idle for longer than the threshold (and not
+     * currently in use by a request) to the cold tier.
+     * @return The number of sessions hibernated.
+     */
+    size_t hibernateIdle();
+
+    /**
+     * @brief Microseconds since the epoch, strictly increasing within the
+     * process. Orders cold files against checkpoints.
+     */
+    uint64_t nextStamp();
+
+    /**
+     * @brief Copies every hot session, locking each one only for its own copy.
+     * Used by checkpoints; cold sessions are already on disk.
+     * @param savedAt Receives the snapshot's stamp, to store with the checkpoint.
+     */
+    std::vector<UserStats> snapshotHot(uint64_t& savedAt);
+
+    /**
+     * @brief Call once the checkpoint built from the last snapshotHot() is on
+     * disk: removes the cold files that checkpoint supersedes.
+     */
+    void checkpointCommitted();
+
+    /**
+     * @brief Checkpoint restore: puts a session into the hot tier unless its
+     * cold file was saved after the checkpoint, in which case the session
+     * stays cold and the next request rehydrates the newer copy.
+     * @param savedAt The checkpoint's stamp.
+     * @return true if the checkpointed copy was used.
+     */
+    bool restore(const std::string& id, const UserStats& stats, uint64_t savedAt);
+
+    size_t hotCount();
+
+    /**
+     * @brief Calls visit on every hot session, holding only that session's
+     * lock for the call. Cold sessions are not loaded.
+     */
+    void forEachHot(const std::function<void(const UserStats&)>& visit);
+
+    /**
+     * @brief Bytes held in RAM: the hot sessions themselves, and the store's
+     * own structures (map, ids, Session wrappers, cold writes in flight).
+     */
+    struct MemoryBreakdown {
+        size_t hotSessions = 0;
+        size_t sessions = 0;
+        size_t store = 0;
+    };
+
+    MemoryBreakdown memoryUsage();
+
+    // Hit/miss rates and rehydration latency, for the /session_store_stats endpoint.
+    nlohmann::json getStatsJson();
+
+    void startSweeper(std::chrono::seconds interval);
+    void stopSweeper();
+};
+
+#endif // SESSION_STORE_H
@@ -0,0 +1,142 @@
+#include "SessionToken.h"
+#include "HmacSha256.h"
+#include "UserStats.h"
+#include "QuestionBank.h"
+#include "BinaryIO.h"
+#include <chrono>
+
+namespace {
+    // 2 added the session key, 3 the issue time and bank fingerprint. Older
+    // tokens cannot be matched to a bank, so they are refused.
+    const uint8_t kTokenVersion = 3;
+    const uint64_t kClockSkewSeconds = 300; // Tolerated issue times in the future (other processes' clocks)
+    const size_t kMacBytes = 16; // Truncated HMAC-SHA256 (128 bits is plenty for this use)
+
+    const char kBase64Url[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+    std::string base64UrlEncode(const std::string& bytes) {
+        std::string out;
+        out.reserve((bytes.size() * 4 + 2) / 3);
+        size_t i = 0;
+        for (; i + 2 < bytes.size(); i += 3) {
+            uint32_t v = (uint32_t(uint8_t(bytes[i])) << 16) | (uint32_t(uint8_t(bytes[i + 1])) << 8) | uint8_t(bytes[i + 2]);
+            out.push_back(kBase64Url[(v >> 18) & 63]);
+            out.push_back(kBase64Url[(v >> 12) & 63]);
+            out.push_back(kBase64Url[(v >> 6) & 63]);
+            out.push_back(kBase64Url[v & 63]);
+        }
+        size_t rest = bytes.size() - i;
+        if (rest > 0) {
+            uint32_t v = uint32_t(uint8_t(bytes[i])) << 16;
+            if (rest == 2) v |= uint32_t(uint8_t(bytes[i + 1])) << 8;
+            out.push_back(kBase64Url[(v >> 18) & 63]);
+            out.push_back(kBase64Url[(v >> 12) & 63]);
+            if (rest == 2) out.push_back(kBase64Url[(v >> 6) & 63]);
+        }
+        return out; // No '=' padding; the length tells us how many bytes remain.
+    }
+
+    bool base64UrlDecode(const std::string& text, std::string& bytes) {
+        bytes.clear();
+        uint32_t buffer = 0;
+        int bits = 0;
+        for (char c : text) {
+            int v;
+            if (c >= 'A' && c <= 'Z') v = c - 'A';
+            else if (c >= 'a' && c <= 'z') v = c - 'a' + 26;
+            else if (c >= '0' && c <= '9') v = c - '0' + 52;
+            else if (c == '-') v = 62;
+            else if (c == '_') v = 63;
+            else return false;
+
+            buffer = (buffer << 6) | static_cast<uint32_t>(v);
+            bits += 6;
+            if (bits >= 8) {
+                bits -= 8;
+                bytes.push_back(static_cast<char>((buffer >> bits) & 0xFF));
+            }
+        }
+        return text.size() % 4 != 1; // A single leftover character can never be valid
+    }
+
+    uint64_t unixSeconds() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+}
+
+SessionTokenCodec::SessionTokenCodec(const std::string& secretKey, size_t budgetBytes, int maxAge)
+    : secret(secretKey), maxTokenBytes(budgetBytes), maxAgeSeconds(maxAge) {
+}
+
+std::string SessionTokenCodec::sign(const std::string& payload) const {
+    return hmacSha256(secret, payload).substr(0, kMacBytes);
+}
+
+std::string SessionTokenCodec::encode(const UserStats& stats, const QuestionBank& bank, bool* truncated) const {
+    if (truncated) *truncated = false;
+
+    uint64_t issuedAt = unixSeconds();
+    std::string token;
+    for (bool includeUsed : {true, false}) {
+        ByteWriter payload;
+        payload.putU8(kTokenVersion);
+        payload.putVarint(issuedAt);
+        payload.putVarint(bank.size());
+        payload.putU64(bank.getFingerprint());
+        payload.putU64(stats.getSessionKey());
+        stats.serializeCompact(payload, bank, includeUsed);
+
+        token = base64UrlEncode(payload.data()) + "." + base64UrlEncode(sign(payload.data()));
+        if (token.size() <= maxTokenBytes) {
+            return token;
+        }
+        if (truncated) *truncated = true;
+    }
+
+    // Even the minimal state is over budget; send it anyway rather than
+    // lose the learner's progress. The caller can see 'truncated'.
+    return token;
+}
+
+bool SessionTokenCodec::decode(const std::string& token, UserStats& stats, const QuestionBank& bank) const {
+    if (token.size() > 2 * maxTokenBytes) {
+        return false; // Refuse to spend time on absurdly large inputs
+    }
+
+    size_t dot = token.find('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+
+    std::string payload, mac;
+    if (!base64UrlDecode(token.substr(0, dot), payload) || !base64UrlDecode(token.substr(dot + 1), mac)) {
+        return false;
+    }
+    if (!constantTimeEquals(mac, sign(payload))) {
+        return false;
+    }
+
+    try {
+        ByteReader in(payload);
+        if (in.getU8() != kTokenVersion) {
+            return false;
+        }
+        uint64_t issuedAt = in.getVarint();
+        uint64_t now = unixSeconds();
+        if (issuedAt > now + kClockSkewSeconds ||
+            (maxAgeSeconds > 0 && issuedAt + static_cast<uint64_t>(maxAgeSeconds) < now)) {
+            return false;
+        }
+        if (in.getVarint() != bank.size() || in.getU64() != bank.getFingerprint()) {
+            return false;
+        }
+        UserStats decoded(stats);
+        decoded.setSessionKey(in.getU64());
+        decoded.restoreCompact(in, bank);
+        stats = decoded;
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
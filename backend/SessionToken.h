@@ -0,0 +1,65 @@
+#ifndef SESSION_TOKEN_H
+#define SESSION_TOKEN_H
+
+#include <string>
+#include <cstddef>
+
+// Forward declarations
+class UserStats;
+class QuestionBank;
+
+/**
+ * @class SessionTokenCodec
+ * @brief Encodes a session's adaptive state into an HMAC-signed token.
+ *
+ * In stateless mode the client sends the token back with every request, so
+ * any server process holding the same secret (and the same question bank)
+ * can serve any request without shared session memory.
+ *
+ * Token layout: base64url(payload) "." base64url(HMAC-SHA256(secret, payload)[0..16))
+ * where payload = [version][issued at (varint, Unix seconds)][bank size (varint)]
+ * [bank fingerprint (u64)][session key (u64)][UserStats::serializeCompact()].
+ * The bank size and fingerprint (QuestionBank::getFingerprint) pin the
+ * question ids in the token to the bank that issued it. The session key is a
+ * random id the server assigns on the first request; it tells apart learners
+ * who all carry the default username.
+ */
+class SessionTokenCodec {
+private:
+    std::string secret;
+    size_t maxTokenBytes;
+    int maxAgeSeconds;
+
+    std::string sign(const std::string& payload) const;
+
+public:
+    /**
+     * @param secretKey Shared HMAC key; all processes in a deployment must use the same one.
+     * @param budgetBytes Upper bound on the encoded token length.
+     * @param maxAge Seconds after issue at which a token is refused; 0 = never.
+     *        Every response carries a fresh token, so this bounds idle time.
+     */
+    SessionTokenCodec(const std::string& secretKey, size_t budgetBytes, int maxAge = 0);
+
+    /**
+     * @brief Encodes and signs the state of stats.
+     *
+     * If the full state does not fit in the size budget, the used-question
+     * set is dropped (the learner may then see repeats) and truncated is set.
+     * @param truncated Optional; set to true if state had to be dropped.
+     */
+    std::string encode(const UserStats& stats, const QuestionBank& bank, bool* truncated = nullptr) const;
+
+    /**
+     * @brief Verifies the signature and restores the state into stats.
+     * @return false if the token is malformed, tampered with, expired, from a
+     *         bank with other questions or from an older token version;
+     *         stats is left untouched in that case.
+     */
+    bool decode(const std::string& token, UserStats& stats, const QuestionBank& bank) const;
+
+    size_t getBudget() const { return maxTokenBytes; }
+    int getMaxAge() const { return maxAgeSeconds; }
+};
+
+#endif // SESSION_TOKEN_H
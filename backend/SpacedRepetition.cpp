@@ -0,0 +1,96 @@
+#include "SpacedRepetition.h"
+#include "MemoryUsage.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+uint64_t ReviewScheduler::nowMinutes() {
+    auto sinceEpoch = std::chrono::system_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::minutes>(sinceEpoch).count());
+}
+
+void ReviewScheduler::recordAnswer(int questionId, bool correct, uint64_t now) {
+    if (questionId < 0) return;
+    wheel.advance(now); // Keeps the wheel's clock near 'now' so the insert lands on a low level
+    ReviewCard& card = cards[static_cast<uint32_t>(questionId)];
+
+    int quality = correct ? 4 : 2;
+    float q = static_cast<float>(5 - quality);
+    card.easiness = std::max(1.3f, card.easiness + (0.1f - q * (0.08f + q * 0.02f)));
+
+    if (!correct) {
+        card.repetitions = 0;
+        card.intervalMinutes = kRelearnMinutes;
+    } else {
+        card.repetitions++;
+        if (card.repetitions == 1) card.intervalMinutes = kFirstIntervalMinutes;
+        else if (card.repetitions == 2) card.intervalMinutes = kSecondIntervalMinutes;
+        else card.intervalMinutes = static_cast<uint32_t>(std::min(
+                 static_cast<double>(UINT32_MAX), std::ceil(card.intervalMinutes * static_cast<double>(card.easiness))));
+    }
+    card.dueMinute = now + card.intervalMinutes;
+    wheel.insert(static_cast<uint32_t>(questionId), card.dueMinute);
+}
+
+int ReviewScheduler::popDue(uint64_t now) {
+    if (cards.empty()) return -1;
+    wheel.advance(now);
+    TimingWheel::Entry e;
+    while (wheel.popReady(e)) {
+        auto it = cards.find(e.id);
+        if (it == cards.end() || it->second.dueMinute != e.due) {
+            continue; // Stale: the card was rescheduled since this entry was filed
+        }
+        it->second.dueMinute = now + kRelearnMinutes;
+        wheel.insert(e.id, it->second.dueMinute);
+        return static_cast<int>(e.id);
+    }
+    return -1;
+}
+
+size_t ReviewScheduler::dueCount(uint64_t now) {
+    wheel.advance(now);
+    return wheel.readyCount(); // May include stale entries, so an upper bound
+}
+
+const ReviewCard* ReviewScheduler::findCard(int questionId) const {
+    auto it = cards.find(static_cast<uint32_t>(questionId));
+    return it != cards.end() ? &it->second : nullptr;
+}
+
+void ReviewScheduler::clear() {
+    cards.clear();
+    wheel.clear(0);
+}
+
+void ReviewScheduler::serialize(ByteWriter& out) const {
+    out.putVarint(cards.size());
+    for (auto const& pair : cards) {
+        out.putVarint(pair.first);
+        out.putVarint(static_cast<uint64_t>(std::lround(pair.second.easiness * 1000.0f)));
+        out.putVarint(pair.second.repetitions);
+        out.putVarint(pair.second.intervalMinutes);
+        out.putVarint(pair.second.dueMinute);
+    }
+}
+
+void ReviewScheduler::restore(ByteReader& in, size_t questionCount, uint64_t now) {
+    cards.clear();
+    wheel.clear(now);
+    uint64_t count = in.getVarint();
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t id = in.getVarint();
+        ReviewCard card;
+        card.easiness = static_cast<float>(in.getVarint()) / 1000.0f;
+        card.repetitions = static_cast<uint32_t>(in.getVarint());
+        card.intervalMinutes = static_cast<uint32_t>(in.getVarint());
+        card.dueMinute = in.getVarint();
+        if (id >= questionCount) continue; // The bank shrank; drop the card
+        cards[static_cast<uint32_t>(id)] = card;
+        wheel.insert(static_cast<uint32_t>(id), card.dueMinute);
+    }
+}
+
+size_t ReviewScheduler::memoryUsage() const {
+    return unorderedMapHeapBytes(cards) + wheel.memoryUsage();
+}
@@ -0,0 +1,73 @@
+#ifndef SPACED_REPETITION_H
+#define SPACED_REPETITION_H
+
+#include "BinaryIO.h"
+#include "TimingWheel.h"
+#include <cstdint>
+#include <unordered_map>
+
+/**
+ * @struct ReviewCard
+ * @brief SM-2 state of one answered question.
+ */
+struct ReviewCard {
+    float easiness = 2.5f;        // SM-2 E-factor, never below 1.3
+    uint32_t repetitions = 0;     // Consecutive correct reviews
+    uint32_t intervalMinutes = 0;
+    uint64_t dueMinute = 0;       // Absolute, minutes since the Unix epoch
+};
+
+/**
+ * @class ReviewScheduler
+ * @brief One learner's spaced-repetition queue (SM-2 with pass/fail grades).
+ *
+ * Every answered question gets a card. A correct answer advances it to
+ * 1 day, then 6 days, then interval x easiness; a wrong answer resets it
+ * and brings it back after a short relearning step. Due times live in a
+ * TimingWheel with one-minute ticks, so taking the next due review is O(1)
+ * amortized however many cards are scheduled.
+ *
+ * Cards are kept in a map and the wheel only holds (id, due) pairs; an
+ * entry whose due time no longer matches its card is stale and skipped.
+ */
+class ReviewScheduler {
+public:
+    static const uint32_t kRelearnMinutes = 10;
+    static const uint32_t kFirstIntervalMinutes = 24 * 60;
+    static const uint32_t kSecondIntervalMinutes = 6 * 24 * 60;
+
+    static uint64_t nowMinutes();
+
+private:
+    std::unordered_map<uint32_t, ReviewCard> cards;
+    TimingWheel wheel;
+
+public:
+    /**
+     * @brief Grades a review (correct = SM-2 quality 4, wrong = 2) and
+     * reschedules the card.
+     */
+    void recordAnswer(int questionId, bool correct, uint64_t now);
+
+    /**
+     * @brief Takes the next due question id, or -1 if none is due.
+     * The card is pushed back by the relearning step until it is answered,
+     * so a review that was served but never answered comes back.
+     */
+    int popDue(uint64_t now);
+
+    size_t scheduledCount() const { return cards.size(); }
+    size_t dueCount(uint64_t now);
+    const ReviewCard* findCard(int questionId) const;
+
+    // Heap bytes held by the cards and the wheel.
+    size_t memoryUsage() const;
+
+    void clear();
+
+    // Binary (de)serialization; restore() rebuilds the wheel at 'now'.
+    void serialize(ByteWriter& out) const;
+    void restore(ByteReader& in, size_t questionCount, uint64_t now);
+};
+
+#endif // SPACED_REPETITION_H
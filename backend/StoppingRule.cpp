@@ -0,0 +1,77 @@
+#include "StoppingRule.h"
+#include "UserStats.h"
+#include <iostream>
+
+StoppingRule::StoppingRule() {
+    for (auto& count : stops) {
+        count.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool StoppingRule::configure(const std::string& criterion, double seTarget, int minLength, int maxLength) {
+    targetStandardError = seTarget;
+    minQuestions = minLength < 0 ? 0 : minLength;
+    maxQuestions = maxLength < 0 ? 0 : maxLength;
+
+    useStandardError = (criterion == "se" || criterion == "either");
+    useMastery = (criterion == "mastery" || criterion == "either");
+    if (!useStandardError && !useMastery && criterion != "none") {
+        std::cerr << "Unknown stopping criterion '" << criterion << "' (use none, se, mastery or either)." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+StoppingRule::Reason StoppingRule::check(const UserStats& user, size_t topicCount) const {
+    int answered = user.getQuizAnswers();
+    if (maxQuestions > 0 && answered >= maxQuestions) {
+        return MaxLength;
+    }
+    if (answered < minQuestions) {
+        return Continue;
+    }
+    if (useStandardError && user.getAbility().getResponses() > 0 &&
+        user.getAbility().getStandardError() <= targetStandardError) {
+        return Precision;
+    }
+    if (useMastery && topicCount > 0 && static_cast<size_t>(user.getQuizMasteredTopicCount()) >= topicCount) {
+        return Mastery;
+    }
+    return Continue;
+}
+
+void StoppingRule::recordStop(Reason reason, int questionsAnswered) {
+    if (reason <= Continue || reason >= kReasonCount) return;
+    stops[reason].fetch_add(1, std::memory_order_relaxed);
+    questionsInStoppedQuizzes.fetch_add(static_cast<uint64_t>(questionsAnswered), std::memory_order_relaxed);
+}
+
+const char* StoppingRule::reasonName(Reason reason) {
+    switch (reason) {
+        case Precision: return "precision";
+        case Mastery: return "mastery";
+        case MaxLength: return "max-length";
+        default: return "continue";
+    }
+}
+
+nlohmann::json StoppingRule::getStatsJson() const {
+    nlohmann::json stats;
+    stats["enabled"] = isEnabled();
+    stats["criterion"] = useStandardError && useMastery ? "either" : useStandardError ? "se" : useMastery ? "mastery" : "none";
+    stats["targetStandardError"] = targetStandardError;
+    stats["minQuestions"] = minQuestions;
+    stats["maxQuestions"] = maxQuestions;
+
+    uint64_t total = 0;
+    nlohmann::json byReason;
+    for (int r = Precision; r < kReasonCount; ++r) {
+        uint64_t count = stops[r].load(std::memory_order_relaxed);
+        byReason[reasonName(static_cast<Reason>(r))] = count;
+        total += count;
+    }
+    stats["quizzesStopped"] = byReason;
+    stats["meanQuestionsPerStoppedQuiz"] =
+        total > 0 ? static_cast<double>(questionsInStoppedQuizzes.load(std::memory_order_relaxed)) / total : 0.0;
+    return stats;
+}
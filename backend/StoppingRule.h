@@ -0,0 +1,81 @@
+#ifndef STOPPING_RULE_H
+#define STOPPING_RULE_H
+
+#include "json.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Forward declarations
+class UserStats;
+
+/**
+ * @class StoppingRule
+ * @brief Computerized-adaptive-testing termination: ends a quiz once the
+ * learner has been measured well enough, instead of after a fixed count.
+ *
+ * Criteria (checked after at least minQuestions answers in the quiz), each
+ * reached by the current quiz's own answers:
+ *  - "se": the IRT ability estimate's standard error is at or below the
+ *    target (UserStats::resetSession widens the posterior at quiz start);
+ *  - "mastery": every topic in the bank was answered in this quiz and BKT
+ *    puts it at or above the mastery threshold;
+ *  - "either": whichever of the two comes first.
+ * A maximum length applies on its own, with or without a criterion.
+ *
+ * Everything a check reads is maintained per answer by UserStats (the
+ * ability posterior, a count of topics mastered this quiz, answers this
+ * quiz), so check() is O(1). Stop counts are lock-free.
+ */
+class StoppingRule {
+public:
+    enum Reason {
+        Continue = 0,
+        Precision,   // Ability standard error reached the target
+        Mastery,     // Every topic mastered
+        MaxLength,   // Hit the question limit
+        kReasonCount
+    };
+
+private:
+    bool useStandardError = false;
+    bool useMastery = false;
+    double targetStandardError = 0.3;
+    int minQuestions = 5;
+    int maxQuestions = 0; // 0 = no limit
+
+    std::atomic<uint64_t> stops[kReasonCount];
+    std::atomic<uint64_t> questionsInStoppedQuizzes{0};
+
+public:
+    StoppingRule();
+
+    /**
+     * @param criterion "none", "se", "mastery" or "either".
+     * @return false (and prints why) if the criterion is unknown; the rule is then off.
+     */
+    bool configure(const std::string& criterion, double seTarget, int minLength, int maxLength);
+
+    bool isEnabled() const { return useStandardError || useMastery || maxQuestions > 0; }
+
+    /**
+     * @brief Whether the learner's current quiz is over, and why. O(1).
+     * @param topicCount Number of topics in the bank.
+     */
+    Reason check(const UserStats& user, size_t topicCount) const;
+
+    /**
+     * @brief Counts a finished quiz. Call once, when check() first stops it.
+     */
+    void recordStop(Reason reason, int questionsAnswered);
+
+    static const char* reasonName(Reason reason);
+
+    /**
+     * @brief The configuration, quizzes stopped per reason and the mean length of a stopped quiz.
+     */
+    nlohmann::json getStatsJson() const;
+};
+
+#endif // STOPPING_RULE_H
@@ -0,0 +1,105 @@
+#include "ThompsonSampling.h"
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <random>
+#include <thread>
+
+namespace {
+    // Above this many pseudo-observations the Beta posterior is treated as normal.
+    const double kNormalApproxThreshold = 200.0;
+
+    uint64_t splitMix64(uint64_t& state) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+}
+
+FastRng::FastRng(uint64_t seed) {
+    for (uint64_t& word : s) {
+        word = splitMix64(seed);
+    }
+}
+
+uint64_t FastRng::next() {
+    uint64_t result = s[0] + s[3];
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+double FastRng::normal() {
+    double u, v, r;
+    do {
+        u = 2.0 * uniform() - 1.0;
+        v = 2.0 * uniform() - 1.0;
+        r = u * u + v * v;
+    } while (r >= 1.0 || r == 0.0);
+    // Only one value of the pair is used; caching the other would make
+    // normal() stateful for little gain.
+    return u * std::sqrt(-2.0 * std::log(r) / r);
+}
+
+FastRng& FastRng::forThisThread() {
+    thread_local FastRng rng(std::random_device{}() ^
+                             std::hash<std::thread::id>()(std::this_thread::get_id()) ^
+                             static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()));
+    return rng;
+}
+
+double sampleGamma(double shape, FastRng& rng) {
+    if (shape < 1.0) {
+        // Gamma(a) = Gamma(a + 1) * U^(1/a)
+        double u = rng.uniform();
+        return sampleGamma(shape + 1.0, rng) * std::pow(u, 1.0 / shape);
+    }
+    double d = shape - 1.0 / 3.0;
+    double c = 1.0 / std::sqrt(9.0 * d);
+    while (true) {
+        double x, v;
+        do {
+            x = rng.normal();
+            v = 1.0 + c * x;
+        } while (v <= 0.0);
+        v = v * v * v;
+        double u = rng.uniform();
+        // Cheap squeeze test first; the log test is rarely needed.
+        if (u < 1.0 - 0.0331 * x * x * x * x) return d * v;
+        if (std::log(u) < 0.5 * x * x + d * (1.0 - v + std::log(v))) return d * v;
+    }
+}
+
+double sampleBeta(double alpha, double beta, FastRng& rng) {
+    double total = alpha + beta;
+    if (total > kNormalApproxThreshold) {
+        double mean = alpha / total;
+        double sd = std::sqrt(alpha * beta / (total * total * (total + 1.0)));
+        double x = mean + sd * rng.normal();
+        return x < 0.0 ? 0.0 : (x > 1.0 ? 1.0 : x);
+    }
+    double x = sampleGamma(alpha, rng);
+    double y = sampleGamma(beta, rng);
+    return x / (x + y);
+}
+
+int thompsonArgmax(const float* alpha, const float* beta, size_t n, FastRng& rng) {
+    int best = -1;
+    double bestSample = -1.0;
+    for (size_t i = 0; i < n; ++i) {
+        double sample = sampleBeta(alpha[i], beta[i], rng);
+        if (sample > bestSample) {
+            bestSample = sample;
+            best = static_cast<int>(i);
+        }
+    }
+    return best;
+}
@@ -0,0 +1,54 @@
+#ifndef THOMPSON_SAMPLING_H
+#define THOMPSON_SAMPLING_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class FastRng
+ * @brief xoshiro256+ generator: a few cycles per draw, far cheaper than
+ * std::mt19937 + std::uniform_real_distribution on the selection hot path.
+ */
+class FastRng {
+private:
+    uint64_t s[4];
+
+public:
+    explicit FastRng(uint64_t seed);
+
+    uint64_t next();
+
+    // Uniform in [0, 1).
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+    // Standard normal (Marsaglia polar method).
+    double normal();
+
+    /**
+     * @brief The calling thread's generator, seeded once per thread.
+     */
+    static FastRng& forThisThread();
+};
+
+/**
+ * @brief Draws from Gamma(shape, 1) with the Marsaglia-Tsang method
+ * (about one normal and one uniform per draw; shape < 1 is boosted).
+ */
+double sampleGamma(double shape, FastRng& rng);
+
+/**
+ * @brief Draws from Beta(alpha, beta). Once alpha + beta is large the
+ * posterior is close to normal, so a single moment-matched normal draw is
+ * used instead of two gamma draws.
+ */
+double sampleBeta(double alpha, double beta, FastRng& rng);
+
+/**
+ * @brief Thompson sampling over n Beta arms stored as two parallel arrays
+ * (structure of arrays). Draws one sample per arm and returns the index of
+ * the largest. O(n), no allocation.
+ * @return -1 if n is 0.
+ */
+int thompsonArgmax(const float* alpha, const float* beta, size_t n, FastRng& rng);
+
+#endif // THOMPSON_SAMPLING_H
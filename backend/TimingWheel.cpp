@@ -0,0 +1,119 @@
+#include "TimingWheel.h"
+#include "MemoryUsage.h"
+
+namespace {
+    int countTrailingZeros(uint64_t v) {
+        int n = 0;
+        while ((v & 1) == 0) {
+            v >>= 1;
+            ++n;
+        }
+        return n;
+    }
+}
+
+void TimingWheel::place(const Entry& e) {
+    uint64_t delta = e.due - current; // Caller guarantees due > current
+    int level = 0;
+    while (level < kLevels - 1 && delta >= (1ull << (kSlotBits * (level + 1)))) {
+        ++level;
+    }
+    int shift = kSlotBits * level;
+    uint64_t slotTick = e.due >> shift;
+    // Too far out for the top level: park it in the furthest slot.
+    uint64_t furthest = (current >> shift) + kSlots;
+    if (slotTick > furthest) slotTick = furthest;
+
+    Level& l = levels[level];
+    if (l.slots.empty()) {
+        l.slots.resize(kSlots);
+    }
+    int slot = static_cast<int>(slotTick & (kSlots - 1));
+    l.slots[slot].push_back(e);
+    l.occupied |= 1ull << slot;
+    ++pending;
+}
+
+void TimingWheel::insert(uint32_t id, uint64_t dueTick) {
+    Entry e{id, dueTick};
+    if (dueTick <= current) {
+        ready.push_back(e);
+    } else {
+        place(e);
+    }
+}
+
+void TimingWheel::advance(uint64_t now) {
+    if (now <= current || pending == 0) {
+        if (now > current) current = now;
+        return;
+    }
+
+    // Gather every slot whose span has started by 'now', at all levels,
+    // then re-file its entries against the new current tick.
+    std::vector<Entry> moved;
+    for (int level = 0; level < kLevels; ++level) {
+        Level& l = levels[level];
+        if (l.occupied == 0) continue;
+
+        int shift = kSlotBits * level;
+        uint64_t from = (current >> shift) + 1;
+        uint64_t to = now >> shift;
+        if (to < from) continue;
+
+        uint64_t mask;
+        if (to - from + 1 >= static_cast<uint64_t>(kSlots)) {
+            mask = ~0ull;
+        } else {
+            // Slots from..to, wrapping around the 64-slot ring.
+            int first = static_cast<int>(from & (kSlots - 1));
+            int count = static_cast<int>(to - from + 1);
+            uint64_t run = (count == 64) ? ~0ull : ((1ull << count) - 1);
+            mask = (run << first) | (first ? (run >> (kSlots - first)) : 0);
+        }
+
+        uint64_t hit = l.occupied & mask;
+        while (hit) {
+            int slot = countTrailingZeros(hit);
+            hit &= hit - 1;
+            std::vector<Entry>& entries = l.slots[slot];
+            pending -= entries.size();
+            moved.insert(moved.end(), entries.begin(), entries.end());
+            entries.clear();
+            l.occupied &= ~(1ull << slot);
+        }
+    }
+
+    current = now;
+    for (const Entry& e : moved) {
+        insert(e.id, e.due);
+    }
+}
+
+bool TimingWheel::popReady(Entry& out) {
+    if (ready.empty()) return false;
+    out = ready.front();
+    ready.pop_front();
+    return true;
+}
+
+void TimingWheel::clear(uint64_t startTick) {
+    for (Level& l : levels) {
+        l.occupied = 0;
+        l.slots.clear();
+    }
+    pending = 0;
+    ready.clear();
+    current = startTick;
+}
+
+size_t TimingWheel::memoryUsage() const {
+    size_t bytes = dequeHeapBytes(ready);
+    for (const Level& level : levels) {
+        bytes += vectorHeapBytes(level.slots);
+        for (const std::vector<Entry>& slot : level.slots) {
+            bytes += vectorHeapBytes(slot);
+        }
+    }
+    return bytes;
+}
@@ -0,0 +1,78 @@
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+/**
+ * @class TimingWheel
+ * @brief Hierarchical timing wheel of (id, due tick) entries.
+ *
+ * Four levels of 64 slots; a level-k slot spans 64^k ticks, so with
+ * one-minute ticks the wheel covers about 31 years (anything further out is
+ * parked in the last slot and re-filed when reached). Insert is O(1).
+ * advance() visits only occupied slots (found with a 64-bit occupancy mask
+ * per level), and each entry cascades down at most once per level, so
+ * collecting due entries is O(1) amortized per entry no matter how long the
+ * wheel sat idle. Levels allocate their slots on first use.
+ */
+class TimingWheel {
+public:
+    static const int kLevels = 4;
+    static const int kSlotBits = 6;
+    static const int kSlots = 1 << kSlotBits;
+
+    struct Entry {
+        uint32_t id;
+        uint64_t due;
+    };
+
+private:
+    struct Level {
+        uint64_t occupied = 0;           // Bit s set <=> slots[s] is non-empty
+        std::vector<std::vector<Entry>> slots;
+    };
+
+    Level levels[kLevels];
+    uint64_t current = 0;
+    size_t pending = 0;                  // Entries still on the wheel
+    std::deque<Entry> ready;             // Due entries not yet taken, in the order they became due
+
+    void place(const Entry& e);
+
+public:
+    explicit TimingWheel(uint64_t startTick = 0) : current(startTick) {}
+
+    /**
+     * @brief Schedules an entry. Entries due at or before the current tick
+     * are ready immediately.
+     */
+    void insert(uint32_t id, uint64_t dueTick);
+
+    /**
+     * @brief Moves time forward to 'now' (never backwards) and collects
+     * every entry that has become due.
+     */
+    void advance(uint64_t now);
+
+    /**
+     * @brief Takes the ready entry that became due first. Entries collected
+     * by the same advance() call come out in no particular order.
+     * @return false if nothing is ready.
+     */
+    bool popReady(Entry& out);
+
+    size_t readyCount() const { return ready.size(); }
+    size_t size() const { return pending + ready.size(); }
+    uint64_t getCurrentTick() const { return current; }
+
+    // Heap bytes held by the slots and the ready queue.
+    size_t memoryUsage() const;
+
+    // Drops every entry and restarts at startTick.
+    void clear(uint64_t startTick);
+};
+
+#endif // TIMING_WHEEL_H
@@ -0,0 +1,56 @@
+#include "TopicTrend.h"
+#include <bitset>
+#include <cmath>
+
+namespace {
+    int windowSize = 10;
+    float decayFactor = 0.917f; // Half-life of 8 answers
+}
+
+void TopicTrend::configure(int window, double halfLifeAnswers) {
+    windowSize = window < 1 ? 1 : (window > kMaxWindow ? kMaxWindow : window);
+    if (halfLifeAnswers > 0.0) {
+        decayFactor = static_cast<float>(std::pow(0.5, 1.0 / halfLifeAnswers));
+    }
+}
+
+int TopicTrend::getWindow() {
+    return windowSize;
+}
+
+void TopicTrend::record(bool correct) {
+    decayedCorrect = decayedCorrect * decayFactor + (correct ? 1.0f : 0.0f);
+    decayedTotal = decayedTotal * decayFactor + 1.0f;
+    recentBits = (recentBits << 1) | (correct ? 1u : 0u);
+    if (recentCount < static_cast<uint32_t>(kMaxWindow)) recentCount++;
+}
+
+double TopicTrend::decayedAccuracy() const {
+    return decayedTotal > 0.0f ? static_cast<double>(decayedCorrect) / decayedTotal : 0.0;
+}
+
+int TopicTrend::recentAnswers() const {
+    return static_cast<int>(recentCount) < windowSize ? static_cast<int>(recentCount) : windowSize;
+}
+
+double TopicTrend::recentAccuracy() const {
+    int n = recentAnswers();
+    if (n == 0) return 0.0;
+    uint64_t mask = n == kMaxWindow ? ~0ull : ((1ull << n) - 1);
+    return static_cast<double>(std::bitset<64>(recentBits & mask).count()) / n;
+}
+
+void TopicTrend::serialize(ByteWriter& out) const {
+    out.putVarint(static_cast<uint64_t>(std::lround(decayedCorrect * 1000.0f)));
+    out.putVarint(static_cast<uint64_t>(std::lround(decayedTotal * 1000.0f)));
+    out.putVarint(recentBits);
+    out.putVarint(recentCount);
+}
+
+void TopicTrend::restore(ByteReader& in) {
+    decayedCorrect = static_cast<float>(in.getVarint()) / 1000.0f;
+    decayedTotal = static_cast<float>(in.getVarint()) / 1000.0f;
+    recentBits = in.getVarint();
+    uint64_t count = in.getVarint();
+    recentCount = static_cast<uint32_t>(count > static_cast<uint64_t>(kMaxWindow) ? kMaxWindow : count);
+}
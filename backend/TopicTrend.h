@@ -0,0 +1,55 @@
+#ifndef TOPIC_TREND_H
+#define TOPIC_TREND_H
+
+#include "BinaryIO.h"
+#include <cstdint>
+
+/**
+ * @brief Which per-topic accuracy UserStats::getWeakestTopic() ranks by.
+ */
+enum class TopicScore {
+    Lifetime, // Correct / attempted since the session began (the original behavior)
+    Decayed,  // Exponentially decayed accuracy
+    Recent    // Accuracy over the last N answers on the topic
+};
+
+/**
+ * @struct TopicTrend
+ * @brief Recent performance on one topic in 24 bytes, however long the history.
+ *
+ * Two views, both updated in O(1) per answer:
+ *  - an exponentially decayed accuracy: every answer on the topic scales the
+ *    old evidence by the decay factor, so an answer counts half as much
+ *    after 'half-life' more answers;
+ *  - the outcomes of the last N answers, kept as a 64-bit shift register
+ *    (bit 0 = most recent, 1 = correct). N is a process-wide setting of at
+ *    most 64, applied when reading, so it can change between restarts.
+ */
+struct TopicTrend {
+    static const int kMaxWindow = 64;
+
+    float decayedCorrect = 0.0f; // Sum of decay^age over correct answers
+    float decayedTotal = 0.0f;   // Sum of decay^age over all answers
+    uint64_t recentBits = 0;
+    uint32_t recentCount = 0;    // Answers in recentBits, up to kMaxWindow
+
+    /**
+     * @brief Sets the ring-buffer window (clamped to 1..64) and the decay
+     * half-life in answers. Call once at startup.
+     */
+    static void configure(int window, double halfLifeAnswers);
+    static int getWindow();
+
+    void record(bool correct);
+
+    // Both return 0..1; a topic with no answers reports 0.
+    double decayedAccuracy() const;
+    double recentAccuracy() const;
+    int recentAnswers() const;
+
+    // The decayed sums are stored in thousandths.
+    void serialize(ByteWriter& out) const;
+    void restore(ByteReader& in);
+};
+
+#endif // TOPIC_TREND_H
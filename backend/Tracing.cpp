@@ -0,0 +1,120 @@
+#include "Tracing.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+    // Fields are relaxed atomics so export can read a slot while its
+    // owner overwrites it; a torn slot is detected by re-reading 'head'.
+    struct Event {
+        std::atomic<const char*> name{nullptr};
+        std::atomic<uint64_t> start{0};
+        std::atomic<uint64_t> duration{0};
+    };
+
+    struct ThreadTrace {
+        int threadId = 0;
+        std::atomic<uint64_t> head{0};        // Spans ever recorded by this thread
+        std::atomic<uint64_t> clearedAt{0};   // Spans before this index were cleared
+        std::unique_ptr<Event[]> events{new Event[Tracer::kRingEvents]};
+    };
+
+    std::mutex tracesMutex;
+    std::vector<std::shared_ptr<ThreadTrace>> traces;
+
+    ThreadTrace& traceForThisThread() {
+        thread_local std::shared_ptr<ThreadTrace> trace;
+        if (!trace) {
+            trace = std::make_shared<ThreadTrace>();
+            std::lock_guard<std::mutex> lock(tracesMutex);
+            trace->threadId = static_cast<int>(traces.size()) + 1;
+            traces.push_back(trace);
+        }
+        return *trace;
+    }
+
+    void appendJsonString(std::string& out, const char* text) {
+        out += '"';
+        for (const char* p = text; *p; ++p) {
+            if (*p == '"' || *p == '\\') out += '\\';
+            out += *p;
+        }
+        out += '"';
+    }
+}
+
+uint64_t Tracer::nowNanos() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void Tracer::record(const char* name, uint64_t startNanos, uint64_t durationNanos) {
+    ThreadTrace& trace = traceForThisThread();
+    uint64_t head = trace.head.load(std::memory_order_relaxed);
+    Event& event = trace.events[head & (kRingEvents - 1)];
+    event.name.store(name, std::memory_order_relaxed);
+    event.start.store(startNanos, std::memory_order_relaxed);
+    event.duration.store(durationNanos, std::memory_order_relaxed);
+    trace.head.store(head + 1, std::memory_order_release);
+}
+
+long Tracer::writeChromeTrace(const std::string& path) {
+    std::vector<std::shared_ptr<ThreadTrace>> threads;
+    {
+        std::lock_guard<std::mutex> lock(tracesMutex);
+        threads = traces;
+    }
+
+    std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    long written = 0;
+    char buf[128];
+    for (const auto& trace : threads) {
+        uint64_t head = trace->head.load(std::memory_order_acquire);
+        uint64_t first = head > kRingEvents ? head - kRingEvents : 0;
+        first = std::max(first, trace->clearedAt.load(std::memory_order_relaxed));
+
+        std::string threadEvents;
+        long threadCount = 0;
+        for (uint64_t i = first; i < head; ++i) {
+            const Event& event = trace->events[i & (kRingEvents - 1)];
+            const char* name = event.name.load(std::memory_order_relaxed);
+            uint64_t start = event.start.load(std::memory_order_relaxed);
+            uint64_t duration = event.duration.load(std::memory_order_relaxed);
+            // Skip the slot if the owner lapped us while we read it.
+            if (trace->head.load(std::memory_order_acquire) - i >= kRingEvents || name == nullptr) continue;
+
+            threadEvents += (written + threadCount) ? ",{\"name\":" : "{\"name\":";
+            appendJsonString(threadEvents, name);
+            std::snprintf(buf, sizeof(buf), ",\"cat\":\"quiz\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+                          start / 1000.0, duration / 1000.0, trace->threadId);
+            threadEvents += buf;
+            threadCount++;
+        }
+        out += threadEvents;
+        written += threadCount;
+    }
+    out += "]}\n";
+
+    std::ofstream file(path, std::ios::trunc);
+    if (!file || !file.write(out.data(), static_cast<std::streamsize>(out.size()))) {
+        return -1;
+    }
+    return written;
+}
+
+void Tracer::clear() {
+    std::lock_guard<std::mutex> lock(tracesMutex);
+    for (auto& trace : traces) {
+        trace->clearedAt.store(trace->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+size_t Tracer::memoryUsage() {
+    std::lock_guard<std::mutex> lock(tracesMutex);
+    return traces.size() * (sizeof(ThreadTrace) + kRingEvents * sizeof(Event));
+}
@@ -0,0 +1,81 @@
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Build with -DQUIZ_TRACING=1 to compile the spans in.
+#ifndef QUIZ_TRACING
+#define QUIZ_TRACING 0
+#endif
+
+/**
+ * @class Tracer
+ * @brief Collects hot-path timing spans and exports them as Chrome trace
+ * JSON (load the file in chrome://tracing or ui.perfetto.dev).
+ *
+ * Each thread appends completed spans to its own fixed-size ring. The
+ * newest kRingEvents per thread are kept, and older ones are overwritten.
+ * Recording a span costs two clock reads and three relaxed stores, with no
+ * lock and no allocation after the thread's first span. Export copies the
+ * rings while they keep recording.
+ */
+class Tracer {
+public:
+    static constexpr bool kEnabled = QUIZ_TRACING != 0;
+    static const size_t kRingEvents = 1 << 16;
+
+    static uint64_t nowNanos();
+
+    /**
+     * @brief Stores one completed span in this thread's ring. 'name' must
+     * be a string literal (only the pointer is kept).
+     */
+    static void record(const char* name, uint64_t startNanos, uint64_t durationNanos);
+
+    /**
+     * @brief Writes every buffered span to 'path' as Chrome trace JSON.
+     * @return The number of spans written, or -1 if the file could not be written.
+     */
+    static long writeChromeTrace(const std::string& path);
+
+    /**
+     * @brief Forgets every buffered span.
+     */
+    static void clear();
+
+    // Bytes held by the per-thread span rings.
+    static size_t memoryUsage();
+};
+
+/**
+ * @class BasicTraceSpan
+ * @brief Times the enclosing scope. The <false> specialization is empty,
+ * so with tracing off a span compiles to nothing.
+ */
+template <bool Enabled>
+class BasicTraceSpan {
+    const char* name;
+    uint64_t start;
+
+public:
+    explicit BasicTraceSpan(const char* spanName) : name(spanName), start(Tracer::nowNanos()) {}
+    ~BasicTraceSpan() { Tracer::record(name, start, Tracer::nowNanos() - start); }
+
+    BasicTraceSpan(const BasicTraceSpan&) = delete;
+    BasicTraceSpan& operator=(const BasicTraceSpan&) = delete;
+};
+
+template <>
+class BasicTraceSpan<false> {
+public:
+    explicit BasicTraceSpan(const char*) {}
+
+    BasicTraceSpan(const BasicTraceSpan&) = delete;
+    BasicTraceSpan& operator=(const BasicTraceSpan&) = delete;
+};
+
+using TraceSpan = BasicTraceSpan<Tracer::kEnabled>;
+
+#endif // TRACING_H
@@ -3,7 +3,7 @@
 #include <iostream>
 
 // Constructor
-TrueFalseQuestion::TrueFalseQuestion(const std::string& text, const std::string& topic, int difficulty, bool answer)
+TrueFalseQuestion::TrueFalseQuestion(const std::string& text, const std::string& topic, double difficulty, bool answer)
     : Question(text, topic, difficulty), correctAnswer(answer) {
     // Body is empty
 }
@@ -21,7 +21,7 @@ public:
      * @param diff The difficulty level.
      * @param correctAns The correct boolean answer.
      */
-    TrueFalseQuestion(const std::string& text, const std::string& top, int diff, bool correctAns);
+    TrueFalseQuestion(const std::string& text, const std::string& top, double diff, bool correctAns);
 
     /**
      * @brief Displays the question and the (True/False) prompt.
@@ -51,6 +51,8 @@ public:
     std::string getQuestionType() const override {
         return "TF";
     }
+
+    size_t objectBytes() const override { return sizeof(*this); }
 };
 
 #endif // TRUE_FALSE_QUESTION_H
\ No newline at end of file
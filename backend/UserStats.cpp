@@ -1,14 +1,21 @@
 #include "UserStats.h"
 #include "Question.h" 
+#include "QuestionBank.h"
+#include "EloRating.h"
+#include "ThompsonSampling.h"
+#include "MemoryUsage.h"
+#include "Logger.h"
 #include "json.hpp" 
 #include <iostream>
 #include <iomanip> 
 #include <limits>  
 #include <algorithm> 
 #include <cstdlib>   
+#include <cmath>
 
 UserStats::UserStats(const std::string& username)
-    : username(username), currentDifficulty(1), lastQuestionAsked(nullptr) {
+    : username(username), currentDifficulty(1), lastQuestionAsked(nullptr),
+      quizAnswers(0), masteredTopics(0), quizMasteredTopics(0), rating(0.0), ratedAnswers(0), sessionKey(0) {
 }
 
 void UserStats::updateStats(const std::string& topic, bool correct) {
@@ -16,6 +23,8 @@ void UserStats::updateStats(const std::string& topic, bool correct) {
     if (correct) {
         topicScores[topic]++;
     }
+    topicTrends[topic].record(correct);
+    quizAnswers++;
 }
 
 // --- NEW FUNCTION IMPLEMENTATION ---
@@ -36,7 +45,57 @@ bool UserStats::hasSufficientData(int minAttempts) const {
 // --- END OF NEW FUNCTION ---
 
 
-std::string UserStats::getWeakestTopic() const {
+void UserStats::updateMastery(const std::string& topic, bool correct, const BKTModel& model) {
+    const BKTParams& params = model.paramsFor(topic);
+    auto it = topicMastery.find(topic);
+    double current = (it != topicMastery.end()) ? it->second : params.pInit;
+    double updated = BKTModel::update(current, correct, params);
+    topicMastery[topic] = updated;
+
+    bool wasMastered = it != topicMastery.end() && current >= BKTModel::kMasteryThreshold;
+    bool isMastered = updated >= BKTModel::kMasteryThreshold;
+    masteredTopics += (isMastered ? 1 : 0) - (wasMastered ? 1 : 0);
+
+    auto quizIt = quizTopicMastered.find(topic);
+    bool wasQuizMastered = quizIt != quizTopicMastered.end() && quizIt->second;
+    quizTopicMastered[topic] = isMastered;
+    quizMasteredTopics += (isMastered ? 1 : 0) - (wasQuizMastered ? 1 : 0);
+}
+
+void UserStats::recountMastered() {
+    masteredTopics = 0;
+    for (auto const& pair : topicMastery) {
+        if (pair.second >= BKTModel::kMasteryThreshold) masteredTopics++;
+    }
+}
+
+double UserStats::getMastery(const std::string& topic, const BKTModel& model) const {
+    auto it = topicMastery.find(topic);
+    return (it != topicMastery.end()) ? it->second : model.paramsFor(topic).pInit;
+}
+
+std::string UserStats::getLowestMasteryTopic(const std::vector<std::string>& topics, const BKTModel& model) const {
+    if (topics.empty()) {
+        return "OOP Concepts"; // Safety fallback, same as getWeakestTopic()
+    }
+
+    std::vector<const std::string*> lowest;
+    double minMastery = std::numeric_limits<double>::max();
+    for (const std::string& topic : topics) {
+        double mastery = getMastery(topic, model);
+        if (mastery < minMastery - 1e-12) {
+            minMastery = mastery;
+            lowest.clear();
+        }
+        if (mastery <= minMastery + 1e-12) {
+            lowest.push_back(&topic);
+        }
+    }
+    return *lowest[rand() % lowest.size()];
+}
+
+
+std::string UserStats::getWeakestTopic(TopicScore scoreKind) const {
     // This function will now only be called if hasSufficientData() is true,
     // so we don't need the topicAttempts.empty() check, but we'll keep it
     // as a safety fallback.
@@ -50,14 +109,7 @@ std::string UserStats::getWeakestTopic() const {
 
     for (auto const& pair : topicAttempts) {
         const std::string& topic = pair.first; 
-        int attempts = pair.second;           
-
-        int correct = 0;
-        if (topicScores.count(topic)) {
-            correct = topicScores.at(topic);
-        }
-
-        double score = (attempts > 0) ? (static_cast<double>(correct) / attempts) : 0.0;
+        double score = getTopicScore(topic, scoreKind);
 
         if (score < minScore) {
             minScore = score;
@@ -70,19 +122,59 @@ std::string UserStats::getWeakestTopic() const {
     return weakestTopic.empty() ? "OOP Concepts" : weakestTopic;
 }
 
-void UserStats::adjustDifficulty(bool correct) {
+double UserStats::getTopicScore(const std::string& topic, TopicScore score) const {
+    if (score != TopicScore::Lifetime) {
+        auto trendIt = topicTrends.find(topic);
+        // Sessions saved before trends were tracked fall back to the lifetime score.
+        if (trendIt != topicTrends.end() && trendIt->second.recentCount > 0) {
+            return score == TopicScore::Decayed ? trendIt->second.decayedAccuracy()
+                                                : trendIt->second.recentAccuracy();
+        }
+    }
+
+    auto attemptsIt = topicAttempts.find(topic);
+    if (attemptsIt == topicAttempts.end() || attemptsIt->second <= 0) {
+        return 0.0;
+    }
+    auto scoreIt = topicScores.find(topic);
+    int correct = scoreIt != topicScores.end() ? scoreIt->second : 0;
+    return static_cast<double>(correct) / attemptsIt->second;
+}
+
+void UserStats::forgetQuestions() {
+    lastQuestionAsked = nullptr;
+    usedQuestionsThisSession.clear();
+    usedMask.clear();
+    reviews.clear();
+}
+
+int UserStats::getAttempts(const std::string& topic) const {
+    auto it = topicAttempts.find(topic);
+    return it != topicAttempts.end() ? it->second : 0;
+}
+
+size_t UserStats::memoryUsage() const {
+    return sizeof(UserStats) + stringHeapBytes(username) + stringHeapBytes(selectionPolicy) +
+           stringMapHeapBytes(topicScores) + stringMapHeapBytes(topicAttempts) +
+           stringMapHeapBytes(topicMastery) + stringMapHeapBytes(topicTrends) + stringMapHeapBytes(quizTopicMastered) +
+           vectorHeapBytes(usedQuestionsThisSession) + vectorHeapBytes(usedMask) +
+           vectorHeapBytes(banditAlpha) + vectorHeapBytes(banditBeta) +
+           ability.memoryUsage() + reviews.memoryUsage();
+}
+
+void UserStats::adjustDifficulty(bool correct, double step) {
     if (correct) {
-        currentDifficulty++;
-        if (currentDifficulty > 3) currentDifficulty = 3; // Clamp max
-        std::cout << "[Difficulty increased to level " << currentDifficulty << "]" << std::endl;
+        currentDifficulty += step;
+        if (currentDifficulty > kMaxDifficulty) currentDifficulty = kMaxDifficulty; // Clamp max
+        LOG_REQUEST("[Difficulty increased to level " << currentDifficulty << "]");
     } else {
-        currentDifficulty--;
-        if (currentDifficulty < 1) currentDifficulty = 1; // Clamp min
-        std::cout << "[Difficulty decreased to level " << currentDifficulty << "]" << std::endl;
+        currentDifficulty -= step;
+        if (currentDifficulty < kMinDifficulty) currentDifficulty = kMinDifficulty; // Clamp min
+        LOG_REQUEST("[Difficulty decreased to level " << currentDifficulty << "]");
     }
 }
 
-int UserStats::getNextDifficulty() const {
+double UserStats::getNextDifficulty() const {
     return currentDifficulty;
 }
 
@@ -90,6 +182,21 @@ nlohmann::json UserStats::getStatsJson() const {
     nlohmann::json statsJson;
     statsJson["username"] = this->username;
     statsJson["overallDifficulty"] = this->currentDifficulty;
+    if (ability.getResponses() > 0) {
+        statsJson["ability"] = ability.getTheta();
+        statsJson["abilityStandardError"] = ability.getStandardError();
+    }
+    if (ratedAnswers > 0) {
+        statsJson["rating"] = rating;
+    }
+    if (!selectionPolicy.empty()) {
+        statsJson["selectionPolicy"] = selectionPolicy;
+    }
+    if (reviews.scheduledCount() > 0) {
+        statsJson["reviewsScheduled"] = reviews.scheduledCount();
+    }
+    statsJson["quizAnswers"] = quizAnswers;
+    statsJson["masteredTopics"] = masteredTopics;
     
     nlohmann::json topicsArray = nlohmann::json::array(); 
 
@@ -113,6 +220,16 @@ nlohmann::json UserStats::getStatsJson() const {
         topicObj["correct"] = correct;
         topicObj["attempted"] = attempts;
         topicObj["score"] = scorePercent;
+        auto masteryIt = this->topicMastery.find(topic);
+        if (masteryIt != this->topicMastery.end()) {
+            topicObj["mastery"] = masteryIt->second;
+        }
+        auto trendIt = this->topicTrends.find(topic);
+        if (trendIt != this->topicTrends.end()) {
+            topicObj["decayedScore"] = trendIt->second.decayedAccuracy() * 100.0;
+            topicObj["recentScore"] = trendIt->second.recentAccuracy() * 100.0;
+            topicObj["recentAttempts"] = trendIt->second.recentAnswers();
+        }
         
         topicsArray.push_back(topicObj);
     }
@@ -123,13 +240,82 @@ nlohmann::json UserStats::getStatsJson() const {
 
 void UserStats::resetSession() {
     lastQuestionAsked = nullptr;
+    quizAnswers = 0;
+    quizTopicMastered.clear();
+    quizMasteredTopics = 0;
     usedQuestionsThisSession.clear();
+    usedMask.clear();
+    ability.widen(kQuizStartStandardError);
 }
 
 void UserStats::setLastQuestion(Question* q) {
     lastQuestionAsked = q;
     if (q != nullptr) {
-        usedQuestionsThisSession.push_back(q);
+        markUsed(q);
+    }
+}
+
+void UserStats::markUsed(Question* q) {
+    usedQuestionsThisSession.push_back(q);
+    size_t id = static_cast<size_t>(q->getId());
+    if (id >= usedMask.size()) {
+        usedMask.resize(id + 1, false);
+    }
+    usedMask[id] = true;
+}
+
+bool UserStats::isUsed(const Question* q) const {
+    size_t id = static_cast<size_t>(q->getId());
+    return id < usedMask.size() && usedMask[id];
+}
+
+void UserStats::updateAbility(const ItemParams& item, bool correct) {
+    ability.update(item, correct);
+}
+
+void UserStats::updateRating(double expected, bool correct) {
+    rating += EloRatings::stepSize(static_cast<uint64_t>(ratedAnswers)) * ((correct ? 1.0 : 0.0) - expected);
+    ratedAnswers++;
+}
+
+void UserStats::updateBandit(int topicIndex, bool correct) {
+    if (topicIndex < 0) return;
+    size_t index = static_cast<size_t>(topicIndex);
+    if (index >= banditAlpha.size()) {
+        banditAlpha.resize(index + 1, 1.0f);
+        banditBeta.resize(index + 1, 1.0f);
+    }
+    if (correct) banditBeta[index] += 1.0f;
+    else banditAlpha[index] += 1.0f;
+}
+
+int UserStats::sampleBanditTopic(size_t topicCount) const {
+    if (topicCount == 0) return -1;
+    // Arms never played are still at their Beta(1, 1) prior; pad a copy
+    // rather than growing the member arrays from a const method.
+    if (banditAlpha.size() < topicCount) {
+        std::vector<float> alpha(banditAlpha), beta(banditBeta);
+        alpha.resize(topicCount, 1.0f);
+        beta.resize(topicCount, 1.0f);
+        return thompsonArgmax(alpha.data(), beta.data(), topicCount, FastRng::forThisThread());
+    }
+    return thompsonArgmax(banditAlpha.data(), banditBeta.data(), topicCount, FastRng::forThisThread());
+}
+
+void UserStats::rebuildBandit(const QuestionBank& bank) {
+    banditAlpha.clear();
+    banditBeta.clear();
+    for (auto const& pair : topicAttempts) {
+        int index = bank.getTopicIndex(pair.first);
+        if (index < 0) continue;
+        auto scoreIt = topicScores.find(pair.first);
+        int correct = scoreIt != topicScores.end() ? scoreIt->second : 0;
+        if (static_cast<size_t>(index) >= banditAlpha.size()) {
+            banditAlpha.resize(index + 1, 1.0f);
+            banditBeta.resize(index + 1, 1.0f);
+        }
+        banditAlpha[index] = 1.0f + static_cast<float>(pair.second - correct);
+        banditBeta[index] = 1.0f + static_cast<float>(correct);
     }
 }
 
@@ -139,4 +325,404 @@ Question* UserStats::getLastQuestion() const {
 
 std::vector<Question*>& UserStats::getUsedQuestions() {
     return usedQuestionsThisSession;
-}
\ No newline at end of file
+}
+
+// --- Binary serialization ---
+// Layout: [format version] then repeated [tag][byte length][payload],
+// terminated by tag 0. Readers skip tags they do not know.
+
+namespace {
+    const uint8_t kStatsFormatVersion = 1;
+
+    enum StatsSection : uint64_t {
+        SectionEnd = 0,
+        SectionCore = 1,     // username, difficulty
+        SectionTopics = 2,   // per-topic attempts / correct
+        SectionSession = 3,  // last question, questions used this session
+        SectionMastery = 4,  // BKT mastery per topic
+        SectionAbility = 5,  // IRT ability estimate (mean, SE, response count)
+        SectionRating = 6,   // Elo rating and answer count
+        SectionPolicy = 7,   // Per-session selection policy name
+        SectionReviews = 8,  // Spaced-repetition cards
+        SectionTrends = 9,   // Decayed and last-N accuracy per topic
+        SectionDifficulty = 10, // Exact (fractional) difficulty; Core keeps it rounded for older readers
+        SectionProgress = 11, // Answers in the current quiz
+        SectionQuizMastery = 12, // Topics mastered during the current quiz
+        SectionExperiment = 13 // Answers in the session's experiment arm
+    };
+
+    void putSection(ByteWriter& out, StatsSection tag, const ByteWriter& body) {
+        out.putVarint(tag);
+        out.putVarint(body.size());
+        out.putBytes(body.data());
+    }
+}
+
+void UserStats::serialize(ByteWriter& out) const {
+    out.putU8(kStatsFormatVersion);
+
+    ByteWriter core;
+    core.putString(username);
+    core.putVarint(static_cast<uint64_t>(std::lround(currentDifficulty)));
+    putSection(out, SectionCore, core);
+
+    ByteWriter difficultyBody;
+    difficultyBody.putDouble(currentDifficulty);
+    putSection(out, SectionDifficulty, difficultyBody);
+
+    ByteWriter progress;
+    progress.putVarint(static_cast<uint64_t>(quizAnswers));
+    putSection(out, SectionProgress, progress);
+
+    ByteWriter quizMastery;
+    quizMastery.putVarint(static_cast<uint64_t>(quizMasteredTopics));
+    for (auto const& pair : quizTopicMastered) {
+        if (pair.second) quizMastery.putString(pair.first);
+    }
+    putSection(out, SectionQuizMastery, quizMastery);
+
+    if (experimentCounts.arm != 0) {
+        ByteWriter experimentBody;
+        experimentBody.putU64(experimentCounts.arm);
+        experimentBody.putVarint(experimentCounts.answered);
+        experimentBody.putVarint(experimentCounts.correct);
+        putSection(out, SectionExperiment, experimentBody);
+    }
+
+    ByteWriter topics;
+    topics.putVarint(topicAttempts.size());
+    for (auto const& pair : topicAttempts) {
+        auto scoreIt = topicScores.find(pair.first);
+        topics.putString(pair.first);
+        topics.putVarint(static_cast<uint64_t>(pair.second));
+        topics.putVarint(scoreIt != topicScores.end() ? static_cast<uint64_t>(scoreIt->second) : 0);
+    }
+    putSection(out, SectionTopics, topics);
+
+    ByteWriter session;
+    // Ids are stored +1 so that "no question" (nullptr) encodes as 0.
+    session.putVarint(lastQuestionAsked ? static_cast<uint64_t>(lastQuestionAsked->getId()) + 1 : 0);
+    session.putVarint(usedQuestionsThisSession.size());
+    for (Question* q : usedQuestionsThisSession) {
+        session.putVarint(static_cast<uint64_t>(q->getId()));
+    }
+    putSection(out, SectionSession, session);
+
+    ByteWriter mastery;
+    mastery.putVarint(topicMastery.size());
+    for (auto const& pair : topicMastery) {
+        mastery.putString(pair.first);
+        mastery.putDouble(pair.second);
+    }
+    putSection(out, SectionMastery, mastery);
+
+    ByteWriter abilityBody;
+    abilityBody.putDouble(ability.getTheta());
+    abilityBody.putDouble(ability.getStandardError());
+    abilityBody.putVarint(static_cast<uint64_t>(ability.getResponses()));
+    putSection(out, SectionAbility, abilityBody);
+
+    ByteWriter ratingBody;
+    ratingBody.putDouble(rating);
+    ratingBody.putVarint(static_cast<uint64_t>(ratedAnswers));
+    putSection(out, SectionRating, ratingBody);
+
+    if (!selectionPolicy.empty()) {
+        ByteWriter policyBody;
+        policyBody.putString(selectionPolicy);
+        putSection(out, SectionPolicy, policyBody);
+    }
+
+    if (reviews.scheduledCount() > 0) {
+        ByteWriter reviewBody;
+        reviews.serialize(reviewBody);
+        putSection(out, SectionReviews, reviewBody);
+    }
+
+    ByteWriter trends;
+    trends.putVarint(topicTrends.size());
+    for (auto const& pair : topicTrends) {
+        trends.putString(pair.first);
+        pair.second.serialize(trends);
+    }
+    putSection(out, SectionTrends, trends);
+
+    out.putVarint(SectionEnd);
+}
+
+void UserStats::restore(ByteReader& in, const QuestionBank& bank) {
+    uint8_t version = in.getU8();
+    if (version != kStatsFormatVersion) {
+        throw std::runtime_error("UserStats: unsupported format version");
+    }
+
+    topicScores.clear();
+    topicAttempts.clear();
+    topicMastery.clear();
+    topicTrends.clear();
+    lastQuestionAsked = nullptr;
+    quizAnswers = 0;
+    quizTopicMastered.clear();
+    quizMasteredTopics = 0;
+    experimentCounts = ExperimentCounts();
+    usedQuestionsThisSession.clear();
+    usedMask.clear();
+    ability = AbilityEstimate();
+    rating = 0.0;
+    ratedAnswers = 0;
+    selectionPolicy.clear();
+    reviews.clear();
+
+    while (true) {
+        uint64_t tag = in.getVarint();
+        if (tag == SectionEnd) break;
+        uint64_t length = in.getVarint();
+
+        if (tag == SectionCore) {
+            username = in.getString();
+            currentDifficulty = static_cast<double>(in.getVarint());
+        } else if (tag == SectionDifficulty) {
+            currentDifficulty = in.getDouble();
+        } else if (tag == SectionProgress) {
+            quizAnswers = static_cast<int>(in.getVarint());
+        } else if (tag == SectionQuizMastery) {
+            uint64_t topicCount = in.getVarint();
+            for (uint64_t i = 0; i < topicCount; ++i) {
+                quizTopicMastered[in.getString()] = true;
+            }
+            quizMasteredTopics = static_cast<int>(quizTopicMastered.size());
+        } else if (tag == SectionExperiment) {
+            experimentCounts.arm = in.getU64();
+            experimentCounts.answered = in.getVarint();
+            experimentCounts.correct = in.getVarint();
+        } else if (tag == SectionTopics) {
+            uint64_t topicCount = in.getVarint();
+            for (uint64_t i = 0; i < topicCount; ++i) {
+                std::string topic = in.getString();
+                topicAttempts[topic] = static_cast<int>(in.getVarint());
+                int correct = static_cast<int>(in.getVarint());
+                if (correct > 0) topicScores[topic] = correct;
+            }
+        } else if (tag == SectionSession) {
+            uint64_t last = in.getVarint();
+            lastQuestionAsked = last ? bank.getQuestionById(static_cast<int>(last - 1)) : nullptr;
+            uint64_t usedCount = in.getVarint();
+            for (uint64_t i = 0; i < usedCount; ++i) {
+                Question* q = bank.getQuestionById(static_cast<int>(in.getVarint()));
+                if (q != nullptr) markUsed(q);
+            }
+        } else if (tag == SectionMastery) {
+            uint64_t topicCount = in.getVarint();
+            for (uint64_t i = 0; i < topicCount; ++i) {
+                std::string topic = in.getString();
+                topicMastery[topic] = in.getDouble();
+            }
+        } else if (tag == SectionAbility) {
+            double mean = in.getDouble();
+            double se = in.getDouble();
+            ability.resetToNormal(mean, se, static_cast<int>(in.getVarint()));
+        } else if (tag == SectionRating) {
+            rating = in.getDouble();
+            ratedAnswers = static_cast<int>(in.getVarint());
+        } else if (tag == SectionPolicy) {
+            selectionPolicy = in.getString();
+        } else if (tag == SectionReviews) {
+            reviews.restore(in, bank.size(), ReviewScheduler::nowMinutes());
+        } else if (tag == SectionTrends) {
+            uint64_t topicCount = in.getVarint();
+            for (uint64_t i = 0; i < topicCount; ++i) {
+                std::string topic = in.getString();
+                topicTrends[topic].restore(in);
+            }
+        } else {
+            in.skip(length); // Written by a newer version; ignore.
+        }
+    }
+    // The bandit arms and mastered count are caches of the topic state.
+    rebuildBandit(bank);
+    recountMastered();
+}
+
+
+void UserStats::serializeCompact(ByteWriter& out, const QuestionBank& bank, bool includeUsed) const {
+    out.putVarint(static_cast<uint64_t>(std::lround(currentDifficulty)));
+    out.putVarint(lastQuestionAsked ? static_cast<uint64_t>(lastQuestionAsked->getId()) + 1 : 0);
+
+    // Topics are written by their index in the bank; a topic the bank no
+    // longer knows cannot be selected again anyway, so it is dropped.
+    ByteWriter topics;
+    uint64_t topicCount = 0;
+    for (auto const& pair : topicAttempts) {
+        int index = bank.getTopicIndex(pair.first);
+        if (index < 0) continue;
+        auto scoreIt = topicScores.find(pair.first);
+        topics.putVarint(static_cast<uint64_t>(index));
+        topics.putVarint(static_cast<uint64_t>(pair.second));
+        topics.putVarint(scoreIt != topicScores.end() ? static_cast<uint64_t>(scoreIt->second) : 0);
+        ++topicCount;
+    }
+    out.putVarint(topicCount);
+    out.putBytes(topics.data());
+
+    std::vector<int> usedIds;
+    if (includeUsed) {
+        for (Question* q : usedQuestionsThisSession) {
+            usedIds.push_back(q->getId());
+        }
+        std::sort(usedIds.begin(), usedIds.end());
+        usedIds.erase(std::unique(usedIds.begin(), usedIds.end()), usedIds.end());
+    }
+    putIdRuns(out, usedIds);
+
+    // Mastery is quantized to 16 bits; plenty for a probability that only
+    // drives topic selection.
+    ByteWriter mastery;
+    uint64_t masteryCount = 0;
+    for (auto const& pair : topicMastery) {
+        int index = bank.getTopicIndex(pair.first);
+        if (index < 0) continue;
+        mastery.putVarint(static_cast<uint64_t>(index));
+        mastery.putVarint(static_cast<uint64_t>(pair.second * 65535.0 + 0.5));
+        ++masteryCount;
+    }
+    out.putVarint(masteryCount);
+    out.putBytes(mastery.data());
+
+    // Ability as mean/SE in thousandths (mean zigzag-encoded, it can be negative).
+    out.putSignedVarint(std::llround(ability.getTheta() * 1000.0));
+    out.putVarint(static_cast<uint64_t>(std::llround(ability.getStandardError() * 1000.0)));
+    out.putVarint(static_cast<uint64_t>(ability.getResponses()));
+
+    out.putSignedVarint(std::llround(rating * 1000.0));
+    out.putVarint(static_cast<uint64_t>(ratedAnswers));
+    out.putString(selectionPolicy);
+    reviews.serialize(out);
+
+    ByteWriter trends;
+    uint64_t trendCount = 0;
+    for (auto const& pair : topicTrends) {
+        int index = bank.getTopicIndex(pair.first);
+        if (index < 0) continue;
+        trends.putVarint(static_cast<uint64_t>(index));
+        pair.second.serialize(trends);
+        ++trendCount;
+    }
+    out.putVarint(trendCount);
+    out.putBytes(trends.data());
+
+    // The exact difficulty in thousandths; the leading field only has the rounded level.
+    out.putVarint(static_cast<uint64_t>(std::llround(currentDifficulty * 1000.0)));
+    out.putVarint(static_cast<uint64_t>(quizAnswers));
+
+    // Topics mastered during this quiz, as an index list (the stopping rule needs them).
+    std::vector<int> quizMastered;
+    for (auto const& pair : quizTopicMastered) {
+        int index = bank.getTopicIndex(pair.first);
+        if (pair.second && index >= 0) quizMastered.push_back(index);
+    }
+    std::sort(quizMastered.begin(), quizMastered.end());
+    putIdRuns(out, quizMastered);
+
+    out.putU64(experimentCounts.arm);
+    out.putVarint(experimentCounts.answered);
+    out.putVarint(experimentCounts.correct);
+}
+
+void UserStats::restoreCompact(ByteReader& in, const QuestionBank& bank) {
+    topicScores.clear();
+    topicAttempts.clear();
+    topicMastery.clear();
+    topicTrends.clear();
+    quizAnswers = 0;
+    masteredTopics = 0;
+    quizTopicMastered.clear();
+    quizMasteredTopics = 0;
+    experimentCounts = ExperimentCounts();
+    usedQuestionsThisSession.clear();
+    usedMask.clear();
+    ability = AbilityEstimate();
+    rating = 0.0;
+    ratedAnswers = 0;
+    selectionPolicy.clear();
+    reviews.clear();
+
+    currentDifficulty = static_cast<double>(in.getVarint());
+    uint64_t last = in.getVarint();
+    lastQuestionAsked = last ? bank.getQuestionById(static_cast<int>(last - 1)) : nullptr;
+
+    const std::vector<std::string>& topicNames = bank.getTopics();
+    uint64_t topicCount = in.getVarint();
+    for (uint64_t i = 0; i < topicCount; ++i) {
+        uint64_t index = in.getVarint();
+        int attempts = static_cast<int>(in.getVarint());
+        int correct = static_cast<int>(in.getVarint());
+        if (index >= topicNames.size()) {
+            throw std::runtime_error("UserStats: topic index out of range");
+        }
+        topicAttempts[topicNames[index]] = attempts;
+        if (correct > 0) topicScores[topicNames[index]] = correct;
+    }
+    rebuildBandit(bank);
+
+    for (int id : getIdRuns(in, bank.size())) {
+        markUsed(bank.getQuestionById(id));
+    }
+
+    // Encodings written before mastery tracking simply end here.
+    if (in.atEnd()) return;
+    uint64_t masteryCount = in.getVarint();
+    for (uint64_t i = 0; i < masteryCount; ++i) {
+        uint64_t index = in.getVarint();
+        uint64_t quantized = in.getVarint();
+        if (index >= topicNames.size()) {
+            throw std::runtime_error("UserStats: topic index out of range");
+        }
+        topicMastery[topicNames[index]] = static_cast<double>(quantized) / 65535.0;
+    }
+    recountMastered();
+
+    if (in.atEnd()) return;
+    int64_t milliTheta = in.getSignedVarint();
+    double se = static_cast<double>(in.getVarint()) / 1000.0;
+    int responses = static_cast<int>(in.getVarint());
+    ability.resetToNormal(static_cast<double>(milliTheta) / 1000.0, se, responses);
+
+    if (in.atEnd()) return;
+    rating = static_cast<double>(in.getSignedVarint()) / 1000.0;
+    ratedAnswers = static_cast<int>(in.getVarint());
+
+    if (in.atEnd()) return;
+    selectionPolicy = in.getString();
+
+    if (in.atEnd()) return;
+    reviews.restore(in, bank.size(), ReviewScheduler::nowMinutes());
+
+    if (in.atEnd()) return;
+    uint64_t trendCount = in.getVarint();
+    for (uint64_t i = 0; i < trendCount; ++i) {
+        uint64_t index = in.getVarint();
+        TopicTrend trend;
+        trend.restore(in);
+        if (index >= topicNames.size()) {
+            throw std::runtime_error("UserStats: topic index out of range");
+        }
+        topicTrends[topicNames[index]] = trend;
+    }
+
+    if (in.atEnd()) return;
+    currentDifficulty = static_cast<double>(in.getVarint()) / 1000.0;
+
+    if (in.atEnd()) return;
+    quizAnswers = static_cast<int>(in.getVarint());
+
+    if (in.atEnd()) return;
+    for (int index : getIdRuns(in, topicNames.size())) {
+        quizTopicMastered[topicNames[index]] = true;
+    }
+    quizMasteredTopics = static_cast<int>(quizTopicMastered.size());
+
+    if (in.atEnd()) return;
+    experimentCounts.arm = in.getU64();
+    experimentCounts.answered = in.getVarint();
+    experimentCounts.correct = in.getVarint();
+}
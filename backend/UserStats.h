@@ -5,29 +5,100 @@
 #include <map>
 #include <vector>
 #include "json.hpp"
+#include "BinaryIO.h"
+#include "KnowledgeTracing.h"
+#include "ItemResponseTheory.h"
+#include "SpacedRepetition.h"
+#include "TopicTrend.h"
 
-// Forward declaration
+// Forward declarations
 class Question; 
+class QuestionBank;
+
+/**
+ * @struct ExperimentCounts
+ * @brief A session's answers within its experiment arm, kept with the
+ * session so Experiment can update its clustered sums from per-answer deltas.
+ */
+struct ExperimentCounts {
+    uint64_t arm = 0;      // Experiment::armTag() the counts belong to; 0 = none
+    uint64_t answered = 0;
+    uint64_t correct = 0;
+};
 
 class UserStats {
 private:
     std::string username;
     std::map<std::string, int> topicScores;
     std::map<std::string, int> topicAttempts;
-    int currentDifficulty;
+    std::map<std::string, double> topicMastery; // BKT P(known) per attempted topic
+    std::map<std::string, TopicTrend> topicTrends; // Decayed / last-N accuracy per attempted topic
+    double currentDifficulty;   // Between kMinDifficulty and kMaxDifficulty; fractional with fine steps
 
     Question* lastQuestionAsked;
     std::vector<Question*> usedQuestionsThisSession;
+    std::vector<bool> usedMask; // usedMask[id]: same set as above, for O(1) lookups
+    int quizAnswers;            // Answers since the last resetSession()
+    int masteredTopics;         // Topics with mastery >= BKTModel::kMasteryThreshold (cache of topicMastery)
+    // Topics answered since the last resetSession(), and whether each is at
+    // or above the mastery threshold (the stopping rule counts these).
+    std::map<std::string, bool> quizTopicMastered;
+    int quizMasteredTopics;     // Count of true entries in quizTopicMastered
+
+    AbilityEstimate ability;    // IRT theta posterior
+    double rating;              // Elo skill on the same logit scale as EloRatings
+    int ratedAnswers;           // Answers folded into 'rating' (drives its step size)
+
+    // Thompson-sampling topic bandit, indexed by the bank's topic index.
+    // Structure of arrays: each arm's Beta posterior over P(wrong answer)
+    // is (banditAlpha[i], banditBeta[i]) = (1 + wrong, 1 + correct).
+    std::vector<float> banditAlpha;
+    std::vector<float> banditBeta;
+
+    std::string selectionPolicy; // Name of a registered SelectionPolicy; empty = deployment default
+    uint64_t sessionKey;         // Random per-learner id carried by stateless tokens; 0 = none yet
+    ExperimentCounts experimentCounts; // Lifetime answers in the session's experiment arm
+
+    ReviewScheduler reviews;     // Spaced-repetition cards; empty unless --spaced-repetition is on
+
+    void rebuildBandit(const QuestionBank& bank);
+    void recountMastered();
+
+    void markUsed(Question* q);
 
 public:
+    static constexpr double kMinDifficulty = 1.0;
+    static constexpr double kMaxDifficulty = 3.0;
+    // resetSession() widens the ability posterior to at least this standard
+    // error (the prior's), so a precision stop has to be earned by the new quiz.
+    static constexpr double kQuizStartStandardError = 1.0;
+
     UserStats(const std::string& username);
 
+    std::string getUsername() const { return username; }
+
     void updateStats(const std::string& topic, bool correct);
-    std::string getWeakestTopic() const;
-    void adjustDifficulty(bool correct);
-    int getNextDifficulty() const;
+    std::string getWeakestTopic(TopicScore score = TopicScore::Lifetime) const;
+
+    /**
+     * @brief The topic's accuracy (0..1) under the given measure; 0 if it was never attempted.
+     */
+    double getTopicScore(const std::string& topic, TopicScore score) const;
+    int getAttempts(const std::string& topic) const;
+    /**
+     * @brief Moves the target difficulty up after a correct answer and down
+     * after a wrong one, by 'step' (a whole level by default), clamped to 1..3.
+     */
+    void adjustDifficulty(bool correct, double step = 1.0);
+    double getNextDifficulty() const;
     nlohmann::json getStatsJson() const; 
 
+    /**
+     * @brief Bytes this session holds: the object plus everything it owns
+     * on the heap (see MemoryUsage.h).
+     */
+    size_t memoryUsage() const;
+
     // --- NEW FUNCTION ---
     /**
      * @brief Checks if there's enough data to make an adaptive choice.
@@ -36,10 +107,132 @@ public:
      */
     bool hasSufficientData(int minAttempts = 3) const;
 
+    // --- Bayesian Knowledge Tracing ---
+
+    /**
+     * @brief Applies one BKT step to the topic's mastery probability. O(1) per answer
+     * (plus the map lookup).
+     */
+    void updateMastery(const std::string& topic, bool correct, const BKTModel& model);
+
+    /**
+     * @brief Current mastery probability; the topic's pInit if it was never attempted.
+     */
+    double getMastery(const std::string& topic, const BKTModel& model) const;
+
+    /**
+     * @brief The topic (out of 'topics') with the lowest mastery probability.
+     * Ties - e.g. several untouched topics - are broken at random.
+     */
+    std::string getLowestMasteryTopic(const std::vector<std::string>& topics, const BKTModel& model) const;
+
+    /**
+     * @brief Number of topics at or above BKTModel::kMasteryThreshold. O(1).
+     */
+    int getMasteredTopicCount() const { return masteredTopics; }
+
+    /**
+     * @brief Topics answered in the current quiz whose mastery is at or above
+     * the threshold. O(1).
+     */
+    int getQuizMasteredTopicCount() const { return quizMasteredTopics; }
+
+    /**
+     * @brief Answers given since the quiz was (re)started.
+     */
+    int getQuizAnswers() const { return quizAnswers; }
+
+    /**
+     * @brief Starts a new quiz: clears the served questions and the per-quiz
+     * counters, and widens the ability posterior (kQuizStartStandardError).
+     */
     void resetSession();
     void setLastQuestion(Question* q);
     Question* getLastQuestion() const;
     std::vector<Question*>& getUsedQuestions();
+
+    /**
+     * @brief O(1) check whether q was already served this session.
+     */
+    bool isUsed(const Question* q) const;
+    const std::vector<bool>& getUsedMask() const { return usedMask; }
+
+    /**
+     * @brief Drops everything keyed by question id (last and used questions,
+     * review cards), for state saved against a different question bank.
+     */
+    void forgetQuestions();
+
+    /**
+     * @brief Random id that tells learners apart when they share a username
+     * (stateless tokens); the experiment unit. Only SessionTokenCodec stores it.
+     */
+    uint64_t getSessionKey() const { return sessionKey; }
+    void setSessionKey(uint64_t key) { sessionKey = key; }
+
+    ExperimentCounts& getExperimentCounts() { return experimentCounts; }
+
+    // --- Item Response Theory ---
+    void updateAbility(const ItemParams& item, bool correct);
+    const AbilityEstimate& getAbility() const { return ability; }
+
+    // --- Elo rating ---
+
+    /**
+     * @brief Moves the learner's rating by K * (outcome - expected).
+     * @param expected The expected score returned by EloRatings::recordAnswer.
+     */
+    void updateRating(double expected, bool correct);
+    double getRating() const { return rating; }
+
+    // --- Spaced repetition ---
+    ReviewScheduler& getReviews() { return reviews; }
+
+    // --- Selection policy (see PolicyRegistry) ---
+    const std::string& getSelectionPolicy() const { return selectionPolicy; }
+    void setSelectionPolicy(const std::string& name) { selectionPolicy = name; }
+
+    // --- Thompson-sampling topic bandit ---
+
+    /**
+     * @brief Records one answer on the topic's arm. O(1).
+     */
+    void updateBandit(int topicIndex, bool correct);
+
+    /**
+     * @brief Samples every topic's posterior probability of a wrong answer
+     * and returns the index of the largest: mostly the learner's weakest
+     * topic, but topics with little data still get explored. O(topicCount).
+     */
+    int sampleBanditTopic(size_t topicCount) const;
+
+    /**
+     * @brief Writes the full session state in a compact binary form.
+     * The format is a list of tagged sections so new state can be added
+     * later without breaking old checkpoints.
+     */
+    void serialize(ByteWriter& out) const;
+
+    /**
+     * @brief Replaces this object's state with one written by serialize().
+     * Question ids are resolved against the given bank; unknown ids are dropped.
+     * Throws std::runtime_error if the data is truncated or malformed.
+     */
+    void restore(ByteReader& in, const QuestionBank& bank);
+
+    /**
+     * @brief Writes a minimal encoding of the adaptive state for session tokens:
+     * difficulty, per-topic counters (by topic index) and the used-question
+     * set as a run-length compressed bitmap. The username is not included.
+     * @param includeUsed Pass false to omit the used-question set (to fit a size budget).
+     */
+    void serializeCompact(ByteWriter& out, const QuestionBank& bank, bool includeUsed) const;
+
+    /**
+     * @brief Replaces this object's adaptive state with one written by serializeCompact().
+     * Throws std::runtime_error if the data is malformed.
+     */
+    void restoreCompact(ByteReader& in, const QuestionBank& bank);
 };
 
 #endif // USERSTATS_H
\ No newline at end of file
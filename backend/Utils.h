@@ -3,6 +3,7 @@
 
 #include <string>
 #include <cctype> // For std::tolower
+#include <cstdint>
 
 /**
  * @brief We mark these functions as 'inline' to tell the linker
@@ -28,5 +29,15 @@ inline std::string toLower(std::string s) {
     return s;
 }
 
+// 64-bit FNV-1a hash; used to check that persisted data still matches a question's text
+inline uint64_t fnv1a64(const std::string& s) {
+    uint64_t h = 1469598103934665603ULL;
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
 #endif // UTILS_H
 
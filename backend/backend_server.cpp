@@ -2,47 +2,444 @@
 #include "json.hpp"
 #include "QuestionBank.h"
 #include "UserStats.h"
+#include "QuestionStats.h"
+#include "Checkpoint.h"
+#include "ServerConfig.h"
+#include "SessionToken.h"
+#include "SessionStore.h"
+#include "KnowledgeTracing.h"
+#include "AnswerLog.h"
+#include "ItemResponseTheory.h"
+#include "EloRating.h"
+#include "SelectionPolicy.h"
+#include "Experiment.h"
+#include "StoppingRule.h"
+#include "ExposureControl.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include "BucketInventory.h"
+#include "Tracing.h"
+#include "ConnectionTracker.h"
+#include "HmacSha256.h"
 #include <iostream>
 #include <string>
+#include <mutex>
+#include <memory>
+#include <random>
+#include <cstdio>
+#ifndef _WIN32
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
 
 // Use the nlohmann/json library
 using json = nlohmann::json;
 
 // --- Global Objects ---
+ServerConfig config;
 QuestionBank questionBank;
-UserStats user("QuizUser");
+std::unique_ptr<SessionStore> sessionStore; // Server-side sessions (hot RAM + cold disk tier)
+QuestionStats questionStats;
+BKTModel bktModel;
+IRTModel irtModel;
+EloRatings eloRatings;
+PolicyRegistry policies;
+Experiment experiment;
+StoppingRule stoppingRule;
+ExposureControl exposureControl;
+AnswerLog answerLog;
+Metrics metrics;
+BucketInventory bucketInventory;
 
-void setupCORS(crow::App<crow::CORSHandler>& app) {
+// Requests without an explicit session share this one, which keeps the
+// single-user frontend working unchanged.
+const std::string kDefaultSessionId = "QuizUser";
+
+/**
+ * @brief Picks the session id from the X-Session-Id header or ?session= parameter.
+ */
+std::string sessionIdFor(const crow::request& req) {
+    const std::string& header = req.get_header_value("X-Session-Id");
+    if (!header.empty()) return header;
+    const char* param = req.url_params.get("session");
+    return (param != nullptr && *param != '\0') ? std::string(param) : kDefaultSessionId;
+}
+
+// --- Stateless session tokens ---
+std::unique_ptr<SessionTokenCodec> tokenCodec; // Only set in --session-mode=stateless
+
+/**
+ * @brief A random, non-zero key for a new stateless session.
+ */
+uint64_t newSessionKey() {
+    static thread_local std::mt19937_64 rng(std::random_device{}());
+    uint64_t key;
+    do {
+        key = rng();
+    } while (key == 0);
+    return key;
+}
+
+/**
+ * @brief Identifies the learner behind a request: the session id in server
+ * mode, the token's random session key in stateless mode (where every
+ * token carries the default username).
+ */
+std::string learnerIdFor(const crow::request& req, const UserStats& user) {
+    if (!tokenCodec) return sessionIdFor(req);
+    char key[24];
+    std::snprintf(key, sizeof(key), "key-%016llx", static_cast<unsigned long long>(user.getSessionKey()));
+    return key;
+}
+
+/**
+ * @brief The session's experiment arm, or -1. Sessions pinned to a policy
+ * with /start_quiz?policy= stay out of the experiment, and so does the
+ * shared default session of server mode, which is not one learner.
+ */
+int experimentArmFor(const crow::request& req, const UserStats& user) {
+    if (!experiment.isActive() || !user.getSelectionPolicy().empty()) return -1;
+    std::string learner = learnerIdFor(req, user);
+    if (!tokenCodec && learner == kDefaultSessionId) return -1;
+    return experiment.assign(learner);
+}
+
+// --- Checkpointing ---
+// Payload: [version][saved-at stamp][bank size][bank fingerprint][question stats]
+//          [session count][(name, UserStats blob)...][Elo item ratings]
+// The ratings were added later; checkpoints that end before them are still accepted.
+// Version 2 added the stamp (see SessionStore::restore); version 1 payloads read as stamp 0.
+// Version 3 added the bank identity. The question stats, Elo ratings and the
+// sessions' used questions and reviews are stored by question id, so they are
+// only restored if the bank matches (older versions cannot show that it does).
+const uint8_t kCheckpointPayloadVersion = 3;
+
+std::string buildCheckpoint() {
+    // Copy-on-snapshot: each session lock is held only while that session
+    // is copied, never for serialization or disk I/O. Hibernated sessions
+    // are already durable in the cold tier.
+    std::vector<UserStats> sessions;
+    uint64_t savedAt = 0;
+    if (sessionStore) {
+        sessions = sessionStore->snapshotHot(savedAt);
+    }
+
+    ByteWriter out;
+    out.putU8(kCheckpointPayloadVersion);
+    out.putVarint(savedAt);
+    out.putVarint(questionBank.size());
+    out.putU64(questionBank.getFingerprint());
+    questionStats.serialize(out);
+    out.putVarint(sessions.size());
+    for (const UserStats& stats : sessions) {
+        out.putString(stats.getUsername());
+        ByteWriter blob;
+        stats.serialize(blob);
+        out.putString(blob.data());
+    }
+    eloRatings.serialize(out);
+    return out.release();
+}
+
+void restoreCheckpoint(const std::string& payload) {
+    try {
+        ByteReader in(payload);
+        uint8_t version = in.getU8();
+        if (version < 1 || version > kCheckpointPayloadVersion) {
+            std::cerr << "Checkpoint: unknown payload version, starting fresh." << std::endl;
+            return;
+        }
+        uint64_t savedAt = version >= 2 ? in.getVarint() : 0;
+        bool sameBank = false;
+        if (version >= 3) {
+            uint64_t size = in.getVarint();
+            uint64_t fingerprint = in.getU64();
+            sameBank = size == questionBank.size() && fingerprint == questionBank.getFingerprint();
+        }
+        if (!sameBank) {
+            std::cerr << "Checkpoint: saved against a different (or unrecorded) question bank;"
+                      << " keeping sessions' topic progress but dropping per-question state." << std::endl;
+        }
+
+        if (sameBank) {
+            questionStats.restore(in);
+        } else {
+            QuestionStats discarded; // Sized 0, so it only reads past the section
+            discarded.restore(in);
+        }
+        uint64_t sessions = in.getVarint();
+        for (uint64_t i = 0; i < sessions; ++i) {
+            std::string name = in.getString();
+            std::string blob = in.getString();
+            if (sessionStore) {
+                ByteReader blobReader(blob);
+                UserStats stats(name);
+                stats.restore(blobReader, questionBank);
+                if (!sameBank) stats.forgetQuestions();
+                sessionStore->restore(name, stats, savedAt);
+            }
+        }
+        if (!in.atEnd() && sameBank) {
+            eloRatings.restore(in);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Checkpoint: could not restore state (" << e.what() << "), starting fresh." << std::endl;
+    }
+}
+
+/**
+ * @brief Serializes a handler's JSON body into the response.
+ */
+crow::response respond(int status, const json& body) {
+    std::string payload;
+    {
+        TraceSpan span("serialize");
+        payload = body.dump();
+    }
+    // Only constructs the crow::response. Crow writes it to the socket
+    // after the handler returns, outside every span.
+    TraceSpan span("build_response");
+    return crow::response(status, std::move(payload));
+}
+
+/**
+ * @brief Runs a handler against the caller's session and builds the response.
+ *
+ * In the default "server" mode the session comes from the SessionStore
+ * (see sessionIdFor) and is locked for the duration of the handler. In "stateless" mode it is decoded from the
+ * X-Session-Token request header (a fresh session if the header is absent),
+ * and the updated token is returned in the "sessionToken" response field.
+ *
+ * @param handler Called as handler(UserStats&, json& body); returns the HTTP status.
+ */
+template <typename Handler>
+crow::response withSession(const crow::request& req, Handler handler) {
+    json body;
+
+    if (!tokenCodec) {
+        std::shared_ptr<Session> session;
+        {
+            TraceSpan span("session");
+            session = sessionStore->acquire(sessionIdFor(req));
+        }
+        std::lock_guard<std::mutex> lock(session->mutex);
+        int status = handler(session->stats, body);
+        return respond(status, body);
+    }
+
+    UserStats session(kDefaultSessionId);
+    const std::string& token = req.get_header_value("X-Session-Token");
+    {
+        TraceSpan span("parse");
+        if (!token.empty() && !tokenCodec->decode(token, session, questionBank)) {
+            body["error"] = "Invalid, expired or tampered session token.";
+            return crow::response(401, body.dump());
+        }
+    }
+    if (session.getSessionKey() == 0) {
+        session.setSessionKey(newSessionKey()); // New session
+    }
+
+    int status = handler(session, body);
+
+    bool truncated = false;
+    {
+        TraceSpan span("serialize");
+        body["sessionToken"] = tokenCodec->encode(session, questionBank, &truncated);
+    }
+    if (truncated) {
+        LOG_WARN("SERVER LOG: session token over " << tokenCodec->getBudget()
+                 << " byte budget; used-question set dropped.");
+    }
+    return respond(status, body);
+}
+
+/**
+ * @brief Sets TCP_NODELAY on the socket listening on 'port'; Linux copies
+ * it to every connection accepted afterwards. Crow never sets it, and it
+ * sends a response in more than one write, so Nagle holds the tail until
+ * the client's delayed ACK: about 40 ms per request on a kept-alive
+ * connection. Crow keeps its acceptor private, so the socket is found by
+ * scanning the process's descriptors for a listener bound to the port.
+ * @return Number of sockets changed; 0 where the scan is not supported.
+ */
+int enableNoDelayOnListener(int port) {
+    int changed = 0;
+#ifndef _WIN32
+    long maxFd = sysconf(_SC_OPEN_MAX);
+    if (maxFd < 0 || maxFd > 65536) maxFd = 65536;
+    for (int fd = 0; fd < maxFd; ++fd) {
+        sockaddr_storage addr{};
+        socklen_t addrLen = sizeof(addr);
+        if (getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &addrLen) != 0) continue;
+
+        int boundPort = -1;
+        if (addr.ss_family == AF_INET) {
+            boundPort = ntohs(reinterpret_cast<sockaddr_in*>(&addr)->sin_port);
+        } else if (addr.ss_family == AF_INET6) {
+            boundPort = ntohs(reinterpret_cast<sockaddr_in6*>(&addr)->sin6_port);
+        }
+        int listening = 0;
+        socklen_t optLen = sizeof(listening);
+        if (boundPort != port ||
+            getsockopt(fd, SOL_SOCKET, SO_ACCEPTCONN, &listening, &optLen) != 0 || !listening) {
+            continue;
+        }
+        int on = 1;
+        if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on)) == 0) {
+            changed++;
+        }
+    }
+#endif
+    return changed;
+}
+
+void setupCORS(crow::App<crow::CORSHandler, ConnectionTracker>& app) {
     app.get_middleware<crow::CORSHandler>()
         .global()
         .methods("POST"_method, "GET"_method)
-        .headers("Content-Type", "Authorization");
+        .headers("Content-Type", "Authorization", "X-Session-Token", "X-Session-Id", "X-Selection-Policy");
 }
 
 
-int main() {
+int main(int argc, char* argv[]) {
+    config.parseArgs(argc, argv);
+
     try {
-        questionBank.loadFromFile("questions.txt");
+        questionBank.loadFromFile(config.questionFile);
     } catch (const std::exception& e) {
-        std::cerr << "FATAL ERROR loading questions.txt: " << e.what() << std::endl;
+        std::cerr << "FATAL ERROR loading " << config.questionFile << ": " << e.what() << std::endl;
         return 1;
     }
+    if (!config.overlayFile.empty() && questionBank.applyOverlay(config.overlayFile) < 0) {
+        std::cout << "No calibration overlay (" << config.overlayFile << "); using authored difficulties." << std::endl;
+    }
+    questionBank.setDifficultyBand(config.difficultyBand);
+    questionBank.setMetrics(&metrics);
+    bucketInventory.configure(questionBank);
+    questionBank.setBucketInventory(&bucketInventory);
+    exposureControl.configure(questionBank.size(), config.exposureCeiling,
+                              static_cast<uint64_t>(config.exposureWarmupQuizzes), config.exposureWindowQuizzes);
+    if (exposureControl.isEnabled()) {
+        questionBank.setExposureControl(&exposureControl);
+        exposureControl.startAggregator(std::chrono::milliseconds(config.exposureRefreshMillis));
+        std::cout << "Exposure control: no item in more than " << config.exposureCeiling * 100.0 << "% of quizzes." << std::endl;
+    }
+    questionStats.resize(questionBank.size());
+    irtModel.initFromBank(questionBank);
+    eloRatings.initFromBank(questionBank);
+    eloRatings.startRebuilder();
+
+    // Every policy is available per session; --selection picks the default.
+    TopicTrend::configure(config.recentWindow, config.decayHalfLife);
+    policies.add(new WeakestTopicPolicy(questionBank));
+    policies.add(new WeakestTopicPolicy(questionBank, TopicScore::Decayed));
+    policies.add(new WeakestTopicPolicy(questionBank, TopicScore::Recent));
+    policies.add(new RandomTopicPolicy(questionBank));
+    policies.add(new BKTPolicy(questionBank, bktModel));
+    policies.add(new BanditPolicy(questionBank));
+    policies.add(new IRTPolicy(questionBank, irtModel));
+    policies.add(new EloPolicy(questionBank, eloRatings, config.eloTargetSuccess));
+    if (!policies.setDefault(config.selectionMode)) {
+        std::cerr << "Unknown --selection=" << config.selectionMode << "; using 'weakest'." << std::endl;
+    }
+    if (!config.experimentArms.empty() && experiment.configure(config.experimentName, config.experimentArms, policies)) {
+        std::cout << "Experiment '" << config.experimentName << "' running: " << config.experimentArms << std::endl;
+    }
+
+    if (stoppingRule.configure(config.stopRule, config.stopStandardError, config.stopMinQuestions,
+                               config.stopMaxQuestions) && stoppingRule.isEnabled()) {
+        std::cout << "Quizzes end adaptively (--stop-rule=" << config.stopRule << ")." << std::endl;
+    }
+
+    // Per-topic BKT parameters are optional; defaults apply to unlisted topics.
+    if (!bktModel.loadFromFile(config.bktParamsFile)) {
+        std::cout << "No BKT parameter file (" << config.bktParamsFile << "); using defaults." << std::endl;
+    }
+    if (!config.answerLogFile.empty()) {
+        answerLog.open(config.answerLogFile);
+    }
     
     srand(static_cast<unsigned int>(time(0)));
 
-    crow::App<crow::CORSHandler> app;
+    if (config.sessionMode == "stateless") {
+        if (config.tokenSecret.empty()) {
+            std::cerr << "FATAL ERROR: stateless mode needs --token-secret or QUIZ_TOKEN_SECRET." << std::endl;
+            return 1;
+        }
+        tokenCodec.reset(new SessionTokenCodec(config.tokenSecret, config.tokenBudgetBytes, config.tokenMaxAgeSeconds));
+        std::cout << "Session mode: stateless (signed tokens, " << config.tokenBudgetBytes << " byte budget, "
+                  << config.tokenMaxAgeSeconds << " s max age)" << std::endl;
+    } else {
+        sessionStore.reset(new SessionStore(questionBank, config.coldSessionDir,
+                                            std::chrono::seconds(config.sessionIdleSeconds)));
+        if (config.sessionSweepSeconds > 0) {
+            sessionStore->startSweeper(std::chrono::seconds(config.sessionSweepSeconds));
+        }
+    }
+
+    // Checkpoints only cover server-side sessions; in stateless mode they
+    // still preserve the global question statistics.
+    CheckpointManager checkpoints(config.checkpointPath, config.checkpointBytesPerSecond);
+    if (config.checkpointIntervalSeconds > 0) {
+        std::string payload;
+        if (checkpoints.loadLatest(payload)) {
+            restoreCheckpoint(payload);
+        }
+        checkpoints.start(std::chrono::seconds(config.checkpointIntervalSeconds), buildCheckpoint, []() {
+            if (sessionStore) {
+                sessionStore->checkpointCommitted();
+            }
+        });
+    }
+
+    crow::App<crow::CORSHandler, ConnectionTracker> app;
     setupCORS(app);
 
     // --- API Endpoints (Our Server's URLs) ---
 
+    /**
+     * @brief API: /start_quiz
+     * Optional ?policy=<name> (or X-Selection-Policy header) pins this
+     * session to a selection policy; "default" returns it to the deployment default.
+     */
     CROW_ROUTE(app, "/start_quiz")
-    ([](){
-        std::cout << "SERVER LOG: /start_quiz called. Resetting session." << std::endl;
-        user.resetSession();
-        
-        json response;
-        response["message"] = "New quiz session started. User stats reset.";
-        return crow::response(200, response.dump());
+    ([](const crow::request& req){
+        Metrics::ScopedTimer timer(metrics, Metrics::StartQuiz);
+        TraceSpan requestSpan("/start_quiz");
+        LOG_REQUEST("SERVER LOG: /start_quiz called. Resetting session.");
+        std::string requestedPolicy = req.get_header_value("X-Selection-Policy");
+        if (const char* param = req.url_params.get("policy")) {
+            requestedPolicy = param;
+        }
+        if (!requestedPolicy.empty() && requestedPolicy != "default" && policies.find(requestedPolicy) == nullptr) {
+            json error;
+            error["error"] = "Unknown selection policy: " + requestedPolicy;
+            error["policies"] = policies.getNames();
+            return crow::response(400, error.dump());
+        }
+
+        return withSession(req, [&requestedPolicy, &req](UserStats& user, json& response) {
+            user.resetSession();
+            if (!requestedPolicy.empty()) {
+                user.setSelectionPolicy(requestedPolicy == "default" ? "" : requestedPolicy);
+            }
+            response["message"] = "New quiz session started. User stats reset.";
+            exposureControl.recordQuizStart();
+            metrics.increment(Metrics::QuizzesStarted);
+
+            int arm = experimentArmFor(req, user);
+            if (arm >= 0) {
+                experiment.recordStart(arm);
+                response["experimentArm"] = arm;
+                response["selectionPolicy"] = experiment.getPolicy(arm)->getName();
+            } else {
+                response["selectionPolicy"] = policies.resolve(user.getSelectionPolicy())->getName();
+            }
+            return 200;
+        });
     });
 
 
@@ -52,87 +449,380 @@ int main() {
      * --- THIS IS THE MODIFIED ROUTE ---
      */
     CROW_ROUTE(app, "/get_question")
-    ([](){
-        std::string topic;
-        
-        // --- NEW LOGIC ---
-        // Check if we have enough data (e.g., 3+ attempts in one topic) to be adaptive.
-        // If not, we stay in "Random Mode".
-        if (user.hasSufficientData(3)) { 
-            topic = user.getWeakestTopic();
-            std::cout << "SERVER LOG: [ADAPTIVE MODE] Targeting weakest topic: " << topic << std::endl;
-        } else {
-            topic = questionBank.getRandomTopic();
-            std::cout << "SERVER LOG: [RANDOM MODE] Picking random topic: " << topic << std::endl;
-        }
-        // --- END OF NEW LOGIC ---
+    ([](const crow::request& req){
+        Metrics::ScopedTimer timer(metrics, Metrics::GetQuestion);
+        TraceSpan requestSpan("/get_question");
+        return withSession(req, [&req](UserStats& user, json& q_json) {
+            // A quiz the stopping rule has ended serves nothing more until /start_quiz.
+            StoppingRule::Reason stop = stoppingRule.check(user, questionBank.getTopics().size());
+            if (stop != StoppingRule::Continue) {
+                q_json["quizComplete"] = true;
+                q_json["stopReason"] = StoppingRule::reasonName(stop);
+                return 200;
+            }
 
-        int difficulty = user.getNextDifficulty();
-        std::vector<Question*>& usedQuestions = user.getUsedQuestions();
-        Question* q = questionBank.getQuestion(topic, difficulty, usedQuestions);
+            int arm = experimentArmFor(req, user);
+            SelectionPolicy* policy = arm >= 0 ? experiment.getPolicy(arm) : policies.resolve(user.getSelectionPolicy());
+            uint64_t selectionNanos = 0;
+            Question* q;
+            {
+                TraceSpan span("select");
+                q = policy->select(user, &selectionNanos);
+            }
+            if (arm >= 0) {
+                experiment.recordSelection(arm, selectionNanos, q != nullptr);
+            }
 
-        if (q == nullptr) {
-            json errorResponse;
-            errorResponse["error"] = "No more questions available!";
-            return crow::response(404, errorResponse.dump());
-        }
+            if (q == nullptr) {
+                metrics.increment(Metrics::NoQuestionAvailable);
+                q_json["error"] = "No more questions available!";
+                return 404;
+            }
 
-        user.setLastQuestion(q);
+            user.setLastQuestion(q);
+            questionStats.recordServed(q->getId());
+            exposureControl.recordAdministered(q->getId());
+            metrics.increment(Metrics::QuestionsServed);
 
-        json q_json;
-        q_json["questionText"] = q->getQuestionText();
-        q_json["topic"] = q->getTopic();
-        q_json["difficulty"] = q->getDifficulty();
-        q_json["type"] = q->getQuestionType(); 
-        q_json["options"] = q->getOptions();   
+            q_json["questionText"] = q->getQuestionText();
+            q_json["topic"] = q->getTopic();
+            q_json["difficulty"] = q->getDifficulty();
+            q_json["type"] = q->getQuestionType(); 
+            q_json["options"] = q->getOptions();   
         
-        std::cout << "SERVER LOG: Sending: " << q->getQuestionText() << std::endl;
+            LOG_REQUEST("SERVER LOG: Sending: " << q->getQuestionText());
 
-        return crow::response(200, q_json.dump());
+            return 200;
+        });
     });
 
 
     CROW_ROUTE(app, "/submit_answer").methods("POST"_method)
     ([](const crow::request& req){
-        json requestBody = json::parse(req.body);
+        Metrics::ScopedTimer timer(metrics, Metrics::SubmitAnswer);
+        TraceSpan requestSpan("/submit_answer");
+        json requestBody;
+        {
+            TraceSpan span("parse");
+            requestBody = json::parse(req.body);
+        }
         if (!requestBody.contains("answer")) {
+            metrics.increment(Metrics::AnswersRejected);
             return crow::response(400, "{\"error\":\"Missing 'answer' in request body\"}");
         }
         std::string userAnswer = requestBody["answer"];
 
-        Question* lastQ = user.getLastQuestion();
-        if (lastQ == nullptr) {
-            return crow::response(400, "{\"error\":\"No question has been asked yet. Call /get_question first.\"}");
-        }
+        return withSession(req, [&userAnswer, &req](UserStats& user, json& responseBody) {
+            Question* lastQ = user.getLastQuestion();
+            if (lastQ == nullptr) {
+                metrics.increment(Metrics::AnswersRejected);
+                responseBody["error"] = "No question has been asked yet. Call /get_question first.";
+                return 400;
+            }
+
+            bool isCorrect;
+            {
+                TraceSpan span("grade");
+                isCorrect = lastQ->checkAnswer(userAnswer);
+            }
+            metrics.increment(isCorrect ? Metrics::AnswersCorrect : Metrics::AnswersIncorrect);
+
+            const std::string& topic = lastQ->getTopic();
+            double masteryBefore = user.getMastery(topic, bktModel);
+            bool quizWasRunning = stoppingRule.check(user, questionBank.getTopics().size()) == StoppingRule::Continue;
+
+            {
+                TraceSpan span("stats");
+                user.updateStats(lastQ->getTopic(), isCorrect);
+                user.updateMastery(lastQ->getTopic(), isCorrect, bktModel);
+                user.updateBandit(questionBank.getTopicIndex(lastQ->getTopic()), isCorrect);
+                user.updateAbility(irtModel.getParams(lastQ->getId()), isCorrect);
+                user.updateRating(eloRatings.recordAnswer(lastQ->getId(), user.getRating(), isCorrect), isCorrect);
+                questionStats.recordAnswer(lastQ->getId(), isCorrect);
+                answerLog.append(learnerIdFor(req, user), lastQ->getId(), lastQ->getTopic(), isCorrect);
+                user.adjustDifficulty(isCorrect, config.difficultyStep);
+                if (config.spacedRepetition) {
+                    user.getReviews().recordAnswer(lastQ->getId(), isCorrect, ReviewScheduler::nowMinutes());
+                }
+            }
 
-        bool isCorrect = lastQ->checkAnswer(userAnswer);
+            int arm = experimentArmFor(req, user);
+            if (arm >= 0) {
+                bool reachedMastery = masteryBefore < BKTModel::kMasteryThreshold &&
+                                      user.getMastery(topic, bktModel) >= BKTModel::kMasteryThreshold;
+                experiment.recordAnswer(arm, user.getExperimentCounts(), isCorrect, reachedMastery ? user.getAttempts(topic) : -1);
+            }
 
-        user.updateStats(lastQ->getTopic(), isCorrect);
-        user.adjustDifficulty(isCorrect); 
+            responseBody["isCorrect"] = isCorrect;
+            responseBody["correctAnswerString"] = lastQ->getCorrectAnswerString();
 
-        json responseBody;
-        responseBody["isCorrect"] = isCorrect;
-        responseBody["correctAnswerString"] = lastQ->getCorrectAnswerString();
+            // Tell the client now, so it can skip the /get_question round trip.
+            StoppingRule::Reason stop = stoppingRule.check(user, questionBank.getTopics().size());
+            if (stop != StoppingRule::Continue) {
+                if (quizWasRunning) stoppingRule.recordStop(stop, user.getQuizAnswers());
+                responseBody["quizComplete"] = true;
+                responseBody["stopReason"] = StoppingRule::reasonName(stop);
+            }
 
-        std::cout << "SERVER LOG: /submit_answer called. User answered '" << userAnswer << "'. Correct: " << (isCorrect ? "yes" : "no") << std::endl;
+            LOG_REQUEST("SERVER LOG: /submit_answer called. User answered '" << userAnswer << "'. Correct: " << (isCorrect ? "yes" : "no"));
 
-        return crow::response(200, responseBody.dump());
+            return 200;
+        });
     });
 
 
     CROW_ROUTE(app, "/get_stats")
+    ([](const crow::request& req){
+        Metrics::ScopedTimer timer(metrics, Metrics::GetStats);
+        TraceSpan requestSpan("/get_stats");
+        LOG_REQUEST("SERVER LOG: /get_stats requested.");
+        return withSession(req, [](UserStats& user, json& stats) {
+            stats = user.getStatsJson();
+            return 200;
+        });
+    });
+
+
+    /**
+     * @brief API: /session_store_stats
+     * Hot/cold hit rates and rehydration latency of the session store.
+     */
+    CROW_ROUTE(app, "/session_store_stats")
+    ([](){
+        if (!sessionStore) {
+            return crow::response(404, "{\"error\":\"Session store is disabled in stateless mode.\"}");
+        }
+        return crow::response(200, sessionStore->getStatsJson().dump());
+    });
+
+
+    /**
+     * @brief API: /selection_policy
+     * GET: per-policy call counts and latency.
+     * POST {"default": "<name>"}: switches the deployment default at runtime.
+     * Operator only: needs the X-Admin-Secret header to match --admin-secret
+     * (switching is off without one). Browsers cannot send the header from
+     * another origin because setupCORS does not allow it.
+     */
+    CROW_ROUTE(app, "/selection_policy").methods("GET"_method, "POST"_method)
+    ([](const crow::request& req){
+        if (req.method == "GET"_method) {
+            if (req.url_params.get("default")) {
+                return crow::response(405, "{\"error\":\"Changing the default policy needs POST /selection_policy with X-Admin-Secret\"}");
+            }
+            return crow::response(200, policies.getStatsJson().dump());
+        }
+
+        if (config.adminSecret.empty()) {
+            return crow::response(403, "{\"error\":\"Runtime policy changes are disabled; start the server with --admin-secret\"}");
+        }
+        if (!constantTimeEquals(req.get_header_value("X-Admin-Secret"), config.adminSecret)) {
+            LOG_WARN("SERVER LOG: /selection_policy change refused from " << req.remote_ip_address);
+            return crow::response(403, "{\"error\":\"Missing or wrong X-Admin-Secret\"}");
+        }
+        json requestBody = json::parse(req.body, nullptr, false);
+        if (!requestBody.is_object() || !requestBody.contains("default") || !requestBody["default"].is_string()) {
+            json error;
+            error["error"] = "Expected a JSON body {\"default\": \"<policy name>\"}";
+            error["policies"] = policies.getNames();
+            return crow::response(400, error.dump());
+        }
+        std::string name = requestBody["default"];
+        if (!policies.setDefault(name)) {
+            json error;
+            error["error"] = "Unknown selection policy: " + name;
+            error["policies"] = policies.getNames();
+            return crow::response(400, error.dump());
+        }
+        LOG_INFO("SERVER LOG: Default selection policy is now " << name << " (set by " << req.remote_ip_address << ")");
+        return crow::response(200, policies.getStatsJson().dump());
+    });
+
+
+    /**
+     * @brief API: /stopping_rule
+     * The CAT stopping configuration, quizzes ended per reason and their mean length.
+     */
+    CROW_ROUTE(app, "/stopping_rule")
     ([](){
-        std::cout << "SERVER LOG: /get_stats requested." << std::endl;
-        json stats = user.getStatsJson();
-        return crow::response(200, stats.dump());
+        return crow::response(200, stoppingRule.getStatsJson().dump());
+    });
+
+
+    /**
+     * @brief API: /exposure_stats
+     * Exposure ceiling, most exposed items and how many are being throttled.
+     */
+    CROW_ROUTE(app, "/exposure_stats")
+    ([](){
+        return crow::response(200, exposureControl.getStatsJson().dump());
+    });
+
+
+    /**
+     * @brief API: /experiment_report
+     * Per-arm accuracy, answers to mastery and selection latency.
+     */
+    CROW_ROUTE(app, "/experiment_report")
+    ([](){
+        return crow::response(200, experiment.getReportJson().dump());
+    });
+
+
+    /**
+     * @brief API: /metrics
+     * Route latency histograms, selection fallbacks, grading outcomes and
+     * active sessions in the Prometheus text exposition format.
+     */
+    CROW_ROUTE(app, "/metrics")
+    ([](){
+        std::string text = metrics.renderText();
+        if (sessionStore) {
+            Metrics::appendGauge(text, "quiz_sessions_active", "Sessions held in memory (hot tier).",
+                                 static_cast<double>(sessionStore->hotCount()));
+        }
+        crow::response res(200, text);
+        res.set_header("Content-Type", "text/plain; version=0.0.4");
+        return res;
+    });
+
+
+    /**
+     * @brief API: /inventory_risk
+     * (topic, difficulty) buckets learners are running out of. Optional:
+     * ?low=<unseen questions counted as low, default 2>, ?rate=<risk share,
+     * default 0.25>, ?min=<selections before the fallback rate counts,
+     * default 20>, ?all=1 to list every bucket.
+     */
+    CROW_ROUTE(app, "/inventory_risk")
+    ([](const crow::request& req){
+        const char* low = req.url_params.get("low");
+        const char* rate = req.url_params.get("rate");
+        const char* min = req.url_params.get("min");
+        const char* all = req.url_params.get("all");
+
+        BucketInventory::Scan scan = bucketInventory.beginScan(low ? std::strtoull(low, nullptr, 10) : 2);
+        if (sessionStore) {
+            sessionStore->forEachHot([&scan](const UserStats& user) {
+                bucketInventory.addSession(scan, user.getUsedMask());
+            });
+        }
+        json report = bucketInventory.getReportJson(scan, rate ? std::atof(rate) : 0.25,
+                                                    min ? std::strtoull(min, nullptr, 10) : 20,
+                                                    all != nullptr && std::string(all) == "1");
+        return crow::response(200, report.dump());
+    });
+
+
+    /**
+     * @brief API: /trace_dump
+     * Writes the buffered tracing spans to --trace-file as Chrome trace
+     * JSON. ?clear=1 starts a fresh trace afterwards. Tracing must be
+     * compiled in (-DQUIZ_TRACING=1).
+     */
+    CROW_ROUTE(app, "/trace_dump")
+    ([](const crow::request& req){
+        json result;
+        result["enabled"] = Tracer::kEnabled;
+        if (!Tracer::kEnabled) {
+            result["error"] = "Tracing is compiled out; rebuild with -DQUIZ_TRACING=1.";
+            return crow::response(404, result.dump());
+        }
+        long spans = Tracer::writeChromeTrace(config.traceFile);
+        if (spans < 0) {
+            result["error"] = "Could not write " + config.traceFile;
+            return crow::response(500, result.dump());
+        }
+        const char* clear = req.url_params.get("clear");
+        if (clear != nullptr && std::string(clear) == "1") {
+            Tracer::clear();
+        }
+        result["file"] = config.traceFile;
+        result["spans"] = spans;
+        return crow::response(200, result.dump());
+    });
+
+
+    /**
+     * @brief API: /memory_stats
+     * Bytes held by each subsystem, counted from the containers themselves:
+     * the question bank, sessions, model caches, instrumentation and the
+     * Crow buffers of requests in flight.
+     */
+    CROW_ROUTE(app, "/memory_stats")
+    ([&app](){
+        json result;
+
+        QuestionBank::MemoryBreakdown bank = questionBank.memoryUsage();
+        result["questionBank"] = {{"objects", bank.objects}, {"text", bank.text}, {"answers", bank.answers},
+                                  {"indexes", bank.indexes}, {"total", bank.total()}};
+
+        size_t sessionsTotal = 0;
+        if (sessionStore) {
+            SessionStore::MemoryBreakdown sessions = sessionStore->memoryUsage();
+            sessionsTotal = sessions.sessions + sessions.store;
+            result["sessions"] = {{"hot", sessions.hotSessions}, {"sessionBytes", sessions.sessions},
+                                  {"storeBytes", sessions.store},
+                                  {"meanPerSession", sessions.hotSessions > 0 ? sessions.sessions / sessions.hotSessions : 0},
+                                  {"total", sessionsTotal}};
+        } else {
+            // Stateless sessions live in the client's token between requests.
+            result["sessions"] = {{"hot", 0}, {"total", 0}};
+        }
+
+        size_t irt = irtModel.memoryUsage();
+        size_t elo = eloRatings.memoryUsage();
+        size_t stats = questionStats.memoryUsage();
+        size_t exposure = exposureControl.memoryUsage();
+        size_t inventory = bucketInventory.memoryUsage();
+        size_t cachesTotal = irt + elo + stats + exposure + inventory;
+        result["caches"] = {{"irt", irt}, {"elo", elo}, {"questionStats", stats}, {"exposureControl", exposure},
+                            {"bucketInventory", inventory}, {"total", cachesTotal}};
+
+        size_t metricBytes = metrics.memoryUsage();
+        size_t loggerBytes = Logger::memoryUsage();
+        size_t tracerBytes = Tracer::memoryUsage();
+        size_t instrumentationTotal = metricBytes + loggerBytes + tracerBytes;
+        result["instrumentation"] = {{"metrics", metricBytes}, {"logger", loggerBytes}, {"tracer", tracerBytes},
+                                     {"total", instrumentationTotal}};
+
+        json connections = app.get_middleware<ConnectionTracker>().getStatsJson();
+        connections["note"] = "Covers connections serving a request; idle keep-alive connections are not visible.";
+        result["connections"] = connections;
+
+        result["total"] = bank.total() + sessionsTotal + cachesTotal + instrumentationTotal +
+                          connections["bytesInFlight"].get<int64_t>();
+        return crow::response(200, result.dump());
     });
 
 
     // --- Run the server ---
-    std::cout << "Crow server is running on port 18080..." << std::endl;
-    app.port(18080)
-       .multithreaded()
-       .run();
+    std::cout << "Crow server is running on port " << config.port << "..." << std::endl;
+    // Request-path logging goes through per-thread rings from here on.
+    Logger::start(Logger::parseLevel(config.logLevel), config.logRequestRate, config.logFile);
+    auto server = app.port(config.port)
+                     .multithreaded()
+                     .run_async();
+    // A connection accepted before this point keeps Nagle on; at startup
+    // there is none in practice.
+    if (app.wait_for_server_start() == std::cv_status::no_timeout) {
+#ifndef _WIN32
+        if (enableNoDelayOnListener(config.port) == 0) {
+            std::cerr << "SERVER LOG: could not set TCP_NODELAY on port " << config.port
+                      << "; keep-alive responses may be delayed." << std::endl;
+        }
+#endif
+    }
+    server.get();
 
+    // Crow returns from run() on shutdown; stop() writes one final checkpoint.
+    if (sessionStore) {
+        sessionStore->stopSweeper();
+    }
+    exposureControl.stopAggregator();
+    eloRatings.stopRebuilder();
+    checkpoints.stop();
+    answerLog.flush();
+    Logger::stop();
     return 0;
 }
\ No newline at end of file
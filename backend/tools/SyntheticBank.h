@@ -0,0 +1,254 @@
+#ifndef SYNTHETIC_BANK_H
+#define SYNTHETIC_BANK_H
+
+#include "../Utils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @file SyntheticBank.h
+ * @brief Writes question banks of any size in the questions.txt format
+ * (and optionally a matching calibration overlay), for the benchmark,
+ * load and simulation tools.
+ *
+ * Output depends only on the options (including the seed), never on the
+ * standard library's random distributions, so the same options give the
+ * same file everywhere.
+ */
+
+/**
+ * @class SplitMix64
+ * @brief Small deterministic generator; std:: distributions differ between
+ * library implementations, so the tools draw from this instead.
+ */
+class SplitMix64 {
+    uint64_t state;
+
+public:
+    explicit SplitMix64(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in [0, bound); the modulo bias is negligible for small bounds.
+    uint64_t below(uint64_t bound) { return bound == 0 ? 0 : next() % bound; }
+
+    // Uniform in [0, 1).
+    double unit() { return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0); }
+
+    // Standard normal (Box-Muller).
+    double normal() {
+        double u = 1.0 - unit(); // (0, 1], keeps log() finite
+        return std::sqrt(-2.0 * std::log(u)) * std::cos(6.283185307179586 * unit());
+    }
+};
+
+struct SyntheticBankOptions {
+    enum DifficultyShape {
+        Uniform,  // Every level from 1 to 3 equally likely
+        Weighted, // Levels 1, 2, 3 in the ratio of levelWeights
+        Normal    // N(difficultyMean, difficultySpread), clamped to [1, 3]
+    };
+
+    uint64_t questions = 10000;
+    int topics = 20;
+    double topicSkew = 0.0; // Zipf exponent over topics; 0 spreads questions evenly
+    double typeWeights[3] = {2.0, 1.0, 1.0}; // MC : TF : FIB
+
+    DifficultyShape difficulty = Uniform;
+    double levelWeights[3] = {1.0, 1.0, 1.0};
+    double difficultyMean = 2.0;
+    double difficultySpread = 0.6;
+    double difficultyStep = 1.0; // Difficulties are multiples of this; 1 gives whole levels
+
+    int minWords = 8;    // Question text length, in words
+    int maxWords = 15;
+    int optionWords = 3; // Length of each multiple-choice option
+
+    uint64_t seed = 42;
+};
+
+/**
+ * @brief What writeSyntheticBank produced.
+ */
+struct SyntheticBankSummary {
+    uint64_t byType[3] = {0, 0, 0};   // MC, TF, FIB
+    uint64_t byLevel[3] = {0, 0, 0};  // Difficulty rounded to 1, 2, 3
+    uint64_t bytes = 0;
+};
+
+namespace synthetic {
+    inline std::string topicName(int index) { return "Topic " + std::to_string(index); }
+
+    // A pronounceable lowercase word of 2-4 syllables.
+    inline void appendWord(std::string& out, SplitMix64& rng) {
+        static const char* const kSyllables[] = {
+            "ka", "lo", "mi", "ne", "ru", "sa", "ti", "vo", "pe", "zu", "da", "fi", "go", "hu", "ja", "ber"
+        };
+        for (uint64_t s = 0, n = 2 + rng.below(3); s < n; ++s) {
+            out += kSyllables[rng.below(16)];
+        }
+    }
+
+    inline void appendSentence(std::string& out, SplitMix64& rng, int words) {
+        for (int w = 0; w < words; ++w) {
+            if (w > 0) out += ' ';
+            appendWord(out, rng);
+        }
+    }
+
+    // Index drawn with probability proportional to cumulative[i] - cumulative[i-1].
+    inline size_t drawCumulative(const std::vector<double>& cumulative, SplitMix64& rng) {
+        double target = rng.unit() * cumulative.back();
+        size_t i = std::upper_bound(cumulative.begin(), cumulative.end(), target) - cumulative.begin();
+        return std::min(i, cumulative.size() - 1);
+    }
+
+    inline std::vector<double> cumulativeOf(const double* weights, size_t n) {
+        std::vector<double> cumulative(n);
+        double sum = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += std::max(0.0, weights[i]);
+            cumulative[i] = sum;
+        }
+        if (sum <= 0.0) {
+            for (size_t i = 0; i < n; ++i) cumulative[i] = static_cast<double>(i + 1);
+        }
+        return cumulative;
+    }
+
+    inline double drawDifficulty(const SyntheticBankOptions& opts, const std::vector<double>& levels, SplitMix64& rng) {
+        double d;
+        switch (opts.difficulty) {
+            case SyntheticBankOptions::Weighted:
+                d = 1.0 + static_cast<double>(drawCumulative(levels, rng));
+                break;
+            case SyntheticBankOptions::Normal:
+                d = opts.difficultyMean + opts.difficultySpread * rng.normal();
+                break;
+            default:
+                d = 1.0 + static_cast<double>(rng.below(3));
+                break;
+        }
+        if (opts.difficultyStep > 0.0) d = std::round(d / opts.difficultyStep) * opts.difficultyStep;
+        return std::min(3.0, std::max(1.0, d));
+    }
+
+    inline void appendDifficulty(std::string& out, double d) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%g", std::round(d * 100.0) / 100.0);
+        out += buf;
+    }
+}
+
+/**
+ * @brief Writes opts.questions questions in the questions.txt format.
+ *
+ * Ids follow file order, as in QuestionBank::loadFromFile. If 'overlay'
+ * is given, it receives a calibration overlay for the bank (the format
+ * tools/calibrate writes): 2PL parameters with b consistent with each
+ * question's difficulty and a spread around 1. The overlay has its own
+ * random stream, so the bank is the same with or without it. Output is
+ * written in 1 MiB blocks, so banks of millions of questions stream
+ * straight to disk.
+ */
+inline SyntheticBankSummary writeSyntheticBank(std::ostream& out, const SyntheticBankOptions& opts,
+                                               std::ostream* overlay = nullptr) {
+    static const char* const kTypeNames[3] = {"MC", "TF", "FIB"};
+    const size_t kBlockBytes = 1 << 20;
+
+    SplitMix64 rng(opts.seed);
+    SplitMix64 overlayRng(opts.seed ^ 0x5DEECE66DULL);
+    int topics = std::max(1, opts.topics);
+    int minWords = std::max(1, opts.minWords);
+    int maxWords = std::max(minWords, opts.maxWords);
+
+    std::vector<double> topicCumulative;
+    if (opts.topicSkew > 0.0) {
+        std::vector<double> weights(topics);
+        for (int t = 0; t < topics; ++t) weights[t] = 1.0 / std::pow(t + 1.0, opts.topicSkew);
+        topicCumulative = synthetic::cumulativeOf(weights.data(), weights.size());
+    }
+    std::vector<double> typeCumulative = synthetic::cumulativeOf(opts.typeWeights, 3);
+    std::vector<double> levelCumulative = synthetic::cumulativeOf(opts.levelWeights, 3);
+
+    SyntheticBankSummary summary;
+    std::string block, overlayBlock;
+    block.reserve(kBlockBytes + 4096);
+    if (overlay != nullptr) {
+        *overlay << "# Synthetic calibration overlay (seed " << opts.seed << ")\n# id|textHash|difficulty|a|b\n";
+    }
+
+    std::string text;
+    for (uint64_t i = 0; i < opts.questions; ++i) {
+        int topic = topicCumulative.empty() ? static_cast<int>(i % topics)
+                                            : static_cast<int>(synthetic::drawCumulative(topicCumulative, rng));
+        size_t type = synthetic::drawCumulative(typeCumulative, rng);
+        double difficulty = synthetic::drawDifficulty(opts, levelCumulative, rng);
+
+        text.clear();
+        synthetic::appendSentence(text, rng, minWords + static_cast<int>(rng.below(maxWords - minWords + 1)));
+        text += type == 0 ? "?" : (type == 1 ? "." : " ____.");
+
+        block += kTypeNames[type];
+        block += '\n';
+        block += synthetic::topicName(topic);
+        block += '\n';
+        synthetic::appendDifficulty(block, difficulty);
+        block += '\n';
+        block += text;
+        block += '\n';
+        if (type == 0) {
+            for (char letter = 'A'; letter <= 'D'; ++letter) {
+                block += letter;
+                block += ". ";
+                synthetic::appendSentence(block, rng, std::max(1, opts.optionWords));
+                block += '\n';
+            }
+            block += static_cast<char>('A' + rng.below(4));
+        } else if (type == 1) {
+            block += rng.below(2) ? "true" : "false";
+        } else {
+            synthetic::appendWord(block, rng);
+        }
+        block += '\n';
+
+        summary.byType[type]++;
+        summary.byLevel[std::min(2, std::max(0, static_cast<int>(std::lround(difficulty)) - 1))]++;
+
+        if (overlay != nullptr) {
+            double a = 0.5 + 1.5 * overlayRng.unit();
+            double b = (difficulty - 2.0) + 0.25 * overlayRng.normal();
+            char line[96];
+            std::snprintf(line, sizeof(line), "%llu|%016llx|%.2f|%.4f|%.4f\n", static_cast<unsigned long long>(i),
+                          static_cast<unsigned long long>(fnv1a64(text)), difficulty, a, b);
+            overlayBlock += line;
+            if (overlayBlock.size() >= kBlockBytes) {
+                overlay->write(overlayBlock.data(), static_cast<std::streamsize>(overlayBlock.size()));
+                overlayBlock.clear();
+            }
+        }
+        if (block.size() >= kBlockBytes) {
+            out.write(block.data(), static_cast<std::streamsize>(block.size()));
+            summary.bytes += block.size();
+            block.clear();
+        }
+    }
+    out.write(block.data(), static_cast<std::streamsize>(block.size()));
+    summary.bytes += block.size();
+    if (overlay != nullptr) {
+        overlay->write(overlayBlock.data(), static_cast<std::streamsize>(overlayBlock.size()));
+    }
+    return summary;
+}
+
+#endif // SYNTHETIC_BANK_H
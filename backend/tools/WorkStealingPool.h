@@ -0,0 +1,111 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class WorkStealingPool
+ * @brief Runs a batch of independent tasks on a fixed set of threads, each
+ * with its own deque; a thread that runs dry steals from the others.
+ *
+ * Tasks are dealt round-robin up front. Each thread takes its own work
+ * from the back of its deque and steals from the front of a victim's, so
+ * owner and thief rarely touch the same end. When task costs vary a lot
+ * (a simulated learner may master a topic in ten answers or three
+ * hundred), stealing keeps every thread busy to the end. Each task
+ * receives the index of the thread running it, for lock-free per-thread
+ * accumulators.
+ */
+class WorkStealingPool {
+public:
+    using Task = std::function<void(int worker)>;
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    size_t nextWorker = 0;
+    std::atomic<size_t> remaining{0};
+    std::atomic<uint64_t> steals{0};
+
+    bool popOwn(int self, Task& task) {
+        Worker& w = *workers[self];
+        std::lock_guard<std::mutex> lock(w.mutex);
+        if (w.tasks.empty()) return false;
+        task = std::move(w.tasks.back());
+        w.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(int self, Task& task) {
+        size_t n = workers.size();
+        for (size_t k = 1; k < n; ++k) {
+            Worker& victim = *workers[(self + k) % n];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                steals.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void workerLoop(int self) {
+        Task task;
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            if (popOwn(self, task) || steal(self, task)) {
+                task(self);
+                remaining.fetch_sub(1, std::memory_order_acq_rel);
+            } else {
+                // Every deque is empty; the last tasks are still running elsewhere.
+                std::this_thread::yield();
+            }
+        }
+    }
+
+public:
+    explicit WorkStealingPool(int threads) {
+        for (int t = 0; t < (threads > 0 ? threads : 1); ++t) {
+            workers.emplace_back(new Worker());
+        }
+    }
+
+    int threadCount() const { return static_cast<int>(workers.size()); }
+
+    // Queues a task for the next run(). Not thread-safe with run().
+    void submit(Task task) {
+        workers[nextWorker++ % workers.size()]->tasks.push_back(std::move(task));
+        remaining.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Runs every queued task and returns when all have finished.
+     * The calling thread works as thread 0.
+     */
+    void run() {
+        std::vector<std::thread> threads;
+        for (int t = 1; t < threadCount(); ++t) {
+            threads.emplace_back([this, t]() { workerLoop(t); });
+        }
+        workerLoop(0);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    uint64_t stealCount() const { return steals.load(std::memory_order_relaxed); }
+};
+
+#endif // WORK_STEALING_POOL_H
@@ -0,0 +1,96 @@
+/**
+ * @file bandit_bench.cpp
+ * @brief Measures Thompson-sampling topic selection cost and checks the Beta sampler.
+ *
+ * Compares the xoshiro/Marsaglia-Tsang sampler against std::gamma_distribution
+ * on the same arms, for a learner with few answers per topic (every arm needs
+ * the gamma path) and one with many (most arms use the normal approximation).
+ *
+ * Build (from the backend folder):
+ *   g++ -std=c++17 -O2 -I. tools/bandit_bench.cpp ThompsonSampling.cpp -o bandit_bench
+ *
+ * Usage: bandit_bench [topics] [iterations]
+ */
+#include "../ThompsonSampling.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+    int stdThompsonArgmax(const std::vector<float>& alpha, const std::vector<float>& beta, std::mt19937_64& gen) {
+        int best = -1;
+        double bestSample = -1.0;
+        for (size_t i = 0; i < alpha.size(); ++i) {
+            std::gamma_distribution<double> gx(alpha[i], 1.0), gy(beta[i], 1.0);
+            double x = gx(gen);
+            double sample = x / (x + gy(gen));
+            if (sample > bestSample) {
+                bestSample = sample;
+                best = static_cast<int>(i);
+            }
+        }
+        return best;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t topics = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 200;
+
+    // --- Sampler sanity check: Beta moments at a small and a large count ---
+    FastRng rng(42);
+    for (auto params : {std::make_pair(2.0, 5.0), std::make_pair(0.5, 0.5), std::make_pair(300.0, 100.0)}) {
+        double a = params.first, b = params.second;
+        const int n = 200000;
+        double sum = 0, sq = 0;
+        for (int i = 0; i < n; ++i) {
+            double x = sampleBeta(a, b, rng);
+            sum += x;
+            sq += x * x;
+        }
+        double mean = sum / n, var = sq / n - mean * mean;
+        double expectMean = a / (a + b), expectVar = a * b / ((a + b) * (a + b) * (a + b + 1));
+        std::cout << "Beta(" << a << ", " << b << "): mean " << std::setprecision(4) << mean
+                  << " (expected " << expectMean << "), variance " << var
+                  << " (expected " << expectVar << ")" << std::endl;
+    }
+
+    std::cout << std::endl << std::left << std::setw(14) << "answers/topic"
+              << std::setw(20) << "fast us/selection"
+              << std::setw(20) << "std us/selection" << std::endl;
+
+    std::mt19937_64 gen(7);
+    volatile int sink = 0; // Keeps the loops from being optimized away
+    for (int answersPerTopic : {3, 1000}) {
+        std::vector<float> alpha(topics), beta(topics);
+        std::uniform_real_distribution<double> accuracy(0.3, 0.95);
+        for (size_t i = 0; i < topics; ++i) {
+            double correct = std::round(answersPerTopic * accuracy(gen));
+            alpha[i] = 1.0f + static_cast<float>(answersPerTopic - correct);
+            beta[i] = 1.0f + static_cast<float>(correct);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            sink = thompsonArgmax(alpha.data(), beta.data(), topics, rng);
+        }
+        auto mid = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            sink = stdThompsonArgmax(alpha, beta, gen);
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        double fastUs = std::chrono::duration<double, std::micro>(mid - start).count() / iterations;
+        double stdUs = std::chrono::duration<double, std::micro>(end - mid).count() / iterations;
+        std::cout << std::left << std::setw(14) << answersPerTopic
+                  << std::setw(20) << std::fixed << std::setprecision(1) << fastUs
+                  << std::setw(20) << stdUs << std::endl;
+    }
+
+    std::cout << "Topics: " << topics << " (last pick " << sink << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,253 @@
+/**
+ * @file bkt_fit.cpp
+ * @brief Fits per-topic BKT parameters from the server's answer log.
+ *
+ * Each (session, topic) pair in the log is one observation sequence, so the
+ * log must carry one id per learner. If a single id holds more than half of
+ * the answers (typically the shared default session of clients that send no
+ * id), its answers are mixed learners; they are left out with a warning. The four
+ * BKT parameters of every topic are estimated with Expectation-Maximization
+ * (Baum-Welch on the two-state knows/doesn't-know HMM). The E-step is split
+ * across all hardware threads; each thread accumulates per-topic expected
+ * counts for its share of the sequences and the counts are summed for the M-step.
+ *
+ * Build (from the backend folder):
+ *   g++ -std=c++17 -O2 -I. tools/bkt_fit.cpp KnowledgeTracing.cpp AnswerLog.cpp -o bkt_fit -lpthread
+ *
+ * Usage: bkt_fit [answers.log] [bkt_params.txt] [threads]
+ */
+#include "../KnowledgeTracing.h"
+#include "../AnswerLog.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    const int kMaxIterations = 200;
+    const double kTolerance = 1e-6;     // Relative log-likelihood change that counts as converged
+    const size_t kMinSequences = 20;    // Topics with less data keep the default parameters
+    const double kMaxSessionShare = 0.5; // A session id with more of the answers is treated as shared
+
+    struct Sequence {
+        size_t session;
+        int topic;
+        std::vector<unsigned char> answers; // 1 = correct
+    };
+
+    // Expected counts for one topic, summed over sequences.
+    struct Counts {
+        double initKnown = 0, sequences = 0;
+        double learnNum = 0, learnDen = 0;
+        double slipNum = 0, slipDen = 0;
+        double guessNum = 0, guessDen = 0;
+        double logLikelihood = 0;
+
+        void add(const Counts& o) {
+            initKnown += o.initKnown; sequences += o.sequences;
+            learnNum += o.learnNum; learnDen += o.learnDen;
+            slipNum += o.slipNum; slipDen += o.slipDen;
+            guessNum += o.guessNum; guessDen += o.guessDen;
+            logLikelihood += o.logLikelihood;
+        }
+    };
+
+    double clampProb(double p, double lo, double hi) {
+        return std::max(lo, std::min(hi, p));
+    }
+
+    // Scaled forward-backward over one sequence; adds its expected counts to c.
+    void expectation(const Sequence& seq, const BKTParams& p, Counts& c,
+                     std::vector<double>& alpha, std::vector<double>& beta) {
+        size_t n = seq.answers.size();
+        alpha.assign(2 * n, 0.0);
+        beta.assign(2 * n, 0.0);
+        std::vector<double> scale(n);
+
+        auto emitKnown = [&](unsigned char o) { return o ? 1.0 - p.pSlip : p.pSlip; };
+        auto emitUnknown = [&](unsigned char o) { return o ? p.pGuess : 1.0 - p.pGuess; };
+
+        // Forward pass. alpha[2t] = unknown, alpha[2t+1] = known.
+        for (size_t t = 0; t < n; ++t) {
+            unsigned char o = seq.answers[t];
+            double a0, a1;
+            if (t == 0) {
+                a0 = (1.0 - p.pInit) * emitUnknown(o);
+                a1 = p.pInit * emitKnown(o);
+            } else {
+                a0 = alpha[2 * t - 2] * (1.0 - p.pLearn) * emitUnknown(o);
+                a1 = (alpha[2 * t - 2] * p.pLearn + alpha[2 * t - 1]) * emitKnown(o);
+            }
+            scale[t] = a0 + a1;
+            alpha[2 * t] = a0 / scale[t];
+            alpha[2 * t + 1] = a1 / scale[t];
+            c.logLikelihood += std::log(scale[t]);
+        }
+
+        // Backward pass with the same scaling factors.
+        beta[2 * (n - 1)] = beta[2 * (n - 1) + 1] = 1.0;
+        for (size_t t = n - 1; t-- > 0;) {
+            unsigned char o = seq.answers[t + 1];
+            double nextUnknown = emitUnknown(o) * beta[2 * t + 2];
+            double nextKnown = emitKnown(o) * beta[2 * t + 3];
+            beta[2 * t] = ((1.0 - p.pLearn) * nextUnknown + p.pLearn * nextKnown) / scale[t + 1];
+            beta[2 * t + 1] = nextKnown / scale[t + 1];
+        }
+
+        for (size_t t = 0; t < n; ++t) {
+            double g0 = alpha[2 * t] * beta[2 * t];
+            double g1 = alpha[2 * t + 1] * beta[2 * t + 1];
+            double norm = g0 + g1;
+            g0 /= norm;
+            g1 /= norm;
+
+            if (t == 0) c.initKnown += g1;
+            if (seq.answers[t]) c.guessNum += g0; else c.slipNum += g1;
+            c.guessDen += g0;
+            c.slipDen += g1;
+
+            if (t + 1 < n) {
+                // Expected unknown -> known transitions between t and t+1.
+                unsigned char o = seq.answers[t + 1];
+                double stay0 = alpha[2 * t] * (1.0 - p.pLearn) * emitUnknown(o) * beta[2 * t + 2];
+                double learn = alpha[2 * t] * p.pLearn * emitKnown(o) * beta[2 * t + 3];
+                double stay1 = alpha[2 * t + 1] * emitKnown(o) * beta[2 * t + 3];
+                double total = stay0 + learn + stay1;
+                c.learnNum += learn / total;
+                c.learnDen += (stay0 + learn) / total;
+            }
+        }
+        c.sequences += 1;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string logFile = argc > 1 ? argv[1] : "answers.log";
+    std::string outFile = argc > 2 ? argv[2] : "bkt_params.txt";
+    unsigned threads = argc > 3 ? static_cast<unsigned>(std::atoi(argv[3])) : std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+
+    // --- Load the log into one sequence per (session, topic) ---
+    std::vector<std::string> topicNames;
+    std::unordered_map<std::string, int> topicIndex;
+    std::unordered_map<std::string, size_t> sequenceIndex;
+    std::vector<Sequence> sequences;
+    std::vector<std::string> sessionNames;
+    std::unordered_map<std::string, size_t> sessionIndex;
+    std::vector<long long> sessionAnswers;
+
+    long long events = AnswerLog::readAll(logFile, [&](const AnswerEvent& e) {
+        auto topicIt = topicIndex.find(e.topic);
+        if (topicIt == topicIndex.end()) {
+            topicIt = topicIndex.emplace(e.topic, static_cast<int>(topicNames.size())).first;
+            topicNames.push_back(e.topic);
+        }
+        auto sessionIt = sessionIndex.find(e.sessionId);
+        if (sessionIt == sessionIndex.end()) {
+            sessionIt = sessionIndex.emplace(e.sessionId, sessionNames.size()).first;
+            sessionNames.push_back(e.sessionId);
+            sessionAnswers.push_back(0);
+        }
+        sessionAnswers[sessionIt->second]++;
+        std::string key = e.sessionId + '\x1f' + e.topic;
+        auto seqIt = sequenceIndex.find(key);
+        if (seqIt == sequenceIndex.end()) {
+            seqIt = sequenceIndex.emplace(key, sequences.size()).first;
+            sequences.push_back(Sequence{sessionIt->second, topicIt->second, {}});
+        }
+        sequences[seqIt->second].answers.push_back(e.correct ? 1 : 0);
+    });
+
+    if (events < 0) {
+        std::cerr << "Error: Could not open answer log: " << logFile << std::endl;
+        return 1;
+    }
+    sequenceIndex.clear();
+    sessionIndex.clear();
+
+    // One id behind most answers means the log cannot tell learners apart
+    // there; fitting it as one learner would smear every parameter.
+    size_t dominant = std::max_element(sessionAnswers.begin(), sessionAnswers.end()) - sessionAnswers.begin();
+    if (events > 0 && sessionAnswers[dominant] > kMaxSessionShare * events) {
+        std::cerr << "Warning: session '" << sessionNames[dominant] << "' has " << sessionAnswers[dominant]
+                  << " of " << events << " answers; it is probably shared by many learners"
+                  << " and is left out of the fit." << std::endl;
+        sequences.erase(std::remove_if(sequences.begin(), sequences.end(),
+                                       [dominant](const Sequence& s) { return s.session == dominant; }),
+                        sequences.end());
+        if (sequences.empty()) {
+            std::cerr << "Error: No answers left to fit. Log a per-learner session id." << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Read " << events << " answers: " << sequences.size() << " sequences over "
+              << topicNames.size() << " topics. Fitting with " << threads << " threads." << std::endl;
+
+    // --- EM ---
+    size_t topicCount = topicNames.size();
+    std::vector<BKTParams> params(topicCount);
+    std::vector<bool> active(topicCount, false);
+    {
+        std::vector<size_t> perTopic(topicCount, 0);
+        for (const Sequence& s : sequences) perTopic[s.topic]++;
+        for (size_t t = 0; t < topicCount; ++t) active[t] = perTopic[t] >= kMinSequences;
+    }
+
+    double previousLL = -INFINITY;
+    for (int iteration = 0; iteration < kMaxIterations; ++iteration) {
+        std::vector<std::vector<Counts>> partial(threads, std::vector<Counts>(topicCount));
+        std::vector<std::thread> workers;
+        for (unsigned w = 0; w < threads; ++w) {
+            workers.emplace_back([&, w]() {
+                std::vector<double> alpha, beta;
+                size_t begin = sequences.size() * w / threads;
+                size_t end = sequences.size() * (w + 1) / threads;
+                for (size_t i = begin; i < end; ++i) {
+                    const Sequence& s = sequences[i];
+                    if (active[s.topic]) {
+                        expectation(s, params[s.topic], partial[w][s.topic], alpha, beta);
+                    }
+                }
+            });
+        }
+        for (std::thread& worker : workers) worker.join();
+
+        double totalLL = 0;
+        for (size_t t = 0; t < topicCount; ++t) {
+            if (!active[t]) continue;
+            Counts c;
+            for (unsigned w = 0; w < threads; ++w) c.add(partial[w][t]);
+            totalLL += c.logLikelihood;
+
+            // M-step. Slip and guess stay below 0.5 so "knows it" keeps meaning
+            // "more likely to answer correctly" (avoids the label-swapped solution).
+            params[t].pInit = clampProb(c.initKnown / c.sequences, 0.001, 0.999);
+            if (c.learnDen > 0) params[t].pLearn = clampProb(c.learnNum / c.learnDen, 0.001, 0.999);
+            if (c.slipDen > 0) params[t].pSlip = clampProb(c.slipNum / c.slipDen, 0.001, 0.499);
+            if (c.guessDen > 0) params[t].pGuess = clampProb(c.guessNum / c.guessDen, 0.001, 0.499);
+        }
+
+        std::cout << "Iteration " << iteration + 1 << ": log-likelihood " << totalLL << std::endl;
+        if (std::fabs(totalLL - previousLL) < kTolerance * std::fabs(totalLL)) break;
+        previousLL = totalLL;
+    }
+
+    BKTModel model;
+    for (size_t t = 0; t < topicCount; ++t) {
+        if (active[t]) {
+            model.setParams(topicNames[t], params[t]);
+        } else {
+            std::cout << "Topic '" << topicNames[t] << "' has fewer than " << kMinSequences
+                      << " sequences; leaving it on defaults." << std::endl;
+        }
+    }
+    if (!model.saveToFile(outFile)) {
+        std::cerr << "Error: Could not write " << outFile << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << outFile << std::endl;
+    return 0;
+}
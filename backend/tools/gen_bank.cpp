@@ -0,0 +1,137 @@
+/**
+ * @file gen_bank.cpp
+ * @brief Generates synthetic question banks in the questions.txt format,
+ * up to millions of questions, for scale and benchmark runs.
+ *
+ * The same options and --seed always produce the same bank, byte for
+ * byte. --overlay also writes a calibration overlay for the bank, so
+ * QuestionBank::applyOverlay and the calibrated IRT paths can be exercised
+ * at the same scale.
+ *
+ * Build (from the backend folder):
+ *   g++ -std=c++17 -O2 -I. tools/gen_bank.cpp -o gen_bank
+ *
+ * Usage: gen_bank [--questions=1000000] [--topics=50] [--topic-skew=0]
+ *                 [--mix=2:1:1] [--difficulty=uniform|weights:1:2:1|normal:2:0.6]
+ *                 [--difficulty-step=1] [--words=8-15] [--option-words=3]
+ *                 [--seed=42] [--out=bank.txt] [--overlay=bank.overlay]
+ *
+ *   --mix            relative weights of MC : TF : FIB questions
+ *   --topic-skew     Zipf exponent; 0 spreads questions evenly over topics
+ *   --difficulty     whole levels 1-3 uniformly, in the given ratio, or a
+ *                    normal distribution (mean:spread) clamped to [1, 3]
+ *   --difficulty-step  granularity of difficulties, e.g. 0.25 (1 = whole levels)
+ *   --words          question text length range, in words
+ *   --out            "-" (the default) writes to stdout
+ */
+#include "SyntheticBank.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace {
+    // Parses "a:b:c" into three weights; false if malformed.
+    bool parseTriple(const std::string& text, double out[3]) {
+        std::stringstream ss(text);
+        std::string part;
+        for (int i = 0; i < 3; ++i) {
+            if (!std::getline(ss, part, ':') || part.empty()) return false;
+            out[i] = std::atof(part.c_str());
+        }
+        return true;
+    }
+
+    bool parseDifficulty(const std::string& spec, SyntheticBankOptions& opts) {
+        if (spec == "uniform") {
+            opts.difficulty = SyntheticBankOptions::Uniform;
+            return true;
+        }
+        if (spec.rfind("weights:", 0) == 0) {
+            opts.difficulty = SyntheticBankOptions::Weighted;
+            return parseTriple(spec.substr(8), opts.levelWeights);
+        }
+        if (spec.rfind("normal:", 0) == 0) {
+            opts.difficulty = SyntheticBankOptions::Normal;
+            std::string params = spec.substr(7);
+            size_t colon = params.find(':');
+            if (colon == std::string::npos) return false;
+            opts.difficultyMean = std::atof(params.substr(0, colon).c_str());
+            opts.difficultySpread = std::atof(params.substr(colon + 1).c_str());
+            return true;
+        }
+        return false;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    SyntheticBankOptions opts;
+    opts.questions = 1000000;
+    opts.topics = 50;
+    std::string outFile = "-";
+    std::string overlayFile;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--questions=", 0) == 0) opts.questions = std::strtoull(arg.c_str() + 12, nullptr, 10);
+        else if (arg.rfind("--topics=", 0) == 0) opts.topics = std::max(1, std::atoi(arg.c_str() + 9));
+        else if (arg.rfind("--topic-skew=", 0) == 0) opts.topicSkew = std::atof(arg.c_str() + 13);
+        else if (arg.rfind("--mix=", 0) == 0) {
+            if (!parseTriple(arg.substr(6), opts.typeWeights)) {
+                std::cerr << "Bad --mix (expected MC:TF:FIB weights, e.g. 2:1:1): " << arg << std::endl;
+                return 1;
+            }
+        } else if (arg.rfind("--difficulty=", 0) == 0) {
+            if (!parseDifficulty(arg.substr(13), opts)) {
+                std::cerr << "Bad --difficulty (uniform, weights:1:2:1 or normal:2:0.6): " << arg << std::endl;
+                return 1;
+            }
+        } else if (arg.rfind("--difficulty-step=", 0) == 0) opts.difficultyStep = std::atof(arg.c_str() + 18);
+        else if (arg.rfind("--words=", 0) == 0) {
+            std::string range = arg.substr(8);
+            size_t dash = range.find('-');
+            opts.minWords = std::atoi(range.c_str());
+            opts.maxWords = dash == std::string::npos ? opts.minWords : std::atoi(range.c_str() + dash + 1);
+        } else if (arg.rfind("--option-words=", 0) == 0) opts.optionWords = std::atoi(arg.c_str() + 15);
+        else if (arg.rfind("--seed=", 0) == 0) opts.seed = std::strtoull(arg.c_str() + 7, nullptr, 10);
+        else if (arg.rfind("--out=", 0) == 0) outFile = arg.substr(6);
+        else if (arg.rfind("--overlay=", 0) == 0) overlayFile = arg.substr(10);
+        else std::cerr << "Ignoring unknown option: " << arg << std::endl;
+    }
+
+    std::ofstream file;
+    if (outFile != "-") {
+        file.open(outFile, std::ios::binary);
+        if (!file) {
+            std::cerr << "Error: Could not write " << outFile << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = outFile == "-" ? std::cout : file;
+
+    std::ofstream overlay;
+    if (!overlayFile.empty()) {
+        overlay.open(overlayFile, std::ios::binary);
+        if (!overlay) {
+            std::cerr << "Error: Could not write " << overlayFile << std::endl;
+            return 1;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    SyntheticBankSummary summary = writeSyntheticBank(out, opts, overlayFile.empty() ? nullptr : &overlay);
+    out.flush();
+    if (!out) {
+        std::cerr << "Error: Write failed (disk full?)" << std::endl;
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cerr << "Wrote " << opts.questions << " questions (" << summary.byType[0] << " MC, " << summary.byType[1]
+              << " TF, " << summary.byType[2] << " FIB; difficulty ~1/2/3: " << summary.byLevel[0] << "/"
+              << summary.byLevel[1] << "/" << summary.byLevel[2] << ") over " << opts.topics << " topics, "
+              << summary.bytes / 1048576.0 << " MiB in " << seconds << " s (seed " << opts.seed << ")" << std::endl;
+    return 0;
+}
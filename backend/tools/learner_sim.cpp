@@ -0,0 +1,400 @@
+/**
+ * @file learner_sim.cpp
+ * @brief Offline learner-population simulator: runs synthetic learners
+ * with latent per-topic skill through the real QuestionBank, UserStats and
+ * selection policies (no HTTP), and reports, per policy, how fast learners
+ * reach mastery and how many questions that consumes.
+ *
+ * Learner model: each learner has a latent skill theta per topic, drawn
+ * from N(--skill-mean, --skill-sd). A question with IRT parameters (a, b)
+ * (the same ones the server's IRTModel uses) is answered correctly with
+ * probability guess + (1 - guess) / (1 + exp(-a (theta - b))), where
+ * guess is 1/4 for multiple choice, 1/2 for true/false and 0 for fill in
+ * the blank. Each answer teaches: theta grows by --learn-rate, scaled by
+ * exp(-(theta - b)^2 / 2), so questions near the learner's level teach
+ * the most. A learner has mastered the bank once every topic's theta is
+ * at least --mastery-theta, and stops there or after --max-questions.
+ *
+ * Every policy sees the same learners (the same seed per learner), so
+ * policies are compared on identical populations. After each answer the
+ * simulator applies the same model updates as /submit_answer: stats,
+ * BKT mastery, bandit, ability, Elo and difficulty. The report
+ * also shows when BKT first claimed mastery of every topic, and how often
+ * it did so before the learner had really got there.
+ *
+ * Learners are simulated in chunks on a work-stealing thread pool; each
+ * thread accumulates into its own counters. Each policy has its own item
+ * Elo ratings, so what one policy's learners teach them cannot leak into
+ * another's run; within a policy they are shared and updated concurrently,
+ * as in the server, so runs with several threads agree statistically
+ * rather than bit for bit.
+ *
+ * Build (from the backend folder):
+ *   g++ -std=c++17 -O2 -I. tools/learner_sim.cpp SelectionPolicy.cpp UserStats.cpp QuestionBank.cpp MultipleChoiceQuestion.cpp TrueFalseQuestion.cpp FillInTheBlankQuestion.cpp KnowledgeTracing.cpp ItemResponseTheory.cpp EloRating.cpp ThompsonSampling.cpp SpacedRepetition.cpp TopicTrend.cpp TimingWheel.cpp ExposureControl.cpp Logger.cpp Metrics.cpp LatencyHistogram.cpp BucketInventory.cpp -o learner_sim -lpthread
+ *
+ * Usage: learner_sim [--questions=questions.txt] [--overlay=FILE]
+ *                    [--bkt-params=FILE] [--policies=weakest,bkt,irt,...]
+ *                    [--learners=10000] [--threads=N] [--chunk=64]
+ *                    [--max-questions=300] [--skill-mean=-1] [--skill-sd=1]
+ *                    [--learn-rate=0.08] [--mastery-theta=1]
+ *                    [--difficulty-step=1] [--seed=7] [--format=table|json]
+ */
+#include "../QuestionBank.h"
+#include "../UserStats.h"
+#include "../SelectionPolicy.h"
+#include "../KnowledgeTracing.h"
+#include "../ItemResponseTheory.h"
+#include "../EloRating.h"
+#include "../TopicTrend.h"
+#include "../Logger.h"
+#include "../json.hpp"
+#include "SyntheticBank.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace {
+    struct Options {
+        std::string questionFile = "questions.txt";
+        std::string overlayFile;
+        std::string bktParamsFile;
+        std::vector<std::string> policies; // Empty: every registered policy
+        uint64_t learners = 10000;
+        int threads = 0;
+        uint64_t chunk = 64;
+        int maxQuestions = 300;
+        double skillMean = -1.0;
+        double skillSd = 1.0;
+        double learnRate = 0.08;
+        double masteryTheta = 1.0;
+        double difficultyStep = 1.0;
+        double eloTarget = 0.75;
+        uint64_t seed = 7;
+        bool jsonOutput = false;
+    };
+
+    /**
+     * Per-policy totals; each thread has its own, merged at the end.
+     * answersToMastery[n] counts learners who got there after n answers.
+     */
+    struct Tally {
+        uint64_t learners = 0;
+        uint64_t mastered = 0;
+        std::vector<uint64_t> answersToMastery;
+        uint64_t answers = 0;
+        uint64_t uniqueQuestions = 0;
+        uint64_t repeats = 0;        // Questions served a second time
+        uint64_t estimatedMastered = 0;
+        uint64_t estimatedAnswers = 0;
+        uint64_t prematureEstimates = 0; // BKT claimed mastery before the learner had it
+        double nanos = 0;
+
+        explicit Tally(int maxQuestions = 0) : answersToMastery(maxQuestions + 1, 0) {}
+
+        void merge(const Tally& other) {
+            learners += other.learners;
+            mastered += other.mastered;
+            for (size_t n = 0; n < answersToMastery.size() && n < other.answersToMastery.size(); ++n) {
+                answersToMastery[n] += other.answersToMastery[n];
+            }
+            answers += other.answers;
+            uniqueQuestions += other.uniqueQuestions;
+            repeats += other.repeats;
+            estimatedMastered += other.estimatedMastered;
+            estimatedAnswers += other.estimatedAnswers;
+            prematureEstimates += other.prematureEstimates;
+            nanos += other.nanos;
+        }
+
+        // Answers by which fraction q of the learners who got there had mastered.
+        int percentile(double q) const {
+            if (mastered == 0) return -1;
+            uint64_t rank = static_cast<uint64_t>(std::ceil(q * mastered));
+            uint64_t seen = 0;
+            for (size_t n = 0; n < answersToMastery.size(); ++n) {
+                seen += answersToMastery[n];
+                if (seen >= rank && seen > 0) return static_cast<int>(n);
+            }
+            return static_cast<int>(answersToMastery.size()) - 1;
+        }
+    };
+
+    struct Models {
+        QuestionBank bank;
+        BKTModel bkt;
+        IRTModel irt;
+        EloRatings elo; // The Elo policy's own ratings
+        PolicyRegistry registry;
+        std::vector<SelectionPolicy*> policies; // The ones being compared
+        std::vector<EloRatings*> eloByPolicy;   // Item ratings each policy's learners update
+        std::vector<std::unique_ptr<EloRatings>> ownedElo;
+    };
+
+    double guessRate(const Question* q) {
+        const std::string type = q->getQuestionType();
+        if (type == "MC") return 0.25;
+        if (type == "TF") return 0.5;
+        return 0.0;
+    }
+
+    /**
+     * Runs one learner under one policy until mastery or the question budget.
+     */
+    void simulateLearner(const Options& opts, Models& models, SelectionPolicy& policy, EloRatings& elo, uint64_t learner,
+                         Tally& tally) {
+        const std::vector<std::string>& topics = models.bank.getTopics();
+        SplitMix64 rng(opts.seed * 0x9E3779B97F4A7C15ULL + learner);
+        std::vector<double> skill(topics.size());
+        for (double& theta : skill) {
+            theta = opts.skillMean + opts.skillSd * rng.normal();
+        }
+        auto masteredAll = [&]() {
+            for (double theta : skill) {
+                if (theta < opts.masteryTheta) return false;
+            }
+            return true;
+        };
+
+        UserStats user("sim-" + std::to_string(learner));
+        tally.learners++;
+        int answers = 0;
+        uint64_t repeats = 0;
+        int estimatedAt = -1;
+        bool mastered = masteredAll();
+        while (!mastered && answers < opts.maxQuestions) {
+            Question* q = policy.select(user);
+            if (q == nullptr) break;
+            if (user.isUsed(q)) repeats++;
+            user.setLastQuestion(q);
+
+            const std::string& topic = q->getTopic();
+            int topicIdx = models.bank.getTopicIndex(topic);
+            double& theta = skill[topicIdx];
+            const ItemParams& item = models.irt.getParams(q->getId());
+            double guess = guessRate(q);
+            double pCorrect = guess + (1.0 - guess) / (1.0 + std::exp(-item.a * (theta - item.b)));
+            bool correct = rng.unit() < pCorrect;
+            theta += opts.learnRate * std::exp(-0.5 * (theta - item.b) * (theta - item.b));
+
+            // The model updates /submit_answer makes.
+            user.updateStats(topic, correct);
+            user.updateMastery(topic, correct, models.bkt);
+            user.updateBandit(topicIdx, correct);
+            user.updateAbility(item, correct);
+            user.updateRating(elo.recordAnswer(q->getId(), user.getRating(), correct), correct);
+            user.adjustDifficulty(correct, opts.difficultyStep);
+            answers++;
+
+            mastered = masteredAll();
+            if (estimatedAt < 0 && static_cast<size_t>(user.getMasteredTopicCount()) == topics.size()) {
+                estimatedAt = answers;
+                if (!mastered) tally.prematureEstimates++;
+            }
+        }
+
+        tally.answers += answers;
+        tally.repeats += repeats;
+        tally.uniqueQuestions += user.getUsedQuestions().size() - repeats; // The list holds every serve
+        if (mastered) {
+            tally.mastered++;
+            tally.answersToMastery[answers]++;
+        }
+        if (estimatedAt >= 0) {
+            tally.estimatedMastered++;
+            tally.estimatedAnswers += estimatedAt;
+        }
+    }
+
+    std::vector<std::string> splitList(const std::string& list) {
+        std::vector<std::string> items;
+        std::stringstream ss(list);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            if (!item.empty()) items.push_back(item);
+        }
+        return items;
+    }
+
+    double mean(uint64_t total, uint64_t count) {
+        return count > 0 ? static_cast<double>(total) / count : 0.0;
+    }
+
+    void report(const Options& opts, const Models& models, const std::vector<Tally>& totals, double seconds,
+                uint64_t steals, int threads) {
+        if (opts.jsonOutput) {
+            json out;
+            out["learners"] = opts.learners;
+            out["questions"] = models.bank.size();
+            out["topics"] = models.bank.getTopics().size();
+            out["maxQuestions"] = opts.maxQuestions;
+            out["threads"] = threads;
+            out["steals"] = steals;
+            out["seconds"] = seconds;
+            for (size_t p = 0; p < totals.size(); ++p) {
+                const Tally& t = totals[p];
+                json entry;
+                entry["masteredShare"] = mean(t.mastered, t.learners);
+                // null when no learner got there
+                entry["answersToMasteryP50"] = t.mastered > 0 ? json(t.percentile(0.50)) : json();
+                entry["answersToMasteryP90"] = t.mastered > 0 ? json(t.percentile(0.90)) : json();
+                uint64_t masteredAnswers = 0;
+                for (size_t n = 0; n < t.answersToMastery.size(); ++n) masteredAnswers += n * t.answersToMastery[n];
+                entry["answersToMasteryMean"] = mean(masteredAnswers, t.mastered);
+                entry["answersPerLearner"] = mean(t.answers, t.learners);
+                entry["uniqueQuestionsPerLearner"] = mean(t.uniqueQuestions, t.learners);
+                entry["repeatsPerLearner"] = mean(t.repeats, t.learners);
+                entry["bktMasteredShare"] = mean(t.estimatedMastered, t.learners);
+                entry["bktAnswersToMasteryMean"] = mean(t.estimatedAnswers, t.estimatedMastered);
+                entry["bktPrematureShare"] = mean(t.prematureEstimates, t.estimatedMastered);
+                entry["cpuMicrosPerLearner"] = t.learners > 0 ? t.nanos / 1000.0 / t.learners : 0.0;
+                out["policies"][models.policies[p]->getName()] = entry;
+            }
+            std::cout << out.dump(2) << std::endl;
+            return;
+        }
+
+        std::cout << opts.learners << " learners x " << totals.size() << " policies on " << models.bank.size()
+                  << " questions / " << models.bank.getTopics().size() << " topics; " << threads << " threads, "
+                  << steals << " steals, " << std::fixed << std::setprecision(1) << seconds << " s" << std::endl;
+        std::cout << std::left << std::setw(17) << "policy" << std::right
+                  << std::setw(10) << "mastered" << std::setw(8) << "p50" << std::setw(8) << "p90"
+                  << std::setw(10) << "answers" << std::setw(9) << "unique" << std::setw(9) << "repeats"
+                  << std::setw(11) << "bkt says" << std::setw(9) << "bkt at" << std::setw(11) << "premature" << std::endl;
+        for (size_t p = 0; p < totals.size(); ++p) {
+            const Tally& t = totals[p];
+            std::cout << std::left << std::setw(17) << models.policies[p]->getName() << std::right
+                      << std::setw(9) << std::setprecision(1) << 100.0 * mean(t.mastered, t.learners) << "%"
+                      << std::setw(8) << t.percentile(0.50) << std::setw(8) << t.percentile(0.90)
+                      << std::setw(10) << mean(t.answers, t.learners)
+                      << std::setw(9) << mean(t.uniqueQuestions, t.learners)
+                      << std::setw(9) << mean(t.repeats, t.learners)
+                      << std::setw(10) << 100.0 * mean(t.estimatedMastered, t.learners) << "%"
+                      << std::setw(9) << mean(t.estimatedAnswers, t.estimatedMastered)
+                      << std::setw(10) << 100.0 * mean(t.prematureEstimates, t.estimatedMastered) << "%" << std::endl;
+        }
+        std::cout << "mastered: share reaching --mastery-theta in every topic within " << opts.maxQuestions
+                  << " answers; p50/p90: answers it took them; answers/unique/repeats: per learner." << std::endl
+                  << "bkt says: share BKT rated mastered in every topic; bkt at: mean answers when it did; "
+                  << "premature: share of those claims made before real mastery." << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options opts;
+    opts.threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--questions=", 0) == 0) opts.questionFile = arg.substr(12);
+        else if (arg.rfind("--overlay=", 0) == 0) opts.overlayFile = arg.substr(10);
+        else if (arg.rfind("--bkt-params=", 0) == 0) opts.bktParamsFile = arg.substr(13);
+        else if (arg.rfind("--policies=", 0) == 0) opts.policies = splitList(arg.substr(11));
+        else if (arg.rfind("--learners=", 0) == 0) opts.learners = std::strtoull(arg.c_str() + 11, nullptr, 10);
+        else if (arg.rfind("--threads=", 0) == 0) opts.threads = std::max(1, std::atoi(arg.c_str() + 10));
+        else if (arg.rfind("--chunk=", 0) == 0) opts.chunk = std::max<uint64_t>(1, std::strtoull(arg.c_str() + 8, nullptr, 10));
+        else if (arg.rfind("--max-questions=", 0) == 0) opts.maxQuestions = std::max(1, std::atoi(arg.c_str() + 16));
+        else if (arg.rfind("--skill-mean=", 0) == 0) opts.skillMean = std::atof(arg.c_str() + 13);
+        else if (arg.rfind("--skill-sd=", 0) == 0) opts.skillSd = std::atof(arg.c_str() + 11);
+        else if (arg.rfind("--learn-rate=", 0) == 0) opts.learnRate = std::atof(arg.c_str() + 13);
+        else if (arg.rfind("--mastery-theta=", 0) == 0) opts.masteryTheta = std::atof(arg.c_str() + 16);
+        else if (arg.rfind("--difficulty-step=", 0) == 0) opts.difficultyStep = std::atof(arg.c_str() + 18);
+        else if (arg.rfind("--elo-target=", 0) == 0) opts.eloTarget = std::atof(arg.c_str() + 13);
+        else if (arg.rfind("--seed=", 0) == 0) opts.seed = std::strtoull(arg.c_str() + 7, nullptr, 10);
+        else if (arg == "--format=json") opts.jsonOutput = true;
+        else if (arg == "--format=table") opts.jsonOutput = false;
+        else std::cerr << "Ignoring unknown option: " << arg << std::endl;
+    }
+
+    // Per-request log lines would swamp the run.
+    Logger::start(Logger::Warn, 0.0);
+
+    Models models;
+    models.bank.loadFromFile(opts.questionFile);
+    if (models.bank.size() == 0) {
+        std::cerr << "No questions loaded from " << opts.questionFile << std::endl;
+        return 1;
+    }
+    if (!opts.overlayFile.empty() && models.bank.applyOverlay(opts.overlayFile) < 0) {
+        std::cerr << "Could not read overlay " << opts.overlayFile << "; using authored difficulties." << std::endl;
+    }
+    if (!opts.bktParamsFile.empty() && !models.bkt.loadFromFile(opts.bktParamsFile)) {
+        std::cerr << "Could not read " << opts.bktParamsFile << "; using default BKT parameters." << std::endl;
+    }
+    models.irt.initFromBank(models.bank);
+    models.elo.initFromBank(models.bank);
+
+    // The server's policy set, built the same way.
+    TopicTrend::configure(10, 8.0);
+    models.registry.add(new WeakestTopicPolicy(models.bank));
+    models.registry.add(new WeakestTopicPolicy(models.bank, TopicScore::Decayed));
+    models.registry.add(new WeakestTopicPolicy(models.bank, TopicScore::Recent));
+    models.registry.add(new RandomTopicPolicy(models.bank));
+    models.registry.add(new BKTPolicy(models.bank, models.bkt));
+    models.registry.add(new BanditPolicy(models.bank));
+    models.registry.add(new IRTPolicy(models.bank, models.irt));
+    SelectionPolicy* eloPolicy = new EloPolicy(models.bank, models.elo, opts.eloTarget);
+    models.registry.add(eloPolicy);
+    std::vector<std::string> names = opts.policies.empty() ? models.registry.getNames() : opts.policies;
+    for (const std::string& name : names) {
+        if (SelectionPolicy* policy = models.registry.find(name)) {
+            models.policies.push_back(policy);
+            if (policy == eloPolicy) {
+                models.eloByPolicy.push_back(&models.elo);
+            } else {
+                models.ownedElo.emplace_back(new EloRatings());
+                models.ownedElo.back()->initFromBank(models.bank);
+                models.eloByPolicy.push_back(models.ownedElo.back().get());
+            }
+        } else {
+            std::cerr << "Unknown policy '" << name << "'; skipping it." << std::endl;
+        }
+    }
+    if (models.policies.empty()) {
+        std::cerr << "No policies to simulate." << std::endl;
+        return 1;
+    }
+
+    // tallies[thread][policy]
+    std::vector<std::vector<Tally>> tallies(opts.threads,
+                                            std::vector<Tally>(models.policies.size(), Tally(opts.maxQuestions)));
+    WorkStealingPool pool(opts.threads);
+    for (uint64_t first = 0; first < opts.learners; first += opts.chunk) {
+        uint64_t last = std::min(opts.learners, first + opts.chunk);
+        pool.submit([&opts, &models, &tallies, first, last](int worker) {
+            for (size_t p = 0; p < models.policies.size(); ++p) {
+                Tally& tally = tallies[worker][p];
+                auto start = std::chrono::steady_clock::now();
+                for (uint64_t learner = first; learner < last; ++learner) {
+                    simulateLearner(opts, models, *models.policies[p], *models.eloByPolicy[p], learner, tally);
+                }
+                tally.nanos += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            }
+        });
+    }
+
+    std::cerr << "Simulating " << opts.learners << " learners under " << models.policies.size() << " policies on "
+              << pool.threadCount() << " threads..." << std::endl;
+    auto start = std::chrono::steady_clock::now();
+    pool.run();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<Tally> totals(models.policies.size(), Tally(opts.maxQuestions));
+    for (const auto& perThread : tallies) {
+        for (size_t p = 0; p < perThread.size(); ++p) {
+            totals[p].merge(perThread[p]);
+        }
+    }
+    report(opts, models, totals, seconds, pool.stealCount(), pool.threadCount());
+    Logger::stop();
+    return 0;
+}
@@ -0,0 +1,550 @@
+/**
+ * @file load_gen.cpp
+ * @brief Closed-loop HTTP load generator: thousands of simulated learners,
+ * each running /start_quiz -> (/get_question -> think -> /submit_answer)*
+ * against a running quiz server.
+ *
+ * Every learner has its own session (X-Session-Id, or the signed token in
+ * stateless mode) and its own HTTP/1.1 keep-alive connection, and sends its
+ * next request only after the previous response arrived and its think time
+ * passed. A connection the server closed is reopened on the next request;
+ * a request that fails on a reused connection before any response byte
+ * arrived is retried once on a fresh one.
+ *
+ * Learners answer correctly with probability --accuracy. The answer key
+ * comes from --questions (the server's bank file) when given, and is also
+ * learned from each /submit_answer response; questions whose key is not yet
+ * known get a guess. Latency is measured from issuing a request to reading
+ * the whole response, including any reconnect, and reported per route
+ * after --warmup seconds.
+ *
+ * Build (from the backend folder):
+ *   g++ -std=c++17 -O2 -I. tools/load_gen.cpp QuestionBank.cpp MultipleChoiceQuestion.cpp TrueFalseQuestion.cpp FillInTheBlankQuestion.cpp ThompsonSampling.cpp SpacedRepetition.cpp TimingWheel.cpp ExposureControl.cpp Metrics.cpp LatencyHistogram.cpp BucketInventory.cpp -o load_gen -lpthread
+ *
+ * Usage: load_gen [--host=127.0.0.1] [--port=18080] [--learners=1000]
+ *                 [--duration=30] [--warmup=5] [--threads=2]
+ *                 [--accuracy=0.7] [--think-ms=500] [--quiz-length=20]
+ *                 [--ramp-ms=2000] [--questions=questions.txt] [--seed=1]
+ *                 [--format=table|json]
+ */
+#ifndef ASIO_STANDALONE
+#define ASIO_STANDALONE
+#endif
+#include <asio.hpp>
+#include "../QuestionBank.h"
+#include "../LatencyHistogram.h"
+#include "../json.hpp"
+#include "SyntheticBank.h"
+#include <atomic>
+#include <chrono>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using json = nlohmann::json;
+using asio::ip::tcp;
+
+namespace {
+    enum Route { StartQuiz = 0, GetQuestion, SubmitAnswer, kRouteCount };
+
+    const char* const kRoutePaths[kRouteCount] = {"/start_quiz", "/get_question", "/submit_answer"};
+
+    struct Options {
+        std::string host = "127.0.0.1";
+        std::string port = "18080";
+        int learners = 1000;
+        int durationSeconds = 30;
+        int warmupSeconds = 5;
+        int threads = 2;
+        double accuracy = 0.7;
+        int thinkMillis = 500;
+        int quizLength = 20;
+        int rampMillis = 2000;
+        std::string questionFile;
+        uint64_t seed = 1;
+        bool jsonOutput = false;
+    };
+
+    /**
+     * Shared by every learner: latency per route, outcome counters and the
+     * answer key (question text -> an answer the server grades correct).
+     */
+    struct Shared {
+        Options opts;
+        tcp::endpoint endpoint;
+        std::atomic<bool> measuring{false};
+        std::atomic<bool> stopping{false};
+
+        LatencyHistogram latency[kRouteCount];
+        std::atomic<uint64_t> errors[kRouteCount];
+        std::atomic<uint64_t> connects{0};
+        std::atomic<uint64_t> retries{0};
+        std::atomic<uint64_t> quizzes{0};
+        std::atomic<uint64_t> answersCorrect{0};
+        std::atomic<uint64_t> answersIncorrect{0};
+        std::atomic<uint64_t> guesses{0};
+
+        std::mutex keyMutex;
+        std::unordered_map<std::string, std::string> answerKey;
+
+        Shared() {
+            for (auto& e : errors) e.store(0, std::memory_order_relaxed);
+        }
+
+        bool lookupKey(const std::string& text, std::string& answer) {
+            std::lock_guard<std::mutex> lock(keyMutex);
+            auto it = answerKey.find(text);
+            if (it == answerKey.end()) return false;
+            answer = it->second;
+            return true;
+        }
+
+        void learnKey(const std::string& text, const std::string& answer) {
+            std::lock_guard<std::mutex> lock(keyMutex);
+            answerKey.emplace(text, answer);
+        }
+    };
+
+    // An answer the server grades correct, given its correctAnswerString
+    // ("B. text" for multiple choice, the answer itself otherwise).
+    std::string keyFromCorrectString(const std::string& type, const std::string& correct) {
+        if (type == "MC" && !correct.empty()) return correct.substr(0, 1);
+        return correct;
+    }
+
+    // An answer the server grades wrong.
+    std::string wrongAnswer(const std::string& type, const std::string& key, SplitMix64& rng) {
+        if (type == "MC") {
+            std::string letter(1, static_cast<char>('A' + rng.below(4)));
+            if (!key.empty() && (letter[0] == key[0] || letter[0] == key[0] - 32 || letter[0] == key[0] + 32)) {
+                letter[0] = letter[0] == 'A' ? 'B' : 'A';
+            }
+            return letter;
+        }
+        if (type == "TF") return (key == "true" || key == "True" || key == "t") ? "false" : "true";
+        return "not-the-answer";
+    }
+
+    std::string guessAnswer(const json& question, SplitMix64& rng) {
+        std::string type = question.value("type", "");
+        if (type == "MC") {
+            size_t options = question.contains("options") ? question["options"].size() : 4;
+            return std::string(1, static_cast<char>('A' + rng.below(options > 0 ? options : 4)));
+        }
+        if (type == "TF") return rng.below(2) ? "true" : "false";
+        return "guess";
+    }
+
+    /**
+     * One simulated learner: a state machine with at most one outstanding
+     * asynchronous operation. Its socket and timer share a strand, so the
+     * shutdown posted from the main timer never races a handler.
+     */
+    class Learner : public std::enable_shared_from_this<Learner> {
+        Shared& shared;
+        SplitMix64 rng;
+        asio::strand<asio::io_context::executor_type> strand;
+        tcp::socket socket;
+        asio::steady_timer timer;
+        asio::streambuf input;
+
+        std::string sessionId;
+        std::string sessionToken; // Stateless mode only
+        std::string request;
+        Route route = StartQuiz;
+        bool retried = false;
+        bool reused = false;     // The socket already carried a response
+        bool closeAfter = false; // Server sent "Connection: close"
+        size_t contentLength = 0;
+        int status = 0;
+        std::chrono::steady_clock::time_point sentAt;
+
+        int answersThisQuiz = 0;
+        json currentQuestion;
+
+    public:
+        Learner(asio::io_context& io, Shared& s, int idx)
+            : shared(s), rng(s.opts.seed * 1000003ULL + static_cast<uint64_t>(idx)),
+              strand(asio::make_strand(io)), socket(strand), timer(strand), sessionId("load-" + std::to_string(idx)) {}
+
+        void start(std::chrono::milliseconds delay) {
+            auto self = shared_from_this();
+            timer.expires_after(delay);
+            timer.async_wait([self](const asio::error_code&) { self->send(StartQuiz, ""); });
+        }
+
+        // Safe from any thread.
+        void stop() {
+            auto self = shared_from_this();
+            asio::post(strand, [self]() { self->close(); });
+        }
+
+    private:
+        void close() {
+            asio::error_code ignored;
+            timer.cancel();
+            socket.close(ignored);
+        }
+
+
+        void send(Route r, const std::string& body) {
+            if (shared.stopping.load(std::memory_order_relaxed)) {
+                close();
+                return;
+            }
+            route = r;
+            retried = false;
+            request = std::string(r == SubmitAnswer ? "POST " : "GET ") + kRoutePaths[r] + " HTTP/1.1\r\n";
+            request += "Host: " + shared.opts.host + "\r\n";
+            request += "X-Session-Id: " + sessionId + "\r\n";
+            if (!sessionToken.empty()) request += "X-Session-Token: " + sessionToken + "\r\n";
+            if (r == SubmitAnswer) request += "Content-Type: application/json\r\n";
+            request += "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+            sentAt = std::chrono::steady_clock::now();
+            transmit();
+        }
+
+        void transmit() {
+            if (socket.is_open()) {
+                write();
+                return;
+            }
+            auto self = shared_from_this();
+            socket.async_connect(shared.endpoint, [self](const asio::error_code& ec) {
+                if (ec) {
+                    self->fail();
+                    return;
+                }
+                self->shared.connects.fetch_add(1, std::memory_order_relaxed);
+                self->socket.set_option(tcp::no_delay(true));
+                self->reused = false;
+                self->write();
+            });
+        }
+
+        void write() {
+            auto self = shared_from_this();
+            asio::async_write(socket, asio::buffer(request), [self](const asio::error_code& ec, size_t) {
+                if (ec) {
+                    self->retryOrFail();
+                    return;
+                }
+                self->readHeaders();
+            });
+        }
+
+        void readHeaders() {
+            auto self = shared_from_this();
+            asio::async_read_until(socket, input, "\r\n\r\n", [self](const asio::error_code& ec, size_t headerBytes) {
+                if (ec) {
+                    // Nothing received: a kept-alive connection the server had already closed.
+                    if (self->input.size() == 0) self->retryOrFail();
+                    else self->fail();
+                    return;
+                }
+                self->parseHeaders(headerBytes);
+                size_t buffered = self->input.size();
+                if (buffered >= self->contentLength) {
+                    self->finish();
+                    return;
+                }
+                asio::async_read(self->socket, self->input, asio::transfer_exactly(self->contentLength - buffered),
+                                 [self](const asio::error_code& ec2, size_t) {
+                                     if (ec2) self->fail();
+                                     else self->finish();
+                                 });
+            });
+        }
+
+        void parseHeaders(size_t headerBytes) {
+            std::string head(asio::buffers_begin(input.data()), asio::buffers_begin(input.data()) + headerBytes);
+            input.consume(headerBytes);
+            status = 0;
+            contentLength = 0;
+            closeAfter = false;
+            size_t space = head.find(' ');
+            if (space != std::string::npos) status = std::atoi(head.c_str() + space + 1);
+
+            size_t pos = head.find("\r\n");
+            while (pos != std::string::npos && pos + 2 < head.size()) {
+                size_t end = head.find("\r\n", pos + 2);
+                std::string line = head.substr(pos + 2, end == std::string::npos ? std::string::npos : end - pos - 2);
+                size_t colon = line.find(':');
+                if (colon != std::string::npos) {
+                    std::string name = line.substr(0, colon);
+                    std::string value = line.substr(colon + 1);
+                    value.erase(0, value.find_first_not_of(' '));
+                    for (char& c : name) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+                    if (name == "content-length") contentLength = std::strtoull(value.c_str(), nullptr, 10);
+                    else if (name == "connection" && (value == "close" || value == "Close")) closeAfter = true;
+                }
+                pos = end;
+            }
+        }
+
+        void retryOrFail() {
+            asio::error_code ignored;
+            socket.close(ignored);
+            if (shared.stopping.load(std::memory_order_relaxed)) return;
+            if (reused && !retried) {
+                retried = true;
+                shared.retries.fetch_add(1, std::memory_order_relaxed);
+                transmit();
+                return;
+            }
+            fail();
+        }
+
+        void fail() {
+            asio::error_code ignored;
+            socket.close(ignored);
+            input.consume(input.size());
+            if (shared.stopping.load(std::memory_order_relaxed)) return;
+            if (shared.measuring.load(std::memory_order_relaxed)) {
+                shared.errors[route].fetch_add(1, std::memory_order_relaxed);
+            }
+            // Back off briefly, then begin a new quiz.
+            auto self = shared_from_this();
+            timer.expires_after(std::chrono::milliseconds(100));
+            timer.async_wait([self](const asio::error_code& ec) {
+                if (!ec) self->send(StartQuiz, "");
+            });
+        }
+
+        void finish() {
+            uint64_t nanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - sentAt).count());
+            std::string body(asio::buffers_begin(input.data()), asio::buffers_begin(input.data()) + contentLength);
+            input.consume(contentLength);
+            reused = true;
+            if (closeAfter) {
+                asio::error_code ignored;
+                socket.close(ignored);
+            }
+
+            bool measuring = shared.measuring.load(std::memory_order_relaxed);
+            if (measuring) shared.latency[route].record(nanos);
+
+            json reply = json::parse(body, nullptr, false);
+            if (status != 200 || reply.is_discarded()) {
+                if (measuring) shared.errors[route].fetch_add(1, std::memory_order_relaxed);
+                next(StartQuiz, std::chrono::milliseconds(0));
+                return;
+            }
+            if (reply.contains("sessionToken")) sessionToken = reply["sessionToken"].get<std::string>();
+
+            switch (route) {
+                case StartQuiz:
+                    answersThisQuiz = 0;
+                    if (measuring) shared.quizzes.fetch_add(1, std::memory_order_relaxed);
+                    next(GetQuestion, std::chrono::milliseconds(0));
+                    break;
+                case GetQuestion:
+                    if (reply.value("quizComplete", false) || !reply.contains("questionText")) {
+                        next(StartQuiz, std::chrono::milliseconds(0));
+                    } else {
+                        currentQuestion = std::move(reply);
+                        next(SubmitAnswer, thinkTime());
+                    }
+                    break;
+                case SubmitAnswer: {
+                    bool correct = reply.value("isCorrect", false);
+                    if (measuring) (correct ? shared.answersCorrect : shared.answersIncorrect).fetch_add(1, std::memory_order_relaxed);
+                    shared.learnKey(currentQuestion.value("questionText", ""),
+                                    keyFromCorrectString(currentQuestion.value("type", ""),
+                                                         reply.value("correctAnswerString", "")));
+                    bool done = reply.value("quizComplete", false) ||
+                                (shared.opts.quizLength > 0 && ++answersThisQuiz >= shared.opts.quizLength);
+                    next(done ? StartQuiz : GetQuestion, std::chrono::milliseconds(0));
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+
+        std::chrono::milliseconds thinkTime() {
+            if (shared.opts.thinkMillis <= 0) return std::chrono::milliseconds(0);
+            // Exponential around the mean, capped at ten times it.
+            double u = rng.unit();
+            double millis = -std::log(1.0 - u) * shared.opts.thinkMillis;
+            return std::chrono::milliseconds(static_cast<long>(std::min(millis, 10.0 * shared.opts.thinkMillis)));
+        }
+
+        std::string chooseAnswer() {
+            const std::string type = currentQuestion.value("type", "");
+            std::string key;
+            if (!shared.lookupKey(currentQuestion.value("questionText", ""), key)) {
+                if (shared.measuring.load(std::memory_order_relaxed)) shared.guesses.fetch_add(1, std::memory_order_relaxed);
+                return guessAnswer(currentQuestion, rng);
+            }
+            return rng.unit() < shared.opts.accuracy ? key : wrongAnswer(type, key, rng);
+        }
+
+        void next(Route r, std::chrono::milliseconds delay) {
+            std::string body;
+            if (r == SubmitAnswer) {
+                json answer;
+                answer["answer"] = chooseAnswer();
+                body = answer.dump();
+            }
+            if (delay.count() == 0) {
+                send(r, body);
+                return;
+            }
+            auto self = shared_from_this();
+            timer.expires_after(delay);
+            timer.async_wait([self, r, body](const asio::error_code& ec) {
+                if (!ec) self->send(r, body);
+            });
+        }
+    };
+
+    void primeAnswerKey(Shared& shared, const std::string& file) {
+        QuestionBank bank;
+        bank.loadFromFile(file);
+        for (size_t id = 0; id < bank.size(); ++id) {
+            Question* q = bank.getQuestionById(static_cast<int>(id));
+            shared.learnKey(q->getQuestionText(), keyFromCorrectString(q->getQuestionType(), q->getCorrectAnswerString()));
+        }
+    }
+
+    void report(Shared& shared, double seconds) {
+        const Options& opts = shared.opts;
+        uint64_t answers = shared.answersCorrect.load() + shared.answersIncorrect.load();
+        if (opts.jsonOutput) {
+            json out;
+            out["learners"] = opts.learners;
+            out["seconds"] = seconds;
+            out["connects"] = shared.connects.load();
+            out["retries"] = shared.retries.load();
+            out["quizzes"] = shared.quizzes.load();
+            out["answers"] = answers;
+            out["observedAccuracy"] = answers ? static_cast<double>(shared.answersCorrect.load()) / answers : 0.0;
+            out["guesses"] = shared.guesses.load();
+            for (int r = 0; r < kRouteCount; ++r) {
+                LatencyHistogram::Snapshot s = shared.latency[r].snapshot();
+                json route;
+                route["requests"] = s.count;
+                route["errors"] = shared.errors[r].load();
+                route["throughput"] = seconds > 0 ? s.count / seconds : 0.0;
+                route["meanUs"] = s.mean() / 1000.0;
+                route["p50Us"] = s.percentile(0.50) / 1000.0;
+                route["p99Us"] = s.percentile(0.99) / 1000.0;
+                route["p999Us"] = s.percentile(0.999) / 1000.0;
+                route["maxUs"] = s.max / 1000.0;
+                out["routes"][kRoutePaths[r]] = route;
+            }
+            std::cout << out.dump(2) << std::endl;
+            return;
+        }
+
+        std::cout << opts.learners << " learners, " << std::fixed << std::setprecision(1) << seconds
+                  << " s measured, " << shared.connects.load() << " connects, " << shared.retries.load()
+                  << " keep-alive retries" << std::endl;
+        std::cout << std::left << std::setw(16) << "route" << std::right
+                  << std::setw(10) << "requests" << std::setw(8) << "errors" << std::setw(11) << "req/s"
+                  << std::setw(11) << "p50 us" << std::setw(11) << "p99 us" << std::setw(11) << "p99.9 us"
+                  << std::setw(11) << "max us" << std::endl;
+        uint64_t total = 0;
+        for (int r = 0; r < kRouteCount; ++r) {
+            LatencyHistogram::Snapshot s = shared.latency[r].snapshot();
+            total += s.count;
+            std::cout << std::left << std::setw(16) << kRoutePaths[r] << std::right
+                      << std::setw(10) << s.count << std::setw(8) << shared.errors[r].load()
+                      << std::setw(11) << std::setprecision(1) << (seconds > 0 ? s.count / seconds : 0.0)
+                      << std::setw(11) << s.percentile(0.50) / 1000.0
+                      << std::setw(11) << s.percentile(0.99) / 1000.0
+                      << std::setw(11) << s.percentile(0.999) / 1000.0
+                      << std::setw(11) << s.max / 1000.0 << std::endl;
+        }
+        std::cout << "Total " << std::setprecision(1) << (seconds > 0 ? total / seconds : 0.0) << " req/s; "
+                  << shared.quizzes.load() << " quizzes, " << answers << " answers ("
+                  << std::setprecision(3) << (answers ? static_cast<double>(shared.answersCorrect.load()) / answers : 0.0)
+                  << " correct, " << shared.guesses.load() << " guessed)" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Shared shared;
+    Options& opts = shared.opts;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--host=", 0) == 0) opts.host = arg.substr(7);
+        else if (arg.rfind("--port=", 0) == 0) opts.port = arg.substr(7);
+        else if (arg.rfind("--learners=", 0) == 0) opts.learners = std::max(1, std::atoi(arg.c_str() + 11));
+        else if (arg.rfind("--duration=", 0) == 0) opts.durationSeconds = std::max(1, std::atoi(arg.c_str() + 11));
+        else if (arg.rfind("--warmup=", 0) == 0) opts.warmupSeconds = std::max(0, std::atoi(arg.c_str() + 9));
+        else if (arg.rfind("--threads=", 0) == 0) opts.threads = std::max(1, std::atoi(arg.c_str() + 10));
+        else if (arg.rfind("--accuracy=", 0) == 0) opts.accuracy = std::atof(arg.c_str() + 11);
+        else if (arg.rfind("--think-ms=", 0) == 0) opts.thinkMillis = std::max(0, std::atoi(arg.c_str() + 11));
+        else if (arg.rfind("--quiz-length=", 0) == 0) opts.quizLength = std::max(0, std::atoi(arg.c_str() + 14));
+        else if (arg.rfind("--ramp-ms=", 0) == 0) opts.rampMillis = std::max(0, std::atoi(arg.c_str() + 10));
+        else if (arg.rfind("--questions=", 0) == 0) opts.questionFile = arg.substr(12);
+        else if (arg.rfind("--seed=", 0) == 0) opts.seed = std::strtoull(arg.c_str() + 7, nullptr, 10);
+        else if (arg == "--format=json") opts.jsonOutput = true;
+        else if (arg == "--format=table") opts.jsonOutput = false;
+        else std::cerr << "Ignoring unknown option: " << arg << std::endl;
+    }
+
+    if (!opts.questionFile.empty()) {
+        primeAnswerKey(shared, opts.questionFile);
+    }
+
+    asio::io_context io;
+    try {
+        tcp::resolver resolver(io);
+        shared.endpoint = *resolver.resolve(opts.host, opts.port).begin();
+    } catch (const std::exception& e) {
+        std::cerr << "Cannot resolve " << opts.host << ":" << opts.port << ": " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::vector<std::shared_ptr<Learner>> learners;
+    for (int i = 0; i < opts.learners; ++i) {
+        learners.push_back(std::make_shared<Learner>(io, shared, i));
+        learners.back()->start(std::chrono::milliseconds(
+            opts.learners > 1 ? static_cast<long>(opts.rampMillis) * i / (opts.learners - 1) : 0));
+    }
+
+    // Phase timers: start measuring after the warmup, stop after the run.
+    std::chrono::steady_clock::time_point measureStart, measureEnd;
+    asio::steady_timer warmup(io), finish(io);
+    warmup.expires_after(std::chrono::seconds(opts.warmupSeconds));
+    warmup.async_wait([&](const asio::error_code&) {
+        measureStart = std::chrono::steady_clock::now();
+        shared.measuring.store(true);
+        std::cerr << "Measuring for " << opts.durationSeconds << " s..." << std::endl;
+    });
+    finish.expires_after(std::chrono::seconds(opts.warmupSeconds + opts.durationSeconds));
+    finish.async_wait([&](const asio::error_code&) {
+        measureEnd = std::chrono::steady_clock::now();
+        shared.measuring.store(false);
+        shared.stopping.store(true);
+        for (auto& learner : learners) {
+            learner->stop();
+        }
+    });
+
+    std::cerr << "Ramping up " << opts.learners << " learners over " << opts.rampMillis << " ms against "
+              << opts.host << ":" << opts.port << std::endl;
+    std::vector<std::thread> workers;
+    for (int t = 1; t < opts.threads; ++t) {
+        workers.emplace_back([&io]() { io.run(); });
+    }
+    io.run();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    report(shared, std::chrono::duration<double>(measureEnd - measureStart).count());
+    return 0;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file log_bench.cpp
+ * @brief Per-call latency of request logging under load: std::cout with
+ * std::endl (the old path) against the asynchronous Logger, with and
+ * without request-line sampling.
+ *
+ * Every thread behaves like a Crow worker: it does some work (a spin of
+ * --work-us microseconds, standing in for a request) and then logs a
+ * "SERVER LOG" line. Only the logging call is timed. All modes write to
+ * the same file, so the comparison is not skewed by the terminal.
+ *
+ * Build (from the backend folder):
+ *   g++ -std=c++17 -O2 -I. tools/log_bench.cpp Logger.cpp LatencyHistogram.cpp -o log_bench -lpthread
+ *
+ * Usage: log_bench [--threads=N] [--lines=N] [--work-us=N] [--out=log_bench.out]
+ */
+#include "../Logger.h"
+#include "../LatencyHistogram.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    enum Mode { CoutEndl, Async, AsyncSampled };
+
+    void spinFor(std::chrono::microseconds duration) {
+        auto until = std::chrono::steady_clock::now() + duration;
+        while (std::chrono::steady_clock::now() < until) {}
+    }
+
+    /**
+     * Runs every thread to completion; returns wall-clock seconds.
+     */
+    double runMode(Mode mode, int threads, int lines, int workMicros, LatencyHistogram& latency) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([=, &latency]() {
+                for (int i = 0; i < lines; ++i) {
+                    spinFor(std::chrono::microseconds(workMicros));
+                    auto before = std::chrono::steady_clock::now();
+                    if (mode == CoutEndl) {
+                        std::cout << "SERVER LOG: /submit_answer called. User answered 'answer " << i
+                                  << "'. Correct: " << (i % 2 ? "yes" : "no") << std::endl;
+                    } else {
+                        LOG_REQUEST("SERVER LOG: /submit_answer called. User answered 'answer " << i
+                                    << "'. Correct: " << (i % 2 ? "yes" : "no"));
+                    }
+                    latency.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - before).count()));
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int threads = 4;
+    int lines = 50000;
+    int workMicros = 20;
+    std::string outFile = "log_bench.out";
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--threads=", 0) == 0) threads = std::atoi(arg.c_str() + 10);
+        else if (arg.rfind("--lines=", 0) == 0) lines = std::atoi(arg.c_str() + 8);
+        else if (arg.rfind("--work-us=", 0) == 0) workMicros = std::atoi(arg.c_str() + 10);
+        else if (arg.rfind("--out=", 0) == 0) outFile = arg.substr(6);
+        else std::cerr << "Ignoring unknown option: " << arg << std::endl;
+    }
+
+    std::cout << threads << " threads x " << lines << " lines, " << workMicros
+              << " us of work per line, output to " << outFile << std::endl;
+    std::cout << std::left << std::setw(22) << "mode"
+              << std::setw(12) << "p50 ns" << std::setw(12) << "p99 ns"
+              << std::setw(12) << "p99.9 ns" << std::setw(12) << "max ns"
+              << std::setw(14) << "lines/s" << std::setw(10) << "dropped"
+              << "sampled out" << std::endl;
+
+    const char* names[] = {"cout + endl", "async", "async, 50/s sampled"};
+    for (Mode mode : {CoutEndl, Async, AsyncSampled}) {
+        std::ofstream truncate(outFile, std::ios::trunc);
+        truncate.close();
+
+        uint64_t droppedBefore = Logger::droppedCount();
+        uint64_t suppressedBefore = Logger::suppressedCount();
+        LatencyHistogram latency;
+        double seconds = 0.0;
+        if (mode == CoutEndl) {
+            std::ofstream out(outFile, std::ios::app);
+            std::streambuf* console = std::cout.rdbuf(out.rdbuf());
+            seconds = runMode(mode, threads, lines, workMicros, latency);
+            std::cout.rdbuf(console);
+        } else {
+            Logger::start(Logger::Info, mode == AsyncSampled ? 50.0 : 0.0, outFile);
+            seconds = runMode(mode, threads, lines, workMicros, latency);
+            Logger::stop();
+        }
+
+        LatencyHistogram::Snapshot s = latency.snapshot();
+        std::cout << std::left << std::setw(22) << names[mode]
+                  << std::setw(12) << s.percentile(0.50) << std::setw(12) << s.percentile(0.99)
+                  << std::setw(12) << s.percentile(0.999) << std::setw(12) << s.max
+                  << std::setw(14) << static_cast<uint64_t>(s.count / seconds)
+                  << std::setw(10) << Logger::droppedCount() - droppedBefore
+                  << Logger::suppressedCount() - suppressedBefore << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,386 @@
+/**
+ * @file micro_bench.cpp
+ * @brief Microbenchmarks for the core quiz operations on synthetic banks:
+ * loading, every getQuestion fallback level, getRandomTopic, each
+ * checkAnswer implementation, the UserStats hot calls and response
+ * serialization.
+ *
+ * Each benchmark is sized to run for about --min-time-ms, split over
+ * --repeat timed runs; the median and fastest run are reported in
+ * nanoseconds per operation. Results go to stdout, one JSON object per
+ * line (or an aligned table with --format=table), so runs can be diffed
+ * and tracked; progress goes to stderr.
+ *
+ * Build (from the backend folder):
+ *   g++ -std=c++17 -O2 -I. tools/micro_bench.cpp SessionToken.cpp HmacSha256.cpp UserStats.cpp QuestionBank.cpp MultipleChoiceQuestion.cpp TrueFalseQuestion.cpp FillInTheBlankQuestion.cpp KnowledgeTracing.cpp ItemResponseTheory.cpp EloRating.cpp ThompsonSampling.cpp SpacedRepetition.cpp TopicTrend.cpp TimingWheel.cpp ExposureControl.cpp Logger.cpp Metrics.cpp LatencyHistogram.cpp BucketInventory.cpp -o micro_bench -lpthread
+ *
+ * Usage: micro_bench [--sizes=1000,100000] [--topics=20] [--seed=42]
+ *                    [--min-time-ms=300] [--repeat=5] [--filter=substring]
+ *                    [--dir=/tmp] [--format=json|table]
+ */
+#include "../QuestionBank.h"
+#include "../UserStats.h"
+#include "../SessionToken.h"
+#include "../SpacedRepetition.h"
+#include "../BinaryIO.h"
+#include "../json.hpp"
+#include "SyntheticBank.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace {
+    struct Options {
+        std::vector<uint64_t> sizes{1000, 100000};
+        int topics = 20;
+        uint64_t seed = 42;
+        int minTimeMillis = 300;
+        int repeat = 5;
+        std::string filter;
+        std::string dir = "/tmp";
+        bool table = false;
+    };
+
+    struct Result {
+        std::string name;
+        uint64_t bankSize = 0;
+        uint64_t iterations = 0; // Per timed run
+        double medianNs = 0;
+        double minNs = 0;
+    };
+
+    // Results are folded in here so the compiler cannot drop the work.
+    volatile uint64_t sink = 0;
+
+    template <typename Op>
+    double timeLoop(uint64_t n, Op op) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < n; ++i) {
+            op(i);
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /**
+     * Runs one benchmark. 'batch' performs n operations and returns the
+     * nanoseconds they took, so per-batch setup can stay outside the timing.
+     */
+    Result measure(const Options& opts, const std::string& name, uint64_t bankSize,
+                   const std::function<double(uint64_t)>& batch) {
+        // Estimate the cost per operation, then size the timed runs from it.
+        uint64_t probe = 1;
+        double probeNs = batch(probe);
+        while (probeNs < 1e6 && probe < (1ULL << 30)) {
+            probe *= 4;
+            probeNs = batch(probe);
+        }
+        double perOp = std::max(probeNs / probe, 1.0);
+        double budgetNs = opts.minTimeMillis * 1e6 / opts.repeat;
+        uint64_t iterations = std::max<uint64_t>(1, static_cast<uint64_t>(budgetNs / perOp));
+
+        std::vector<double> runs;
+        for (int r = 0; r < opts.repeat; ++r) {
+            runs.push_back(batch(iterations) / iterations);
+        }
+        std::sort(runs.begin(), runs.end());
+
+        Result result;
+        result.name = name;
+        result.bankSize = bankSize;
+        result.iterations = iterations;
+        result.medianNs = runs[runs.size() / 2];
+        result.minNs = runs.front();
+        return result;
+    }
+
+    void report(const Options& opts, const Result& r) {
+        if (opts.table) {
+            std::cout << std::left << std::setw(34) << r.name << std::right
+                      << std::setw(10) << r.bankSize
+                      << std::setw(12) << r.iterations
+                      << std::setw(14) << std::fixed << std::setprecision(1) << r.medianNs
+                      << std::setw(14) << r.minNs << std::endl;
+            return;
+        }
+        json line;
+        line["benchmark"] = r.name;
+        line["bankSize"] = r.bankSize;
+        line["topics"] = opts.topics;
+        line["seed"] = opts.seed;
+        line["iterations"] = r.iterations;
+        line["repeats"] = opts.repeat;
+        line["nsPerOpMedian"] = r.medianNs;
+        line["nsPerOpMin"] = r.minNs;
+        line["opsPerSecond"] = r.medianNs > 0 ? 1e9 / r.medianNs : 0.0;
+        std::cout << line.dump() << std::endl;
+    }
+
+    bool selected(const Options& opts, const std::string& name) {
+        return opts.filter.empty() || name.find(opts.filter) != std::string::npos;
+    }
+
+    // QuestionBank::loadFromFile reports to std::cout; keep stdout for results.
+    class QuietCout {
+        std::ostringstream discard;
+        std::streambuf* saved;
+
+    public:
+        QuietCout() : saved(std::cout.rdbuf(discard.rdbuf())) {}
+        ~QuietCout() { std::cout.rdbuf(saved); }
+    };
+
+    // First question of the given type, or nullptr.
+    Question* firstOfType(const QuestionBank& bank, const std::string& type) {
+        for (size_t id = 0; id < bank.size(); ++id) {
+            Question* q = bank.getQuestionById(static_cast<int>(id));
+            if (q->getQuestionType() == type) return q;
+        }
+        return nullptr;
+    }
+
+    // A session that has answered 'answers' questions across the bank.
+    void playSession(UserStats& user, QuestionBank& bank, int answers) {
+        for (int i = 0; i < answers && static_cast<size_t>(i) < bank.size(); ++i) {
+            Question* q = bank.getQuestionById(static_cast<int>((i * 7919ULL) % bank.size()));
+            user.setLastQuestion(q);
+            user.updateStats(q->getTopic(), i % 3 != 0);
+            user.getReviews().recordAnswer(q->getId(), i % 3 != 0, ReviewScheduler::nowMinutes());
+        }
+    }
+
+    void runSuite(const Options& opts, uint64_t size) {
+        SyntheticBankOptions bankOpts;
+        bankOpts.questions = size;
+        bankOpts.topics = opts.topics;
+        bankOpts.seed = opts.seed;
+        std::string path = opts.dir + "/micro_bench_" + std::to_string(size) + "_" + std::to_string(opts.seed) + ".txt";
+        {
+            std::ofstream out(path);
+            if (!out) {
+                std::cerr << "Cannot write " << path << "; skipping bank size " << size << std::endl;
+                return;
+            }
+            writeSyntheticBank(out, bankOpts);
+        }
+        std::cerr << "Bank of " << size << " questions: " << path << std::endl;
+
+        // --- Loading: one parse per operation, so time whole loads. ---
+        if (selected(opts, "load_from_file")) {
+            std::vector<double> runs;
+            for (int r = 0; r < opts.repeat; ++r) {
+                QuietCout quiet;
+                QuestionBank scratch;
+                auto start = std::chrono::steady_clock::now();
+                scratch.loadFromFile(path);
+                runs.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+                sink = sink + scratch.size();
+            }
+            std::sort(runs.begin(), runs.end());
+            Result r;
+            r.name = "load_from_file";
+            r.bankSize = size;
+            r.iterations = 1;
+            r.medianNs = runs[runs.size() / 2];
+            r.minNs = runs.front();
+            report(opts, r);
+        }
+
+        QuestionBank bank;
+        {
+            QuietCout quiet;
+            bank.loadFromFile(path);
+        }
+        if (bank.size() == 0) {
+            std::cerr << "No questions loaded from " << path << std::endl;
+            return;
+        }
+        const std::string topic = bank.getTopics().front();
+        auto bench = [&](const std::string& name, const std::function<double(uint64_t)>& batch) {
+            if (selected(opts, name)) report(opts, measure(opts, name, size, batch));
+        };
+
+        // --- getQuestion, one benchmark per fallback level ---
+        std::vector<bool> noneUsed(bank.size(), false);
+        std::vector<bool> topicUsed(bank.size(), false);
+        for (size_t id = 0; id < bank.size(); ++id) {
+            topicUsed[id] = bank.getQuestionById(static_cast<int>(id))->getTopic() == topic;
+        }
+        std::vector<bool> allUsed(bank.size(), true);
+
+        bench("get_question/due_review", [&](uint64_t n) {
+            // Pops consume reviews, so each chunk schedules fresh overdue
+            // cards (untimed) and then takes them one by one.
+            double ns = 0;
+            for (uint64_t done = 0; done < n;) {
+                uint64_t chunk = std::min<uint64_t>(n - done, bank.size());
+                ReviewScheduler reviews;
+                uint64_t past = ReviewScheduler::nowMinutes() - ReviewScheduler::kRelearnMinutes - 1;
+                for (uint64_t i = 0; i < chunk; ++i) {
+                    reviews.recordAnswer(static_cast<int>(i), false, past);
+                }
+                ns += timeLoop(chunk, [&](uint64_t) {
+                    sink = sink + bank.getQuestion(topic, 2.0, noneUsed, &reviews)->getId();
+                });
+                done += chunk;
+            }
+            return ns;
+        });
+        bench("get_question/within_band", [&](uint64_t n) {
+            return timeLoop(n, [&](uint64_t i) {
+                sink = sink + bank.getQuestion(topic, 1.0 + (i % 3), noneUsed)->getId();
+            });
+        });
+        bench("get_question/nearest_in_topic", [&](uint64_t n) {
+            // Nothing lies within the band of difficulty 10.
+            return timeLoop(n, [&](uint64_t) {
+                sink = sink + bank.getQuestion(topic, 10.0, noneUsed)->getId();
+            });
+        });
+        bench("get_question/any_topic", [&](uint64_t n) {
+            return timeLoop(n, [&](uint64_t) {
+                sink = sink + bank.getQuestion(topic, 2.0, topicUsed)->getId();
+            });
+        });
+        bench("get_question/random_repeat", [&](uint64_t n) {
+            return timeLoop(n, [&](uint64_t) {
+                sink = sink + bank.getQuestion(topic, 2.0, allUsed)->getId();
+            });
+        });
+
+        bench("get_random_topic", [&](uint64_t n) {
+            return timeLoop(n, [&](uint64_t) { sink = sink + bank.getRandomTopic().size(); });
+        });
+
+        // --- checkAnswer, per question type ---
+        if (Question* mc = firstOfType(bank, "MC")) {
+            std::string option = mc->getCorrectAnswerString(); // "B. some text"
+            std::string letter = option.substr(0, 1);
+            std::string optionText = option.size() > 3 ? option.substr(3) : option;
+            std::string wrong = letter == "A" ? "b" : "a";
+            bench("check_answer/mc_letter", [&](uint64_t n) {
+                return timeLoop(n, [&](uint64_t) { sink = sink + mc->checkAnswer(letter); });
+            });
+            bench("check_answer/mc_option_text", [&](uint64_t n) {
+                return timeLoop(n, [&](uint64_t) { sink = sink + mc->checkAnswer(optionText); });
+            });
+            bench("check_answer/mc_wrong", [&](uint64_t n) {
+                return timeLoop(n, [&](uint64_t) { sink = sink + mc->checkAnswer(wrong); });
+            });
+        }
+        if (Question* tf = firstOfType(bank, "TF")) {
+            bench("check_answer/tf", [&](uint64_t n) {
+                return timeLoop(n, [&](uint64_t i) { sink = sink + tf->checkAnswer(i % 2 ? "True" : "f"); });
+            });
+        }
+        if (Question* fib = firstOfType(bank, "FIB")) {
+            std::string answer = "  " + fib->getCorrectAnswerString() + " ";
+            bench("check_answer/fib", [&](uint64_t n) {
+                return timeLoop(n, [&](uint64_t) { sink = sink + fib->checkAnswer(answer); });
+            });
+        }
+
+        // --- UserStats ---
+        const std::vector<std::string>& topics = bank.getTopics();
+        bench("user_stats/update_stats", [&](uint64_t n) {
+            UserStats user("BenchUser");
+            return timeLoop(n, [&](uint64_t i) { user.updateStats(topics[i % topics.size()], i % 3 != 0); });
+        });
+
+        UserStats session("BenchUser");
+        playSession(session, bank, 200);
+        bench("user_stats/get_weakest_topic", [&](uint64_t n) {
+            return timeLoop(n, [&](uint64_t) { sink = sink + session.getWeakestTopic().size(); });
+        });
+        bench("user_stats/get_stats_json", [&](uint64_t n) {
+            return timeLoop(n, [&](uint64_t) { sink = sink + session.getStatsJson().size(); });
+        });
+
+        // --- Response serialization ---
+        Question* served = bank.getQuestionById(0);
+        bench("serialize/question_response", [&](uint64_t n) {
+            // The body /get_question builds, dumped as Crow would send it.
+            return timeLoop(n, [&](uint64_t) {
+                json q;
+                q["questionText"] = served->getQuestionText();
+                q["topic"] = served->getTopic();
+                q["difficulty"] = served->getDifficulty();
+                q["type"] = served->getQuestionType();
+                q["options"] = served->getOptions();
+                sink = sink + q.dump().size();
+            });
+        });
+        bench("serialize/stats_response", [&](uint64_t n) {
+            return timeLoop(n, [&](uint64_t) { sink = sink + session.getStatsJson().dump().size(); });
+        });
+        bench("serialize/session_checkpoint", [&](uint64_t n) {
+            return timeLoop(n, [&](uint64_t) {
+                ByteWriter out;
+                session.serialize(out);
+                sink = sink + out.size();
+            });
+        });
+        SessionTokenCodec codec("benchmark-secret", 1 << 20);
+        bench("serialize/session_token", [&](uint64_t n) {
+            return timeLoop(n, [&](uint64_t) { sink = sink + codec.encode(session, bank).size(); });
+        });
+
+        std::remove(path.c_str());
+    }
+
+    std::vector<uint64_t> parseSizes(const std::string& list) {
+        std::vector<uint64_t> sizes;
+        std::stringstream ss(list);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            uint64_t size = std::strtoull(item.c_str(), nullptr, 10);
+            if (size > 0) sizes.push_back(size);
+        }
+        return sizes;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options opts;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--sizes=", 0) == 0) opts.sizes = parseSizes(arg.substr(8));
+        else if (arg.rfind("--topics=", 0) == 0) opts.topics = std::max(1, std::atoi(arg.c_str() + 9));
+        else if (arg.rfind("--seed=", 0) == 0) opts.seed = std::strtoull(arg.c_str() + 7, nullptr, 10);
+        else if (arg.rfind("--min-time-ms=", 0) == 0) opts.minTimeMillis = std::max(1, std::atoi(arg.c_str() + 14));
+        else if (arg.rfind("--repeat=", 0) == 0) opts.repeat = std::max(1, std::atoi(arg.c_str() + 9));
+        else if (arg.rfind("--filter=", 0) == 0) opts.filter = arg.substr(9);
+        else if (arg.rfind("--dir=", 0) == 0) opts.dir = arg.substr(6);
+        else if (arg == "--format=table") opts.table = true;
+        else if (arg == "--format=json") opts.table = false;
+        else std::cerr << "Ignoring unknown option: " << arg << std::endl;
+    }
+    if (opts.sizes.empty()) {
+        std::cerr << "No bank sizes to run (--sizes=1000,100000)." << std::endl;
+        return 1;
+    }
+
+    // Same selection sequence on every run.
+    srand(static_cast<unsigned int>(opts.seed));
+
+    if (opts.table) {
+        std::cout << std::left << std::setw(34) << "benchmark" << std::right
+                  << std::setw(10) << "bank"
+                  << std::setw(12) << "iters"
+                  << std::setw(14) << "median ns/op"
+                  << std::setw(14) << "min ns/op" << std::endl;
+    }
+    for (uint64_t size : opts.sizes) {
+        runSuite(opts, size);
+    }
+    return 0;
+}
@@ -0,0 +1,418 @@
+/**
+ * @file perf_check.cpp
+ * @brief Performance regression gate: runs micro_bench and load_gen
+ * against a server on a fixed synthetic bank and seed, then compares every
+ * figure with the committed baseline (tools/perf_baseline.json) and exits
+ * non-zero if any falls outside its tolerance band.
+ *
+ * Gated figures:
+ *   startup.ready_ms         spawn to accepting connections (includes the bank load)
+ *   server.peak_rss_kb       the server's peak resident set over the whole run
+ *   load.throughput_rps      closed-loop requests per second, all routes
+ *   load.<route>.p99_us / .p999_us   tail latency per route
+ *   micro.<benchmark>.ns_per_op      fastest repeat of each microbenchmark
+ *
+ * Each baseline entry has a value, a direction ("lower" or "higher" is
+ * better) and a relative tolerance; 0.25 allows 25% drift in the bad
+ * direction. The baseline's "config" block fixes the bank, seed and load
+ * shape, so runs stay comparable, and sets how many attempts a figure gets
+ * to come back inside its band before it counts as a regression. Baselines are machine-specific: after a
+ * deliberate change, or on a new reference machine, rerun with --update
+ * to rewrite the values (tolerances are kept).
+ *
+ * POSIX only (fork/exec, wait4 for the server's peak RSS).
+ *
+ * Build (from the backend folder; micro_bench, load_gen and the server are
+ * built as usual):
+ *   g++ -std=c++17 -O2 -I. tools/perf_check.cpp -o perf_check
+ *
+ * Usage: perf_check [--baseline=tools/perf_baseline.json] [--server=./quiz_server]
+ *                   [--micro-bench=./micro_bench] [--load-gen=./load_gen]
+ *                   [--dir=/tmp] [--port=18181] [--update]
+ */
+#include "../json.hpp"
+#include "SyntheticBank.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace {
+    struct Paths {
+        std::string baseline = "tools/perf_baseline.json";
+        std::string server = "./quiz_server";
+        std::string microBench = "./micro_bench";
+        std::string loadGen = "./load_gen";
+        std::string dir = "/tmp";
+        int port = 18181;
+        bool update = false;
+    };
+
+    // Defaults for a baseline file that does not exist yet.
+    json defaultConfig() {
+        json config;
+        config["questions"] = 50000;
+        config["topics"] = 20;
+        config["seed"] = 42;
+        config["learners"] = 200;
+        config["durationSeconds"] = 10;
+        config["warmupSeconds"] = 2;
+        config["thinkMillis"] = 0;
+        config["loadThreads"] = 1;
+        config["microMinTimeMillis"] = 300;
+        config["microRepeat"] = 5;
+        config["attempts"] = 3;
+        return config;
+    }
+
+    // Default tolerance per figure family; microbenchmarks and tails are noisier.
+    double defaultTolerance(const std::string& metric) {
+        if (metric.rfind("micro.", 0) == 0) return 0.30;
+        if (metric.find(".p99") != std::string::npos) return 0.50;
+        if (metric == "server.peak_rss_kb") return 0.15;
+        return 0.25;
+    }
+
+    // Records a figure, keeping the better value if an earlier attempt measured it too.
+    void record(json& results, const std::string& metric, double value, const char* better) {
+        if (results.contains(metric)) {
+            double previous = results[metric]["value"].get<double>();
+            bool lowerIsBetter = std::string(better) == "lower";
+            if (lowerIsBetter ? previous <= value : previous >= value) return;
+        }
+        results[metric] = {{"value", value}, {"better", better}};
+    }
+
+    // Runs a command and returns its stdout (stderr passes through).
+    bool capture(const std::string& command, std::string& output) {
+        std::FILE* pipe = popen(command.c_str(), "r");
+        if (pipe == nullptr) return false;
+        char buf[4096];
+        size_t n;
+        while ((n = std::fread(buf, 1, sizeof(buf), pipe)) > 0) {
+            output.append(buf, n);
+        }
+        return pclose(pipe) == 0;
+    }
+
+    bool portOpen(int port) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) return false;
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bool open = connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+        close(fd);
+        return open;
+    }
+
+    /**
+     * Starts the server with its output in dir/perf_server.log.
+     * @return The child's pid, or -1.
+     */
+    pid_t startServer(const Paths& paths, const std::string& bankFile) {
+        std::string log = paths.dir + "/perf_server.log";
+        std::vector<std::string> args = {
+            paths.server,
+            "--questions=" + bankFile,
+            "--overlay=",
+            "--port=" + std::to_string(paths.port),
+            "--checkpoint=" + paths.dir + "/perf_state.ckpt",
+            "--checkpoint-interval=0",
+            "--answer-log=",
+            "--session-sweep=0",
+            "--cold-dir=" + paths.dir + "/perf_sessions_cold",
+            "--log-level=warn",
+        };
+        pid_t pid = fork();
+        if (pid == 0) {
+            int fd = open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd >= 0) {
+                dup2(fd, STDOUT_FILENO);
+                dup2(fd, STDERR_FILENO);
+                close(fd);
+            }
+            std::vector<char*> argv;
+            for (auto& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+            argv.push_back(nullptr);
+            execv(argv[0], argv.data());
+            _exit(127);
+        }
+        return pid;
+    }
+
+    /**
+     * Stops the server and returns its peak RSS in KiB (-1 on failure).
+     */
+    long stopServer(pid_t pid) {
+        kill(pid, SIGINT);
+        int status = 0;
+        rusage usage{};
+        for (int waited = 0; waited < 1000; ++waited) {
+            pid_t done = wait4(pid, &status, WNOHANG, &usage);
+            if (done == pid) return usage.ru_maxrss; // KiB on Linux
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        std::cerr << "Server ignored SIGINT for 10 s; killing it." << std::endl;
+        kill(pid, SIGKILL);
+        return wait4(pid, &status, 0, &usage) == pid ? usage.ru_maxrss : -1;
+    }
+
+    bool runServerAndLoad(const Paths& paths, const json& config, const std::string& bankFile, json& results) {
+        auto spawned = std::chrono::steady_clock::now();
+        pid_t pid = startServer(paths, bankFile);
+        if (pid < 0) {
+            std::cerr << "Could not start " << paths.server << std::endl;
+            return false;
+        }
+        bool ready = false;
+        while (!ready && std::chrono::steady_clock::now() - spawned < std::chrono::seconds(120)) {
+            int status;
+            if (waitpid(pid, &status, WNOHANG) == pid) {
+                std::cerr << paths.server << " exited during startup; see " << paths.dir << "/perf_server.log" << std::endl;
+                return false;
+            }
+            ready = portOpen(paths.port);
+            if (!ready) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        if (!ready) {
+            std::cerr << "Server not accepting connections after 120 s." << std::endl;
+            stopServer(pid);
+            return false;
+        }
+        record(results, "startup.ready_ms",
+               std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - spawned).count(), "lower");
+
+        std::ostringstream command;
+        command << paths.loadGen << " --port=" << paths.port << " --learners=" << config["learners"].get<int>()
+                << " --duration=" << config["durationSeconds"].get<int>()
+                << " --warmup=" << config["warmupSeconds"].get<int>()
+                << " --think-ms=" << config["thinkMillis"].get<int>()
+                << " --threads=" << config["loadThreads"].get<int>()
+                << " --seed=" << config["seed"].get<uint64_t>()
+                << " --questions=" << bankFile << " --ramp-ms=500 --format=json";
+        std::string output;
+        bool ok = capture(command.str(), output);
+        long peakKb = stopServer(pid);
+        if (!ok) {
+            std::cerr << "load_gen failed: " << command.str() << std::endl;
+            return false;
+        }
+
+        json load = json::parse(output.substr(std::min(output.find('{'), output.size())), nullptr, false);
+        if (load.is_discarded() || !load.contains("routes")) {
+            std::cerr << "Could not parse load_gen output." << std::endl;
+            return false;
+        }
+        double total = 0;
+        for (auto& route : load["routes"].items()) {
+            total += route.value()["throughput"].get<double>();
+            if (route.value()["errors"].get<uint64_t>() > 0) {
+                std::cerr << "Warning: " << route.value()["errors"] << " errors on " << route.key() << std::endl;
+            }
+            record(results, "load." + route.key() + ".p99_us", route.value()["p99Us"].get<double>(), "lower");
+            record(results, "load." + route.key() + ".p999_us", route.value()["p999Us"].get<double>(), "lower");
+        }
+        record(results, "load.throughput_rps", total, "higher");
+        if (peakKb > 0) record(results, "server.peak_rss_kb", static_cast<double>(peakKb), "lower");
+        return true;
+    }
+
+    bool runMicroBench(const Paths& paths, const json& config, json& results) {
+        std::ostringstream command;
+        command << paths.microBench << " --sizes=" << config["questions"].get<uint64_t>()
+                << " --topics=" << config["topics"].get<int>() << " --seed=" << config["seed"].get<uint64_t>()
+                << " --min-time-ms=" << config["microMinTimeMillis"].get<int>()
+                << " --repeat=" << config["microRepeat"].get<int>() << " --dir=" << paths.dir << " --format=json";
+        std::string output;
+        if (!capture(command.str(), output)) {
+            std::cerr << "micro_bench failed: " << command.str() << std::endl;
+            return false;
+        }
+        std::istringstream lines(output);
+        std::string line;
+        while (std::getline(lines, line)) {
+            json result = json::parse(line, nullptr, false);
+            if (result.is_discarded() || !result.contains("benchmark")) continue;
+            record(results, "micro." + result["benchmark"].get<std::string>() + ".ns_per_op",
+                   result["nsPerOpMin"].get<double>(), "lower");
+        }
+        return true;
+    }
+
+    /**
+     * Relative drift of 'current' from the baseline entry in the bad
+     * direction (negative when it improved).
+     */
+    double worsening(const json& base, double current) {
+        double value = base["value"].get<double>();
+        double change = value != 0 ? (current - value) / value : 0.0;
+        return base.value("better", "lower") == "lower" ? change : -change;
+    }
+
+    int countRegressions(const json& baseline, const json& results) {
+        int regressions = 0;
+        for (auto& entry : baseline.items()) {
+            if (!results.contains(entry.key()) ||
+                worsening(entry.value(), results[entry.key()]["value"].get<double>()) >
+                    entry.value().value("tolerance", defaultTolerance(entry.key()))) {
+                regressions++;
+            }
+        }
+        return regressions;
+    }
+
+    /**
+     * Prints the comparison table.
+     * @return The number of figures outside their band.
+     */
+    int compare(const json& baseline, const json& results) {
+        int regressions = 0;
+        std::cout << std::left << std::setw(44) << "metric" << std::right << std::setw(14) << "baseline"
+                  << std::setw(14) << "current" << std::setw(9) << "change" << std::setw(8) << "band" << "  status"
+                  << std::endl;
+        for (auto& entry : results.items()) {
+            const std::string& metric = entry.key();
+            double current = entry.value()["value"].get<double>();
+            std::cout << std::left << std::setw(44) << metric << std::right;
+            if (!baseline.contains(metric)) {
+                std::cout << std::setw(14) << "-" << std::setw(14) << std::fixed << std::setprecision(1) << current
+                          << std::setw(9) << "" << std::setw(8) << "" << "  new (not gated)" << std::endl;
+                continue;
+            }
+            const json& base = baseline[metric];
+            double value = base["value"].get<double>();
+            double tolerance = base.value("tolerance", defaultTolerance(metric));
+            double change = value != 0 ? (current - value) / value : 0.0;
+            double worse = worsening(base, current);
+            const char* status = "ok";
+            if (worse > tolerance) {
+                status = "REGRESSION";
+                regressions++;
+            } else if (-worse > tolerance) {
+                status = "improved (consider --update)";
+            }
+            std::cout << std::setw(14) << std::fixed << std::setprecision(1) << value << std::setw(14) << current
+                      << std::setw(8) << std::showpos << change * 100.0 << "%" << std::noshowpos
+                      << std::setw(7) << tolerance * 100.0 << "%" << "  " << status << std::endl;
+        }
+        for (auto& entry : baseline.items()) {
+            if (!results.contains(entry.key())) {
+                std::cout << std::left << std::setw(44) << entry.key() << "  missing from this run" << std::endl;
+                regressions++;
+            }
+        }
+        return regressions;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Paths paths;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--baseline=", 0) == 0) paths.baseline = arg.substr(11);
+        else if (arg.rfind("--server=", 0) == 0) paths.server = arg.substr(9);
+        else if (arg.rfind("--micro-bench=", 0) == 0) paths.microBench = arg.substr(14);
+        else if (arg.rfind("--load-gen=", 0) == 0) paths.loadGen = arg.substr(11);
+        else if (arg.rfind("--dir=", 0) == 0) paths.dir = arg.substr(6);
+        else if (arg.rfind("--port=", 0) == 0) paths.port = std::atoi(arg.c_str() + 7);
+        else if (arg == "--update") paths.update = true;
+        else std::cerr << "Ignoring unknown option: " << arg << std::endl;
+    }
+
+    json baselineFile;
+    {
+        std::ifstream in(paths.baseline);
+        if (in) baselineFile = json::parse(in, nullptr, false);
+        if (baselineFile.is_discarded()) {
+            std::cerr << "Error: " << paths.baseline << " is not valid JSON." << std::endl;
+            return 2;
+        }
+        if (!in && !paths.update) {
+            std::cerr << "Error: No baseline at " << paths.baseline << "; run with --update to create one." << std::endl;
+            return 2;
+        }
+    }
+    json config = defaultConfig();
+    if (baselineFile.contains("config")) config.update(baselineFile["config"]);
+    json baseline = baselineFile.contains("metrics") ? baselineFile["metrics"] : json::object();
+
+    // The fixed bank: the same options micro_bench generates from.
+    SyntheticBankOptions bankOpts;
+    bankOpts.questions = config["questions"].get<uint64_t>();
+    bankOpts.topics = config["topics"].get<int>();
+    bankOpts.seed = config["seed"].get<uint64_t>();
+    std::string bankFile = paths.dir + "/perf_bank_" + std::to_string(bankOpts.questions) + "_" +
+                           std::to_string(bankOpts.seed) + ".txt";
+    {
+        std::ofstream out(bankFile);
+        if (!out) {
+            std::cerr << "Error: Could not write " << bankFile << std::endl;
+            return 2;
+        }
+        writeSyntheticBank(out, bankOpts);
+    }
+
+    // On a shared machine one noisy run should not fail the gate: while
+    // figures are out of band, measure again and keep each figure's best.
+    json results = json::object();
+    int attempts = paths.update ? 1 : std::max(1, config["attempts"].get<int>());
+    for (int attempt = 1; attempt <= attempts; ++attempt) {
+        std::cerr << "Attempt " << attempt << "/" << attempts << ": server + load_gen (" << config["learners"]
+                  << " learners, " << config["durationSeconds"] << " s) on " << bankFile << "..." << std::endl;
+        if (!runServerAndLoad(paths, config, bankFile, results)) return 2;
+        std::cerr << "micro_bench..." << std::endl;
+        if (!runMicroBench(paths, config, results)) return 2;
+        int outOfBand = countRegressions(baseline, results);
+        if (outOfBand == 0) break;
+        if (attempt < attempts) std::cerr << outOfBand << " figure(s) out of band; measuring again." << std::endl;
+    }
+    std::remove(bankFile.c_str());
+
+    if (paths.update) {
+        json metrics = json::object();
+        for (auto& entry : results.items()) {
+            json m = entry.value();
+            m["tolerance"] = baseline.contains(entry.key()) ? baseline[entry.key()].value("tolerance", defaultTolerance(entry.key()))
+                                                            : defaultTolerance(entry.key());
+            metrics[entry.key()] = m;
+        }
+        json out;
+        out["config"] = config;
+        out["metrics"] = metrics;
+        std::ofstream file(paths.baseline);
+        file << out.dump(2) << std::endl;
+        if (!file) {
+            std::cerr << "Error: Could not write " << paths.baseline << std::endl;
+            return 2;
+        }
+        std::cout << "Wrote " << metrics.size() << " baseline figures to " << paths.baseline << std::endl;
+        return 0;
+    }
+
+    int regressions = compare(baseline, results);
+    if (regressions > 0) {
+        std::cout << regressions << " figure(s) regressed beyond their tolerance band." << std::endl;
+        return 1;
+    }
+    std::cout << "All figures within their tolerance bands." << std::endl;
+    return 0;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file token_bench.cpp
+ * @brief Measures encode/verify cost and size of stateless session tokens.
+ *
+ * Build (from the backend folder):
+ *   g++ -std=c++17 -O2 -I. tools/token_bench.cpp SessionToken.cpp HmacSha256.cpp UserStats.cpp QuestionBank.cpp MultipleChoiceQuestion.cpp TrueFalseQuestion.cpp FillInTheBlankQuestion.cpp KnowledgeTracing.cpp ItemResponseTheory.cpp EloRating.cpp ThompsonSampling.cpp SpacedRepetition.cpp TopicTrend.cpp TimingWheel.cpp ExposureControl.cpp Logger.cpp Metrics.cpp LatencyHistogram.cpp BucketInventory.cpp -o token_bench -lpthread
+ *
+ * Usage: token_bench [questions.txt] [iterations]
+ */
+#include "../SessionToken.h"
+#include "../UserStats.h"
+#include "../QuestionBank.h"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+
+int main(int argc, char* argv[]) {
+    std::string bankFile = argc > 1 ? argv[1] : "questions.txt";
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 20000;
+
+    QuestionBank bank;
+    bank.loadFromFile(bankFile);
+    if (bank.size() == 0) {
+        std::cerr << "No questions loaded; nothing to benchmark." << std::endl;
+        return 1;
+    }
+
+    SessionTokenCodec codec("benchmark-secret", 2048);
+
+    std::cout << std::left << std::setw(12) << "used"
+              << std::setw(14) << "token bytes"
+              << std::setw(16) << "encode ns/op"
+              << std::setw(16) << "verify ns/op" << std::endl;
+
+    // Sessions that have seen 0%, 10%, 50% and 100% of the bank.
+    for (int percent : {0, 10, 50, 100}) {
+        UserStats stats("QuizUser");
+        size_t usedCount = bank.size() * percent / 100;
+        for (size_t i = 0; i < usedCount; ++i) {
+            // Every other question first, so the bitmap is not one trivial run.
+            size_t id = (i * 2) % bank.size() + ((i * 2) / bank.size());
+            Question* q = bank.getQuestionById(static_cast<int>(id));
+            stats.setLastQuestion(q);
+            stats.updateStats(q->getTopic(), i % 3 != 0);
+        }
+
+        std::string token;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            token = codec.encode(stats, bank);
+        }
+        auto mid = std::chrono::steady_clock::now();
+        int verified = 0;
+        for (int i = 0; i < iterations; ++i) {
+            UserStats decoded("QuizUser");
+            verified += codec.decode(token, decoded, bank) ? 1 : 0;
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        if (verified != iterations) {
+            std::cerr << "Token failed to verify!" << std::endl;
+            return 1;
+        }
+
+        double encodeNs = std::chrono::duration<double, std::nano>(mid - start).count() / iterations;
+        double verifyNs = std::chrono::duration<double, std::nano>(end - mid).count() / iterations;
+        std::cout << std::left << std::setw(12) << (std::to_string(usedCount) + "/" + std::to_string(bank.size()))
+                  << std::setw(14) << token.size()
+                  << std::setw(16) << std::fixed << std::setprecision(0) << encodeNs
+                  << std::setw(16) << verifyNs << std::endl;
+    }
+
+    std::cout << "Token budget: " << codec.getBudget() << " bytes" << std::endl;
+    return 0;
+}
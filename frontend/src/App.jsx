@@ -9,6 +9,20 @@ import './App.css';
 
 const API_URL = 'http://localhost:18080';
 
+// One session per browser, so the server keeps (and logs) each learner
+// separately instead of sharing its default session.
+const getSessionId = () => {
+  let id = localStorage.getItem('quizSessionId');
+  if (!id) {
+    id = (window.crypto && crypto.randomUUID)
+      ? crypto.randomUUID()
+      : Math.random().toString(36).slice(2) + Date.now().toString(36);
+    localStorage.setItem('quizSessionId', id);
+  }
+  return id;
+};
+const SESSION_HEADERS = { 'X-Session-Id': getSessionId() };
+
 // Helper component for topic icons
 const TopicIcon = ({ topic }) => {
   switch (topic) {
@@ -26,11 +40,12 @@ const TopicIcon = ({ topic }) => {
 };
 
 // Helper component for difficulty
+// (levels may be fractional, e.g. 1.75)
 const DifficultyIcon = ({ level }) => {
-  if (level === 1) return <TrendingDown size={16} title="Easy" />;
-  if (level === 2) return <Minus size={16} title="Medium" />;
-  if (level === 3) return <TrendingUp size={16} title="Hard" />;
-  return null;
+  if (typeof level !== 'number') return null;
+  if (level < 1.5) return <TrendingDown size={16} title="Easy" />;
+  if (level < 2.5) return <Minus size={16} title="Medium" />;
+  return <TrendingUp size={16} title="Hard" />;
 }
 
 export default function App() {
@@ -65,7 +80,7 @@ export default function App() {
       setCorrectAnswer(null);
       setFibAnswer(''); // <-- NEW: Reset FIB input
 
-      await fetch(`${API_URL}/start_quiz`);
+      await fetch(`${API_URL}/start_quiz`, { headers: SESSION_HEADERS });
       
       handleGetQuestion();
     } catch (error) {
@@ -93,7 +108,7 @@ export default function App() {
       setCorrectAnswer(null);
       setFibAnswer(''); // <-- NEW: Reset FIB input
       
-      const response = await fetch(`${API_URL}/get_question`);
+      const response = await fetch(`${API_URL}/get_question`, { headers: SESSION_HEADERS });
       
       if (!response.ok) {
         const errorData = await response.json();
@@ -101,6 +116,11 @@ export default function App() {
       }
       
       const data = await response.json();
+      // The server ends the quiz early once it has measured the learner well enough.
+      if (data.quizComplete) {
+        handleShowStats();
+        return;
+      }
       setQuestion(data);
       setCurrentQuestionIndex(i => i + 1); // Increment index
       setQuizState('active'); 
@@ -119,7 +139,7 @@ export default function App() {
     try {
       const response = await fetch(`${API_URL}/submit_answer`, {
         method: 'POST',
-        headers: { 'Content-Type': 'application/json' },
+        headers: { 'Content-Type': 'application/json', ...SESSION_HEADERS },
         body: JSON.stringify({ answer: answer }),
       });
       
@@ -143,7 +163,7 @@ export default function App() {
       }
       
       // --- AUTO-ADVANCE ---
-      setTimeout(loadNext, 1500); 
+      setTimeout(result.quizComplete ? handleShowStats : loadNext, 1500); 
 
     } catch (error) {
       console.error('Error submitting answer:', error);
@@ -155,7 +175,7 @@ export default function App() {
     setQuizState('loading');
     setQuestion(null);
     try {
-      const response = await fetch(`${API_URL}/get_stats`);
+      const response = await fetch(`${API_URL}/get_stats`, { headers: SESSION_HEADERS });
       const data = await response.json();
       setStats(data);
       setQuizState('results'); 
@@ -429,7 +449,7 @@ export default function App() {
             animate={{ opacity: 1, scale: 1 }}
           >
             <h2>Quiz Complete!</h2>
-            <p className="final-score">Your final score: {score} / {numQuestions}</p>
+            <p className="final-score">Your final score: {score} / {currentQuestionIndex}</p>
             {renderStats()}
             <button className="primary-button" onClick={() => setQuizState('settings')}>
               Play Again